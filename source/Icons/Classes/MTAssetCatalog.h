@@ -0,0 +1,62 @@
+/*
+    MTAssetCatalog.h
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+/*!
+ @abstract      This class reads images from compiled asset catalogs (Assets.car files).
+ @discussion    The catalog is memory-mapped and only the BOM index, the facet keys and the headers of the renditions
+                are parsed to find the rendition of an image with the largest size. Only the pixel data of this single
+                rendition is decoded (embedded PNG or JPEG data or ARGB data that is stored uncompressed or compressed
+                using LZFSE, LZVN or deflate). The reader only uses Foundation, CoreGraphics, ImageIO and libcompression.
+ */
+
+@interface MTAssetCatalog : NSObject
+
+/*!
+ @method        init:
+ @discussion    The init method is not available. Please use initWithContentsOfURL: instead.
+*/
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        initWithContentsOfURL:
+ @abstract      Opens the asset catalog at the given url.
+ @param         url The url of the Assets.car file.
+ @discussion    Returns an initialized MTAssetCatalog object or nil if the file is not a valid asset catalog.
+ */
+- (instancetype)initWithContentsOfURL:(NSURL*)url;
+
+/*!
+ @method        initWithData:
+ @abstract      Opens the asset catalog contained in the given data.
+ @param         data The contents of an Assets.car file.
+ @discussion    Returns an initialized MTAssetCatalog object or nil if the data is not a valid asset catalog.
+ */
+- (instancetype)initWithData:(NSData*)data NS_DESIGNATED_INITIALIZER;
+
+/*!
+ @method        createImageNamed:
+ @abstract      Decode the largest rendition of the image with the given name.
+ @param         name The name of the image (e.g. "AppIcon").
+ @discussion    Returns an image or NULL if the catalog does not contain a (supported) image with the given name.
+                The caller is responsible for releasing the image.
+ */
+- (CGImageRef)createImageNamed:(NSString*)name CF_RETURNS_RETAINED;
+
+@end
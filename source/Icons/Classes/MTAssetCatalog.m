@@ -0,0 +1,460 @@
+/*
+    MTAssetCatalog.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTAssetCatalog.h"
+#import "MTTrace.h"
+#import <ImageIO/ImageIO.h>
+#import <compression.h>
+
+#define kMTAssetCatalogBOMHeaderSize        32
+#define kMTAssetCatalogRenditionHeaderSize  184
+#define kMTAssetCatalogPixelHeaderSize      16
+#define kMTAssetCatalogRawDataHeaderSize    12
+#define kMTAssetCatalogChunkHeaderSize      20
+#define kMTAssetCatalogIdentifierAttribute  17
+#define kMTAssetCatalogTreeDepthMax         64
+#define kMTAssetCatalogImageSizeMax         16384
+#define kMTAssetCatalogPixelDataSizeMax     (256 * 1024 * 1024)
+
+// compression types of pixel renditions
+#define kMTAssetCatalogCompressionNone      0
+#define kMTAssetCatalogCompressionDeflate   2
+#define kMTAssetCatalogCompressionLZVN      3
+#define kMTAssetCatalogCompressionLZFSE     4
+
+typedef struct {
+    const UInt8 *bytes;
+    uint32_t length;
+} MTAssetCatalogBlock;
+
+typedef struct {
+    const UInt8 *header;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pixelFormat;
+} MTAssetCatalogRendition;
+
+// BOM structures are stored big endian, CAR structures little endian
+static inline uint32_t readBE32(const UInt8 *bytes) { return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3]; }
+static inline uint16_t readBE16(const UInt8 *bytes) { return (uint16_t)((bytes[0] << 8) | bytes[1]); }
+static inline uint32_t readLE32(const UInt8 *bytes) { return ((uint32_t)bytes[3] << 24) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[1] << 8) | bytes[0]; }
+static inline uint16_t readLE16(const UInt8 *bytes) { return (uint16_t)((bytes[1] << 8) | bytes[0]); }
+
+static inline BOOL hasTag(const UInt8 *bytes, const char *tag)
+{
+    // depending on the tool that wrote the catalog, tags
+    // may appear in either byte order
+    return ((bytes[0] == tag[0] && bytes[1] == tag[1] && bytes[2] == tag[2] && bytes[3] == tag[3]) ||
+            (bytes[0] == tag[3] && bytes[1] == tag[2] && bytes[2] == tag[1] && bytes[3] == tag[0]));
+}
+
+static NSData *decompressData(const UInt8 *bytes, NSUInteger length, uint32_t compressionType, NSUInteger expectedLength)
+{
+    NSMutableData *data = nil;
+
+    if (compressionType == kMTAssetCatalogCompressionNone) {
+
+        if (length >= expectedLength) { data = [NSMutableData dataWithBytes:bytes length:expectedLength]; }
+
+    } else {
+
+        compression_algorithm algorithm = COMPRESSION_LZFSE;
+
+        if (compressionType == kMTAssetCatalogCompressionDeflate) {
+
+            algorithm = COMPRESSION_ZLIB;
+
+            // libcompression expects raw deflate data without the zlib header
+            if (length > 2 && (bytes[0] & 0x0f) == 8 && ((bytes[0] << 8) | bytes[1]) % 31 == 0) {
+                bytes += 2;
+                length -= 2;
+            }
+
+        } else if (compressionType == kMTAssetCatalogCompressionLZVN) {
+
+            // lzvn data is usually wrapped into lzfse block headers,
+            // which the lzfse decoder handles as well
+            algorithm = (length >= 4 && bytes[0] == 'b' && bytes[1] == 'v' && bytes[2] == 'x') ? COMPRESSION_LZFSE : COMPRESSION_LZVN;
+
+        } else if (compressionType != kMTAssetCatalogCompressionLZFSE) {
+
+            return nil;
+        }
+
+        data = [NSMutableData dataWithLength:expectedLength];
+        size_t decodedLength = compression_decode_buffer([data mutableBytes], expectedLength, bytes, length, NULL, algorithm);
+
+        if (decodedLength != expectedLength) { data = nil; }
+    }
+
+    return data;
+}
+
+@implementation MTAssetCatalog
+{
+    NSData *_data;
+    const UInt8 *_bytes;
+    NSUInteger _length;
+    uint32_t _indexOffset;
+    uint32_t _blockCount;
+    NSDictionary *_variables;
+}
+
+- (instancetype)initWithContentsOfURL:(NSURL*)url
+{
+    // the catalog is memory-mapped, so only the
+    // pages we actually parse are read from disk
+    NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedAlways error:nil];
+    return [self initWithData:data];
+}
+
+- (instancetype)initWithData:(NSData*)data
+{
+    self = [super init];
+
+    if (self) {
+
+        _data = data;
+        _bytes = [data bytes];
+        _length = [data length];
+
+        if (![self parseHeader]) { self = nil; }
+    }
+
+    return self;
+}
+
+- (BOOL)parseHeader
+{
+    BOOL success = NO;
+
+    if (_length >= kMTAssetCatalogBOMHeaderSize && memcmp(_bytes, "BOMStore", 8) == 0) {
+
+        uint32_t indexOffset = readBE32(_bytes + 16);
+        uint32_t variablesOffset = readBE32(_bytes + 24);
+
+        if ((uint64_t)indexOffset + 4 <= _length && (uint64_t)variablesOffset + 4 <= _length) {
+
+            _indexOffset = indexOffset;
+            _blockCount = readBE32(_bytes + indexOffset);
+
+            if ((uint64_t)indexOffset + 4 + (uint64_t)_blockCount * 8 <= _length) {
+
+                // get the named variables (trees and headers)
+                NSMutableDictionary *variables = [NSMutableDictionary dictionary];
+                uint32_t variableCount = readBE32(_bytes + variablesOffset);
+                NSUInteger position = variablesOffset + 4;
+
+                for (uint32_t i = 0; i < variableCount && position + 5 <= _length; i++) {
+
+                    uint32_t blockID = readBE32(_bytes + position);
+                    UInt8 nameLength = _bytes[position + 4];
+                    position += 5;
+
+                    if (position + nameLength > _length) { break; }
+
+                    NSString *name = [[NSString alloc] initWithBytes:_bytes + position length:nameLength encoding:NSASCIIStringEncoding];
+                    if (name) { [variables setObject:[NSNumber numberWithUnsignedInt:blockID] forKey:name]; }
+                    position += nameLength;
+                }
+
+                _variables = variables;
+                success = ([_variables objectForKey:@"RENDITIONS"] != nil);
+            }
+        }
+    }
+
+    return success;
+}
+
+- (MTAssetCatalogBlock)blockWithID:(uint32_t)blockID
+{
+    MTAssetCatalogBlock block = { NULL, 0 };
+
+    if (blockID < _blockCount) {
+
+        const UInt8 *entry = _bytes + _indexOffset + 4 + blockID * 8;
+        uint32_t address = readBE32(entry);
+        uint32_t length = readBE32(entry + 4);
+
+        if ((uint64_t)address + length <= _length) { block = (MTAssetCatalogBlock){ _bytes + address, length }; }
+    }
+
+    return block;
+}
+
+- (MTAssetCatalogBlock)blockWithVariableName:(NSString*)name
+{
+    MTAssetCatalogBlock block = { NULL, 0 };
+    NSNumber *blockID = [_variables objectForKey:name];
+
+    if (blockID) { block = [self blockWithID:[blockID unsignedIntValue]]; }
+
+    return block;
+}
+
+- (void)enumerateTreeWithVariableName:(NSString*)name
+                           usingBlock:(void (^)(MTAssetCatalogBlock key, MTAssetCatalogBlock value, BOOL *stop))block
+{
+    MTAssetCatalogBlock tree = [self blockWithVariableName:name];
+
+    if (tree.length >= 12 && memcmp(tree.bytes, "tree", 4) == 0) {
+
+        // descend to the leftmost leaf
+        uint32_t pathID = readBE32(tree.bytes + 8);
+        MTAssetCatalogBlock path = [self blockWithID:pathID];
+
+        for (NSUInteger depth = 0; path.length >= 12 && !readBE16(path.bytes) && depth < kMTAssetCatalogTreeDepthMax; depth++) {
+
+            if (readBE16(path.bytes + 2) == 0 || path.length < 20) { return; }
+
+            pathID = readBE32(path.bytes + 12);
+            path = [self blockWithID:pathID];
+        }
+
+        // follow the forward links of the leaves
+        BOOL stop = NO;
+
+        for (NSUInteger visited = 0; path.length >= 12 && !stop && visited < _blockCount; visited++) {
+
+            uint16_t count = readBE16(path.bytes + 2);
+
+            for (uint16_t i = 0; i < count && !stop && 12 + (i + 1) * 8 <= path.length; i++) {
+
+                MTAssetCatalogBlock value = [self blockWithID:readBE32(path.bytes + 12 + i * 8)];
+                MTAssetCatalogBlock key = [self blockWithID:readBE32(path.bytes + 16 + i * 8)];
+
+                if (key.bytes && value.bytes) { block(key, value, &stop); }
+            }
+
+            uint32_t forward = readBE32(path.bytes + 4);
+            path = (forward) ? [self blockWithID:forward] : (MTAssetCatalogBlock){ NULL, 0 };
+        }
+    }
+}
+
+- (NSInteger)identifierForImageNamed:(NSString*)name
+{
+    __block NSInteger identifier = -1;
+    NSData *nameData = [name dataUsingEncoding:NSUTF8StringEncoding];
+
+    [self enumerateTreeWithVariableName:@"FACETKEYS" usingBlock:^(MTAssetCatalogBlock key, MTAssetCatalogBlock value, BOOL *stop) {
+
+        if (key.length == [nameData length] && memcmp(key.bytes, [nameData bytes], key.length) == 0 && value.length >= 6) {
+
+            // the facet's key token contains a list of attributes,
+            // one of which is the identifier of the image
+            uint16_t attributeCount = readLE16(value.bytes + 4);
+
+            for (uint16_t i = 0; i < attributeCount && 6 + (i + 1) * 4 <= value.length; i++) {
+
+                if (readLE16(value.bytes + 6 + i * 4) == kMTAssetCatalogIdentifierAttribute) {
+                    identifier = readLE16(value.bytes + 8 + i * 4);
+                    break;
+                }
+            }
+
+            *stop = YES;
+        }
+    }];
+
+    return identifier;
+}
+
+- (NSInteger)keyIndexOfAttribute:(uint32_t)attribute
+{
+    NSInteger keyIndex = -1;
+    MTAssetCatalogBlock keyFormat = [self blockWithVariableName:@"KEYFORMAT"];
+
+    if (keyFormat.length >= 12) {
+
+        uint32_t count = readLE32(keyFormat.bytes + 8);
+
+        for (uint32_t i = 0; i < count && 12 + (i + 1) * 4 <= keyFormat.length; i++) {
+
+            if (readLE32(keyFormat.bytes + 12 + i * 4) == attribute) {
+                keyIndex = i;
+                break;
+            }
+        }
+    }
+
+    return keyIndex;
+}
+
+- (CGImageRef)createImageNamed:(NSString*)name
+{
+    CGImageRef imageRef = NULL;
+    MTTraceTimestamp traceBegin = MTTraceBegin();
+
+    NSInteger identifier = [self identifierForImageNamed:name];
+    NSInteger keyIndex = [self keyIndexOfAttribute:kMTAssetCatalogIdentifierAttribute];
+
+    if (identifier >= 0 && keyIndex >= 0) {
+
+        // find the largest rendition of the image by only looking at the rendition headers
+        __block MTAssetCatalogRendition bestRendition = { NULL, 0, 0, 0 };
+
+        [self enumerateTreeWithVariableName:@"RENDITIONS" usingBlock:^(MTAssetCatalogBlock key, MTAssetCatalogBlock value, BOOL *stop) {
+
+            if ((keyIndex + 1) * 2 <= key.length && readLE16(key.bytes + keyIndex * 2) == identifier &&
+                value.length >= kMTAssetCatalogRenditionHeaderSize && hasTag(value.bytes, "CTSI")) {
+
+                uint32_t width = readLE32(value.bytes + 12);
+                uint32_t height = readLE32(value.bytes + 16);
+                uint32_t pixelFormat = readLE32(value.bytes + 24);
+
+                BOOL supported = (pixelFormat == 'ARGB' || pixelFormat == 'PNG ' || pixelFormat == 'JPEG' || pixelFormat == 'DATA');
+
+                // the size is taken from the file, so we ignore
+                // renditions that claim to be unreasonably large
+                if (width == 0 || height == 0 || width > kMTAssetCatalogImageSizeMax || height > kMTAssetCatalogImageSizeMax) { supported = NO; }
+
+                if (supported && (uint64_t)width * height > (uint64_t)bestRendition.width * bestRendition.height) {
+                    bestRendition = (MTAssetCatalogRendition){ value.bytes, width, height, pixelFormat };
+                }
+            }
+        }];
+
+        if (bestRendition.header) { imageRef = [self createImageWithRendition:bestRendition]; }
+    }
+
+    MTTraceEnd("read asset catalog", traceBegin);
+
+    return imageRef;
+}
+
+- (CGImageRef)createImageWithRendition:(MTAssetCatalogRendition)rendition
+{
+    CGImageRef imageRef = NULL;
+
+    // the lengths are taken from the file, so all bounds are checked
+    // as offsets before we compute any pointer from them
+    NSUInteger headerOffset = rendition.header - _bytes;
+    if (headerOffset > _length || _length - headerOffset < kMTAssetCatalogRenditionHeaderSize) { return NULL; }
+
+    uint32_t tlvLength = readLE32(rendition.header + 168);
+    uint32_t renditionLength = readLE32(rendition.header + 180);
+    NSUInteger renditionOffset = headerOffset + kMTAssetCatalogRenditionHeaderSize;
+
+    if (tlvLength > _length - renditionOffset) { return NULL; }
+    renditionOffset += tlvLength;
+
+    if (renditionLength > _length - renditionOffset || renditionLength < kMTAssetCatalogRawDataHeaderSize) { return NULL; }
+    const UInt8 *renditionData = _bytes + renditionOffset;
+
+    if (rendition.pixelFormat == 'ARGB' && hasTag(renditionData, "MLEC") && renditionLength >= kMTAssetCatalogPixelHeaderSize) {
+
+        uint32_t compressionType = readLE32(renditionData + 8);
+        uint32_t rawLength = readLE32(renditionData + 12);
+        const UInt8 *raw = renditionData + kMTAssetCatalogPixelHeaderSize;
+
+        if (rawLength > renditionLength - kMTAssetCatalogPixelHeaderSize) { rawLength = renditionLength - kMTAssetCatalogPixelHeaderSize; }
+
+        NSUInteger bytesPerRow = (NSUInteger)rendition.width * 4;
+        NSUInteger expectedLength = bytesPerRow * rendition.height;
+        NSMutableData *pixelData = nil;
+
+        // the pixel buffer is allocated before the data is decompressed
+        if (rendition.width > kMTAssetCatalogImageSizeMax || rendition.height > kMTAssetCatalogImageSizeMax || expectedLength > kMTAssetCatalogPixelDataSizeMax) { return NULL; }
+
+        if (rawLength >= kMTAssetCatalogChunkHeaderSize && hasTag(raw, "KCBC")) {
+
+            // newer catalogs split the pixel data into separately compressed chunks of rows
+            pixelData = [NSMutableData dataWithCapacity:expectedLength];
+            NSUInteger position = 0;
+
+            while (position + kMTAssetCatalogChunkHeaderSize <= rawLength && hasTag(raw + position, "KCBC") && [pixelData length] < expectedLength) {
+
+                uint32_t rows = readLE32(raw + position + 12);
+                uint32_t chunkLength = readLE32(raw + position + 16);
+                position += kMTAssetCatalogChunkHeaderSize;
+
+                if (position + chunkLength > rawLength) { pixelData = nil; break; }
+
+                NSUInteger chunkRows = (rows > 0) ? rows : rendition.height;
+                NSUInteger chunkExpectedLength = MIN(chunkRows * bytesPerRow, expectedLength - [pixelData length]);
+                NSData *chunk = decompressData(raw + position, chunkLength, compressionType, chunkExpectedLength);
+
+                if (!chunk) { pixelData = nil; break; }
+
+                [pixelData appendData:chunk];
+                position += chunkLength;
+            }
+
+        } else {
+
+            pixelData = (NSMutableData*)decompressData(raw, rawLength, compressionType, expectedLength);
+        }
+
+        if ([pixelData length] == expectedLength) {
+
+            // the pixels are stored as premultiplied BGRA
+            CGDataProviderRef dataProvider = CGDataProviderCreateWithCFData((__bridge CFDataRef)pixelData);
+
+            if (dataProvider) {
+
+                CGColorSpaceRef colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+
+                imageRef = CGImageCreate(
+                                         rendition.width,
+                                         rendition.height,
+                                         8,
+                                         32,
+                                         bytesPerRow,
+                                         colorSpace,
+                                         kCGBitmapByteOrder32Little | (CGBitmapInfo)kCGImageAlphaPremultipliedFirst,
+                                         dataProvider,
+                                         NULL,
+                                         false,
+                                         kCGRenderingIntentDefault
+                                         );
+
+                CGColorSpaceRelease(colorSpace);
+                CGDataProviderRelease(dataProvider);
+            }
+        }
+
+    } else {
+
+        // encoded images are stored as raw data, optionally with a small header
+        const UInt8 *encodedData = renditionData;
+        NSUInteger encodedLength = renditionLength;
+
+        if (hasTag(renditionData, "DWAR")) {
+
+            uint32_t rawLength = readLE32(renditionData + 8);
+            encodedData += kMTAssetCatalogRawDataHeaderSize;
+            encodedLength = MIN(rawLength, renditionLength - kMTAssetCatalogRawDataHeaderSize);
+        }
+
+        // copying the single rendition makes sure the (lazily decoded)
+        // image does not depend on the memory-mapped catalog
+        NSData *data = [_data subdataWithRange:NSMakeRange(encodedData - _bytes, encodedLength)];
+        CGImageSourceRef imageSource = CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL);
+
+        if (imageSource) {
+
+            imageRef = CGImageSourceCreateImageAtIndex(imageSource, 0, NULL);
+            CFRelease(imageSource);
+        }
+    }
+
+    return imageRef;
+}
+
+@end
@@ -16,6 +16,7 @@
 */
 
 #import "MTAttributedString.h"
+#import "MTTrace.h"
 
 @implementation NSAttributedString (MTAttributedString)
 
@@ -78,16 +79,23 @@
                maximumFontSize:(CGFloat)maxFontSize
                 useImageBounds:(BOOL)imageBounds
 {
+    MTTraceTimestamp traceBegin = MTTraceBegin();
     CGFloat fontSize = (maxFontSize > minFontSize) ? maxFontSize : NSHeight(rect) * 2;
     CGFloat textHeight = CGFLOAT_MAX;
     CGFloat textWidth = CGFLOAT_MAX;
 
+    // we reuse a single mutable copy of the string for all
+    // iterations and just replace its font attribute
+    NSMutableAttributedString *attrString = [[NSMutableAttributedString alloc] initWithAttributedString:self];
+    NSRange stringRange = NSMakeRange(0, [attrString length]);
+    NSFontManager *fontManager = [NSFontManager sharedFontManager];
+    NSFont *font = [self font];
+
     while ((textHeight > NSHeight(rect) || textWidth > NSWidth(rect)) && fontSize >= minFontSize) {
 
-        NSMutableAttributedString *attrString = [[NSMutableAttributedString alloc] initWithAttributedString:self];
         [attrString addAttribute:NSFontAttributeName
-                           value:[[NSFontManager sharedFontManager] convertFont:[self font] toSize:--fontSize]
-                           range:NSMakeRange(0, [[self string] length])
+                           value:[fontManager convertFont:font toSize:--fontSize]
+                           range:stringRange
         ];
 
         CGRect usedRect = CGRectZero;
@@ -108,6 +116,8 @@
         textWidth = ceil(NSWidth(usedRect));
     }
 
+    MTTraceEnd("fontSizeToFitInRect", traceBegin);
+    
     return fontSize;
 }
 
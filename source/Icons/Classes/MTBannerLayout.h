@@ -0,0 +1,119 @@
+/*
+    MTBannerLayout.h
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Cocoa/Cocoa.h>
+#import "MTBannerView.h"
+
+/*!
+ @abstract      A solved banner geometry for a given view size and banner configuration.
+ @discussion    Banner layouts are immutable and cached. Layouts for the same (quantized) parameters are solved
+                only once, so stamping the same banner on many icons of the same size does not recalculate the
+                banner geometry or the text size.
+ */
+
+@interface MTBannerLayout : NSObject
+
+/*!
+ @property      bannerRect
+ @abstract      The rectangle of the banner in banner space.
+ @discussion    The value of this property is NSRect.
+*/
+@property (assign, readonly) NSRect bannerRect;
+
+/*!
+ @property      rectCenter
+ @abstract      The pivot of the banner in banner space.
+ @discussion    The value of this property is NSPoint.
+*/
+@property (assign, readonly) NSPoint rectCenter;
+
+/*!
+ @property      textCenter
+ @abstract      The center of the visible part of the banner in banner space.
+ @discussion    The value of this property is NSPoint.
+*/
+@property (assign, readonly) NSPoint textCenter;
+
+/*!
+ @property      maxTextSize
+ @abstract      The maximum size of the banner text.
+ @discussion    The value of this property is NSSize.
+*/
+@property (assign, readonly) NSSize maxTextSize;
+
+/*!
+ @property      isVisible
+ @abstract      A boolean value indicating whether the banner is visible within the view bounds.
+ @discussion    Returns YES if the banner is visible, otherwise returns NO.
+*/
+@property (assign, readonly) BOOL isVisible;
+
+/*!
+ @method        init:
+ @discussion    The init method is not available. Please use layoutWithSize:position:angle:height:margin:textMargin: instead.
+*/
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        layoutWithSize:position:angle:height:margin:textMargin:
+ @abstract      Returns the banner layout for the given parameters.
+ @param         size The size of the view the banner is drawn into.
+ @param         position The position of the banner.
+ @param         angle The angle of the banner.
+ @param         height The height of the banner as a percentage of the view height.
+ @param         margin The margin between the banner and the view corner as a percentage of the view height.
+ @param         textMargin The minimum distance between the edge of the banner and the text as a percentage.
+ @discussion    Returns a cached MTBannerLayout object if a layout for the same parameters has already been solved.
+                This method is thread-safe.
+*/
++ (MTBannerLayout*)layoutWithSize:(NSSize)size
+                         position:(MTBannerPosition)position
+                            angle:(CGFloat)angle
+                           height:(CGFloat)height
+                           margin:(CGFloat)margin
+                       textMargin:(CGFloat)textMargin;
+
+/*!
+ @method        transform
+ @abstract      Returns the transform from banner space to view space.
+ @discussion    Returns a new NSAffineTransform object.
+*/
+- (NSAffineTransform*)transform;
+
+/*!
+ @method        fontSizeForString:stringRect:
+ @abstract      Returns the font size the given string has to be drawn with to fit into the banner.
+ @param         string The attributed string containing the text and the font of the banner.
+ @param         stringRect On return, the image bounds of the string drawn with the returned font size.
+ @discussion    The font size is derived from the image bounds of the string at a reference
+                font size, which are measured once per text and font for all layouts, so
+                the text only has to be laid out again to verify the result. The reference
+                metrics are kept in the caches folder of the current user and process, so
+                they are reused across launches. The font size is cached per text and font.
+                This method is thread-safe.
+*/
+- (CGFloat)fontSizeForString:(NSAttributedString*)string stringRect:(NSRect*)stringRect;
+
+/*!
+ @method        synchronizeTextMetrics
+ @abstract      Waits until the reference text metrics have been written to disk.
+ @discussion    The metrics are written in the background. Call this method before a short-lived
+                process exits, so the metrics it measured are available to the next launch.
+*/
++ (void)synchronizeTextMetrics;
+
+@end
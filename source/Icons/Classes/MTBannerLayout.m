@@ -0,0 +1,654 @@
+/*
+    MTBannerLayout.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTBannerLayout.h"
+#import "MTTrace.h"
+#import "Constants.h"
+#import <CoreText/CoreText.h>
+
+#define kMTBannerLayoutQuantizationAngle    100.0
+#define kMTBannerLayoutQuantizationFactor   10000.0
+#define kMTBannerLayoutQuantizationSize     100.0
+#define kMTBannerLayoutCacheCountLimit      256
+#define kMTBannerLayoutTextCacheCountLimit  64
+#define kMTBannerLayoutMetricsCountLimit    256
+#define kMTBannerLayoutReferenceFontSize    100.0
+#define kMTBannerLayoutMetricsVersion       1
+#define kMTBannerLayoutMetricsFileName      @"BannerTextMetrics.plist"
+#define kMTBannerLayoutMetricsVersionKey    @"Version"
+#define kMTBannerLayoutMetricsEntriesKey    @"Metrics"
+
+@interface MTBannerLayout ()
+@property (assign, readwrite) NSRect bannerRect;
+@property (assign, readwrite) NSPoint rectCenter;
+@property (assign, readwrite) NSPoint textCenter;
+@property (assign, readwrite) NSSize maxTextSize;
+@property (assign, readwrite) BOOL isVisible;
+@property (assign) NSAffineTransformStruct transformStruct;
+@property (assign) CGFloat minimumFontSize;
+@property (nonatomic, strong, readwrite) NSMutableDictionary *textCache;
+@end
+
+typedef struct { CGFloat x, y; } MTPolygon;
+
+static MTPolygon intersect(MTPolygon A, MTPolygon B, CGFloat edge, int type)
+{
+    CGFloat dx = B.x - A.x;
+    CGFloat dy = B.y - A.y;
+    CGFloat t = 0;
+    
+    switch (type) {
+            
+        case 0: t = (edge - A.x) / dx; break; // left
+        case 1: t = (edge - A.x) / dx; break; // right
+        case 2: t = (edge - A.y) / dy; break; // bottom
+        case 3: t = (edge - A.y) / dy; break; // top
+    }
+    
+    return (MTPolygon){ A.x + t*dx, A.y + t*dy };
+}
+
+static int clipEdge(MTPolygon *in, int inCount, MTPolygon *out, CGFloat edge, int type)
+{
+    int outCount = 0;
+    
+    for (int i = 0; i < inCount; i++) {
+        
+        MTPolygon A = in[i];
+        MTPolygon B = in[(i + 1)%inCount];
+        BOOL Ain = false, Bin = false;
+        
+        switch (type) {
+                
+            case 0: Ain=A.x>=edge; Bin=B.x>=edge; break;
+            case 1: Ain=A.x<=edge; Bin=B.x<=edge; break;
+            case 2: Ain=A.y>=edge; Bin=B.y>=edge; break;
+            case 3: Ain=A.y<=edge; Bin=B.y<=edge; break;
+        }
+
+        if (Ain && Bin) {
+            
+            out[outCount++] = B;
+            
+        } else if (Ain && !Bin) {
+            
+            out[outCount++] = intersect(A,B,edge,type);
+            
+        } else if (!Ain && Bin) {
+            
+            out[outCount++] = intersect(A,B,edge,type);
+            out[outCount++] = B;
+        }
+    }
+    
+    return outCount;
+}
+
+static int clipPolygonToRect(MTPolygon *poly, int count, NSRect r)
+{
+    MTPolygon tmp1[16], tmp2[16];
+    int c;
+
+    c = clipEdge(poly, count, tmp1, NSMinX(r), 0);
+    c = clipEdge(tmp1, c, tmp2, NSMaxX(r), 1);
+    c = clipEdge(tmp2, c, tmp1, NSMinY(r), 2);
+    c = clipEdge(tmp1, c, tmp2, NSMaxY(r), 3);
+
+    memcpy(poly, tmp2, sizeof(MTPolygon)*c);
+    return c;
+}
+
+static CGFloat polygonArea(MTPolygon *pts, int n)
+{
+    CGFloat a = 0;
+    
+    for (int i = 0; i < n; i++) {
+        
+        MTPolygon p0 = pts[i], p1 = pts[(i + 1)%n];
+        a += p0.x * p1.y - p1.x * p0.y;
+    }
+    
+    return a * .5;
+}
+
+static MTPolygon polygonCentroid(MTPolygon *pts, int n)
+{
+    CGFloat A = polygonArea(pts, n);
+    CGFloat cx = 0, cy = 0;
+    
+    for (int i = 0; i < n; i++) {
+        
+        MTPolygon p0 = pts[i], p1 = pts[(i + 1)%n];
+        CGFloat cross = p0.x * p1.y - p1.x * p0.y;
+        cx += (p0.x + p1.x) * cross;
+        cy += (p0.y + p1.y) * cross;
+    }
+    cx /= (6*A);
+    cy /= (6*A);
+    
+    return (MTPolygon){cx, cy};
+}
+
+static inline CGFloat quantize(CGFloat value, CGFloat factor)
+{
+    return round(value * factor) / factor;
+}
+
+@implementation MTBannerLayout
+
++ (NSCache*)layoutCache
+{
+    static NSCache *layoutCache = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
+        layoutCache = [[NSCache alloc] init];
+        [layoutCache setCountLimit:kMTBannerLayoutCacheCountLimit];
+    });
+    
+    return layoutCache;
+}
+
++ (NSString*)textMetricsFilePath
+{
+    NSString *filePath = nil;
+    NSURL *cachesURL = [[[NSFileManager defaultManager] URLsForDirectory:NSCachesDirectory
+                                                               inDomains:NSUserDomainMask
+                        ] firstObject];
+    
+    if (cachesURL) {
+        
+        // every process (the app, the extension and the command line tool)
+        // uses a folder of its own, so they never write the same file
+        NSString *folderName = [[NSBundle mainBundle] bundleIdentifier];
+        if (!folderName) { folderName = [@"corp.sap." stringByAppendingString:[[NSProcessInfo processInfo] processName]]; }
+        
+        filePath = [[[cachesURL path] stringByAppendingPathComponent:folderName] stringByAppendingPathComponent:kMTBannerLayoutMetricsFileName];
+    }
+    
+    return filePath;
+}
+
++ (NSString*)textMetricsVersion
+{
+    // the metrics are only valid for the reference font size they have been measured at
+    return [NSString stringWithFormat:@"%d|%.1f", kMTBannerLayoutMetricsVersion, kMTBannerLayoutReferenceFontSize];
+}
+
++ (NSMutableDictionary*)textMetrics
+{
+    static NSMutableDictionary *textMetrics = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
+        
+        NSString *filePath = [self textMetricsFilePath];
+        NSDictionary *storedFile = (filePath) ? [NSDictionary dictionaryWithContentsOfFile:filePath] : nil;
+        NSDictionary *storedMetrics = [storedFile objectForKey:kMTBannerLayoutMetricsEntriesKey];
+        
+        // metrics of other versions are discarded
+        if ([[storedFile objectForKey:kMTBannerLayoutMetricsVersionKey] isEqual:[self textMetricsVersion]] &&
+            [storedMetrics isKindOfClass:[NSDictionary class]] && [storedMetrics count] <= kMTBannerLayoutMetricsCountLimit) {
+            textMetrics = [storedMetrics mutableCopy];
+        }
+        
+        if (!textMetrics) { textMetrics = [[NSMutableDictionary alloc] init]; }
+    });
+    
+    return textMetrics;
+}
+
++ (dispatch_queue_t)textMetricsQueue
+{
+    static dispatch_queue_t textMetricsQueue = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
+        textMetricsQueue = dispatch_queue_create("corp.sap.Icons.bannerlayout.metrics", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+    });
+    
+    return textMetricsQueue;
+}
+
++ (void)saveTextMetrics
+{
+    static BOOL savePending = NO;
+    NSMutableDictionary *textMetrics = [self textMetrics];
+    
+    // the file is written in the background and metrics that are measured
+    // while a write is pending are written with it, so typing a banner text
+    // does not write the file for every keystroke
+    @synchronized (textMetrics) {
+        
+        if (savePending) { return; }
+        savePending = YES;
+    }
+    
+    dispatch_async([self textMetricsQueue], ^{
+        
+        NSDictionary *metricsToStore = nil;
+        
+        @synchronized (textMetrics) {
+            
+            metricsToStore = [textMetrics copy];
+            savePending = NO;
+        }
+        
+        NSString *filePath = [self textMetricsFilePath];
+        
+        if (filePath) {
+            
+            [[NSFileManager defaultManager] createDirectoryAtPath:[filePath stringByDeletingLastPathComponent]
+                                      withIntermediateDirectories:YES
+                                                       attributes:nil
+                                                            error:nil
+            ];
+            
+            NSDictionary *storedFile = [NSDictionary dictionaryWithObjectsAndKeys:
+                                        [self textMetricsVersion], kMTBannerLayoutMetricsVersionKey,
+                                        metricsToStore, kMTBannerLayoutMetricsEntriesKey,
+                                        nil
+            ];
+            
+            [storedFile writeToFile:filePath atomically:YES];
+        }
+    });
+}
+
++ (void)synchronizeTextMetrics
+{
+    dispatch_sync([self textMetricsQueue], ^{});
+}
+
++ (NSSize)referenceSizeForString:(NSAttributedString*)string
+{
+    NSSize referenceSize = NSZeroSize;
+    NSFont *font = [string font];
+    
+    // the metrics are kept across launches, so an updated
+    // font must not use the metrics of its previous version
+    NSString *fontVersion = CFBridgingRelease(CTFontCopyName((__bridge CTFontRef)font, kCTFontVersionNameKey));
+    NSString *metricsKey = [NSString stringWithFormat:@"%@|%@|%@", [font fontName], (fontVersion) ? fontVersion : @"", [string string]];
+    
+    NSMutableDictionary *textMetrics = [self textMetrics];
+    NSString *storedSize = nil;
+    
+    @synchronized (textMetrics) {
+        storedSize = [textMetrics objectForKey:metricsKey];
+    }
+    
+    if ([storedSize isKindOfClass:[NSString class]]) {
+        
+        referenceSize = NSSizeFromString(storedSize);
+        
+    } else {
+        
+        // the glyph outlines scale linearly with the font size, so the image
+        // bounds measured once at the reference size are valid for the
+        // layouts of all banner sizes
+        NSMutableAttributedString *referenceString = [[NSMutableAttributedString alloc] initWithAttributedString:string];
+        [referenceString addAttribute:NSFontAttributeName
+                                value:[[NSFontManager sharedFontManager] convertFont:[string font]
+                                                                              toSize:kMTBannerLayoutReferenceFontSize]
+                                range:NSMakeRange(0, [referenceString length])
+        ];
+        
+        CGRect imageBounds = [referenceString imageBounds];
+        
+        if (!CGRectIsNull(imageBounds)) {
+            
+            referenceSize = imageBounds.size;
+            
+            @synchronized (textMetrics) {
+                
+                if ([textMetrics count] >= kMTBannerLayoutMetricsCountLimit) { [textMetrics removeAllObjects]; }
+                [textMetrics setObject:NSStringFromSize(referenceSize) forKey:metricsKey];
+            }
+            
+            [self saveTextMetrics];
+        }
+    }
+    
+    return referenceSize;
+}
+
++ (MTBannerLayout*)layoutWithSize:(NSSize)size
+                         position:(MTBannerPosition)position
+                            angle:(CGFloat)angle
+                           height:(CGFloat)height
+                           margin:(CGFloat)margin
+                       textMargin:(CGFloat)textMargin
+{
+    // we quantize the parameters, so values that only differ
+    // by rounding errors share the same layout
+    textMargin = fmin(fmax(textMargin, kMTBannerTextMarginMin), kMTBannerTextMarginMax);
+    
+    size = NSMakeSize(quantize(size.width, kMTBannerLayoutQuantizationSize), quantize(size.height, kMTBannerLayoutQuantizationSize));
+    angle = quantize(angle, kMTBannerLayoutQuantizationAngle);
+    height = quantize(height, kMTBannerLayoutQuantizationFactor);
+    margin = quantize(margin, kMTBannerLayoutQuantizationFactor);
+    textMargin = quantize(textMargin, kMTBannerLayoutQuantizationFactor);
+    
+    NSString *cacheKey = [NSString stringWithFormat:@"%.2fx%.2f|%d|%.2f|%.4f|%.4f|%.4f", size.width, size.height, position, angle, height, margin, textMargin];
+    NSCache *layoutCache = [self layoutCache];
+    MTBannerLayout *layout = [layoutCache objectForKey:cacheKey];
+    
+    if (!layout) {
+        
+        layout = [[MTBannerLayout alloc] initWithSize:size
+                                             position:position
+                                                angle:angle
+                                               height:height
+                                               margin:margin
+                                           textMargin:textMargin
+        ];
+        
+        if (layout) { [layoutCache setObject:layout forKey:cacheKey]; }
+    }
+    
+    return layout;
+}
+
+- (instancetype)initWithSize:(NSSize)size
+                    position:(MTBannerPosition)position
+                       angle:(CGFloat)angle
+                      height:(CGFloat)height
+                      margin:(CGFloat)margin
+                  textMargin:(CGFloat)textMargin
+{
+    self = [super init];
+    
+    if (self) {
+        
+        MTTraceTimestamp traceBegin = MTTraceBegin();
+        _textCache = [[NSMutableDictionary alloc] init];
+        
+        // calculate size and position of the banner
+        NSRect viewBounds = NSMakeRect(0, 0, size.width, size.height);
+        CGFloat viewHeight = size.height;
+        CGFloat viewWidth = size.width;
+        CGFloat bannerHeight = viewHeight * height;
+        CGFloat bannerWidth = viewWidth * 2.0;
+        CGFloat bannerOffset = viewHeight * margin;
+        CGFloat textPadding = bannerHeight * textMargin;
+        
+        if (position == MTBannerPositionTop || position == MTBannerPositionBottom) {
+            
+            bannerOffset = (bannerOffset + bannerHeight > viewHeight / 2.0) ? viewHeight / 2.0 - bannerHeight : bannerOffset;
+        }
+            
+        CGFloat xPos = 0;
+        CGFloat yPos = 0;
+        CGFloat rotationAngle = 0;
+        
+        switch (position) {
+                
+            case MTBannerPositionTopLeft:
+                
+                yPos = viewHeight;
+                rotationAngle = angle;
+                break;
+                
+            case MTBannerPositionTopRight:
+                
+                xPos = viewWidth;
+                yPos = viewHeight;
+                rotationAngle = -angle;
+                break;
+                
+            case MTBannerPositionBottomLeft:
+                
+                rotationAngle = -angle;
+                break;
+                
+            case MTBannerPositionBottomRight:
+                
+                xPos = viewWidth;
+                rotationAngle = angle;
+                break;
+                
+            case MTBannerPositionTop:
+                
+                yPos = viewHeight - bannerHeight - bannerOffset;
+                break;
+                
+            case MTBannerPositionBottom:
+                
+                yPos = bannerOffset;
+                break;
+                
+            default:
+                break;
+        }
+        
+        NSRect bannerRect = NSMakeRect(0, 0, bannerWidth, bannerHeight);
+        NSPoint rectCenter = NSMakePoint(NSMidX(bannerRect), (yPos > 0) ? NSMaxY(bannerRect) : NSMinY(bannerRect));
+        
+        NSPoint viewCenter = NSMakePoint(NSMidX(viewBounds), NSMidY(viewBounds));
+        NSPoint dirVec = NSMakePoint(viewCenter.x - xPos, viewCenter.y - yPos);
+        CGFloat len = sqrt(dirVec.x * dirVec.x + dirVec.y * dirVec.y);
+        NSPoint offsetVec = NSMakePoint(dirVec.x / len * bannerOffset, dirVec.y / len * bannerOffset);
+        NSPoint pivot = NSMakePoint(xPos + offsetVec.x, yPos + offsetVec.y);
+        
+        NSAffineTransform *transform = [NSAffineTransform transform];
+        
+        if (position == MTBannerPositionTop || position == MTBannerPositionBottom) {
+            
+            [transform translateXBy:xPos yBy:yPos];
+            
+        } else {
+            
+            [transform translateXBy:xPos yBy:yPos];
+            [transform translateXBy:offsetVec.x yBy:offsetVec.y];
+            [transform rotateByDegrees:rotationAngle];
+            [transform translateXBy:-rectCenter.x yBy:-rectCenter.y];
+        }
+        
+        _bannerRect = bannerRect;
+        _rectCenter = rectCenter;
+        _transformStruct = [transform transformStruct];
+        _minimumFontSize = bannerHeight * .3; // minimum font size is 30% of the banner height
+
+        // create a polygon from the visible banner
+        NSPoint rp[4] = {
+            [transform transformPoint:NSMakePoint(NSMinX(bannerRect), NSMinY(bannerRect))],
+            [transform transformPoint:NSMakePoint(NSMaxX(bannerRect), NSMinY(bannerRect))],
+            [transform transformPoint:NSMakePoint(NSMaxX(bannerRect), NSMaxY(bannerRect))],
+            [transform transformPoint:NSMakePoint(NSMinX(bannerRect), NSMaxY(bannerRect))]
+        };
+
+        MTPolygon poly[16] = {
+            {rp[0].x,rp[0].y}, {rp[1].x,rp[1].y},
+            {rp[2].x,rp[2].y}, {rp[3].x,rp[3].y}
+        };
+        
+        int count = clipPolygonToRect(poly, 4, viewBounds);
+        _isVisible = (count >= 3);
+        
+        if (_isVisible) {
+            
+            MTPolygon centroid = polygonCentroid(poly, count);
+            NSPoint visibleCenter = NSMakePoint(centroid.x, centroid.y);
+
+            NSAffineTransform *invertTransform = [transform copy];
+            [invertTransform invert];
+            _textCenter = [invertTransform transformPoint:visibleCenter];
+            
+            // banner direction for projection
+            NSPoint dir = [transform transformPoint:NSMakePoint(bannerWidth, 0)];
+            dir.x -= pivot.x;
+            dir.y -= pivot.y;
+            len = hypot(dir.x, dir.y);
+            dir.x /= len;
+            dir.y /= len;
+            
+            CGFloat minProj = CGFLOAT_MAX, maxProj = -CGFLOAT_MAX;
+            
+            for (int i = 0; i<count; i++) {
+                
+                CGFloat proj = (poly[i].x - pivot.x) * dir.x + (poly[i].y - pivot.y) * dir.y;
+                minProj = MIN(minProj, proj);
+                maxProj = MAX(maxProj, proj);
+            }
+            
+            // dynamic horizontal padding to make sure we have more padding
+            // on lower offsets and less padding on higher offsets
+            CGFloat minPadding = viewWidth * .10; // 10%
+            CGFloat maxPadding = viewWidth * .15; // 15%
+            CGFloat maxOffset = hypot(viewWidth, viewHeight);
+            CGFloat horizontalPadding = minPadding + (maxPadding - minPadding) * (1.0 - bannerOffset/maxOffset);
+
+            _maxTextSize = NSMakeSize(
+                                      (maxProj - minProj) - 2 * horizontalPadding,
+                                      bannerHeight - 2 * textPadding // vertical padding
+                                      );
+        }
+        
+        MTTraceEnd("solve banner layout", traceBegin);
+    }
+    
+    return self;
+}
+
+- (NSAffineTransform*)transform
+{
+    NSAffineTransform *transform = [NSAffineTransform transform];
+    [transform setTransformStruct:_transformStruct];
+    
+    return transform;
+}
+
+- (CGFloat)fontSizeForString:(NSAttributedString*)string stringRect:(NSRect*)stringRect
+{
+    CGFloat fontSize = 0;
+    NSRect usedRect = NSZeroRect;
+    
+    if ([string length] > 0) {
+        
+        NSFont *font = [string font];
+        NSString *cacheKey = [NSString stringWithFormat:@"%@|%@", [font fontName], [string string]];
+        NSArray *cachedValues = nil;
+        
+        @synchronized (self) {
+            cachedValues = [_textCache objectForKey:cacheKey];
+        }
+        
+        if (cachedValues) {
+            
+            fontSize = [[cachedValues firstObject] doubleValue];
+            usedRect = [[cachedValues lastObject] rectValue];
+            
+        } else {
+            
+            MTTraceTimestamp traceBegin = MTTraceBegin();
+            
+            // the font sizes we check are on the same grid fontSizeToFitInRect:
+            // uses, starting one point below twice the height of the text rect
+            // and ending with the first size below the minimum font size
+            CGFloat startSize = _maxTextSize.height * 2;
+            CGFloat lastSize = startSize - floor(startSize - _minimumFontSize) - 1;
+            NSSize referenceSize = [MTBannerLayout referenceSizeForString:string];
+            
+            if (referenceSize.width > 0 && referenceSize.height > 0) {
+                
+                CGFloat scale = fmin(_maxTextSize.width / referenceSize.width, _maxTextSize.height / referenceSize.height);
+                CGFloat predictedSize = kMTBannerLayoutReferenceFontSize * scale;
+                
+                fontSize = startSize - fmax(1, ceil(startSize - predictedSize));
+                fontSize = fmax(fontSize, lastSize);
+                
+                // hinting, optical sizes and rounding make the image bounds
+                // differ slightly from the prediction, so we verify the predicted
+                // size and walk to the neighboring sizes until we find the largest
+                // one that fits
+                NSMutableAttributedString *sizedString = [[NSMutableAttributedString alloc] initWithAttributedString:string];
+                NSRange stringRange = NSMakeRange(0, [sizedString length]);
+                NSFontManager *fontManager = [NSFontManager sharedFontManager];
+                
+                CGRect (^boundsForSize)(CGFloat) = ^CGRect(CGFloat size) {
+                    
+                    [sizedString addAttribute:NSFontAttributeName
+                                        value:[fontManager convertFont:font toSize:size]
+                                        range:stringRange
+                    ];
+                    
+                    return [sizedString imageBounds];
+                };
+                
+                BOOL (^boundsFit)(CGRect) = ^BOOL(CGRect bounds) {
+                    return (ceil(NSHeight(bounds)) <= self->_maxTextSize.height && ceil(NSWidth(bounds)) <= self->_maxTextSize.width);
+                };
+                
+                usedRect = boundsForSize(fontSize);
+                
+                if (boundsFit(usedRect)) {
+                    
+                    while (fontSize + 1 < startSize) {
+                        
+                        CGRect largerRect = boundsForSize(fontSize + 1);
+                        if (!boundsFit(largerRect)) { break; }
+                        
+                        fontSize++;
+                        usedRect = largerRect;
+                    }
+                    
+                } else {
+                    
+                    while (!boundsFit(usedRect) && fontSize >= _minimumFontSize) {
+                        usedRect = boundsForSize(--fontSize);
+                    }
+                }
+                
+            } else {
+                
+                fontSize = [string fontSizeToFitInRect:NSMakeRect(0, 0, _maxTextSize.width, _maxTextSize.height)
+                                       minimumFontSize:_minimumFontSize
+                                       maximumFontSize:0
+                                        useImageBounds:YES
+                ];
+                
+                NSMutableAttributedString *sizedString = [[NSMutableAttributedString alloc] initWithAttributedString:string];
+                [sizedString addAttribute:NSFontAttributeName
+                                    value:[[NSFontManager sharedFontManager] convertFont:font toSize:fontSize]
+                                    range:NSMakeRange(0, [sizedString length])
+                ];
+                
+                usedRect = [sizedString imageBounds];
+            }
+            
+            MTTraceEnd("fit banner text", traceBegin);
+            
+            @synchronized (self) {
+                
+                if ([_textCache count] >= kMTBannerLayoutTextCacheCountLimit) { [_textCache removeAllObjects]; }
+                
+                [_textCache setObject:[NSArray arrayWithObjects:
+                                       [NSNumber numberWithDouble:fontSize],
+                                       [NSValue valueWithRect:usedRect],
+                                       nil]
+                               forKey:cacheKey
+                ];
+            }
+        }
+    }
+    
+    if (stringRect) { *stringRect = usedRect; }
+    
+    return fontSize;
+}
+
+@end
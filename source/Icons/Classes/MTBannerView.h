@@ -65,7 +65,7 @@ typedef enum {
  @abstract      A boolean value indicating whether the banner should be drawn into the icon shape.
  @discussion    Returns YES if the banner is drawn into the icon shape, otherwise returns NO.
 */
-@property (assign) BOOL clipToIconShape;
+@property (nonatomic, assign) BOOL clipToIconShape;
 
 /*!
  @property      isTruncatingText
@@ -0,0 +1,95 @@
+/*
+    MTBatchWriter.h
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @protocol      MTFileGroupWriter
+ @abstract      Defines an interface for objects that write groups of files (e.g. the files of an icon set).
+*/
+@protocol MTFileGroupWriter <NSObject>
+
+/*!
+ @method        addFiles:completionHandler:
+ @abstract      Write a group of files.
+ @param         files A dictionary containing the contents (NSData) of the files, keyed by their file names.
+ @param         completionHandler The handler that is called after the group has been written or if an error
+                occurred. May be nil.
+ @discussion    Groups are written in the order they have been added.
+*/
+- (void)addFiles:(NSDictionary*)files completionHandler:(void (^) (BOOL success, NSError *error))completionHandler;
+
+/*!
+ @method        flush
+ @abstract      Write all groups that have been added.
+ @discussion    Blocks until all groups have been written. Returns YES if all groups that have been added since the
+                last call of this method have been written successfully, otherwise returns NO.
+*/
+- (BOOL)flush;
+
+@end
+
+/*!
+ @class         MTBatchWriter
+ @abstract      A class that writes groups of files (e.g. the files of an icon set) to a folder, so that either all or
+                none of the files of a group exist, even if the process or the system crashes while writing.
+ @discussion    Groups are written in the background. Their files are first written to hidden staging files in the
+                destination folder. A number of groups is then committed together: The staging files and a manifest
+                are flushed to disk in parallel, the manifest is renamed to a commit marker and the folder is synced
+                once for the whole batch. After that, the staging files are renamed to their final names. Interrupted
+                batches are rolled forward (if committed) or rolled back (if not) the next time a batch writer is
+                created for the folder.
+*/
+
+@interface MTBatchWriter : NSObject <MTFileGroupWriter>
+
+/*!
+ @method        init:
+ @discussion    The init method is not available. Please use initWithFolderPath:batchSize: instead.
+*/
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        initWithFolderPath:batchSize:
+ @abstract      Initialize a MTBatchWriter object for the given folder.
+ @param         folderPath The path of the folder the files should be written to.
+ @param         batchSize The number of groups that are committed together. If 0, groups are only committed if
+                flush is called.
+ @discussion    Returns an initialized MTBatchWriter object. Interrupted batches of previous batch writers for the
+                same folder are recovered first.
+*/
+- (instancetype)initWithFolderPath:(NSString*)folderPath batchSize:(NSUInteger)batchSize NS_DESIGNATED_INITIALIZER;
+
+/*!
+ @method        addFiles:completionHandler:
+ @abstract      Write a group of files.
+ @param         files A dictionary containing the contents (NSData) of the files, keyed by their file names.
+ @param         completionHandler The handler that is called on a background queue after the group has been committed
+                or if an error occurred. May be nil.
+ @discussion    This method returns immediately. Existing files with the same names are replaced.
+*/
+- (void)addFiles:(NSDictionary*)files completionHandler:(void (^) (BOOL success, NSError *error))completionHandler;
+
+/*!
+ @method        flush
+ @abstract      Commit all groups that have been added.
+ @discussion    Blocks until all groups have been written and committed. Returns YES if all groups that have been
+                added since the last call of this method have been written successfully, otherwise returns NO.
+*/
+- (BOOL)flush;
+
+@end
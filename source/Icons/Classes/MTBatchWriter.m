@@ -0,0 +1,325 @@
+/*
+    MTBatchWriter.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTBatchWriter.h"
+#import "MTTrace.h"
+#import <fcntl.h>
+#import <unistd.h>
+#import <signal.h>
+#import <stdatomic.h>
+
+#define kMTBatchWriterFilePrefix        @".icons_"
+#define kMTBatchWriterManifestExtension @"manifest"
+#define kMTBatchWriterCommitExtension   @"commit"
+
+@interface MTBatchWriterGroup : NSObject
+@property (nonatomic, strong, readwrite) NSMutableArray *stagedNames;
+@property (nonatomic, strong, readwrite) NSMutableArray *fileNames;
+@property (nonatomic, copy, readwrite) void (^completionHandler)(BOOL success, NSError *error);
+@end
+
+@implementation MTBatchWriterGroup
+@end
+
+@interface MTBatchWriter ()
+@property (nonatomic, strong, readwrite) NSString *folderPath;
+@property (nonatomic, assign) NSUInteger batchSize;
+@end
+
+@implementation MTBatchWriter
+{
+    dispatch_queue_t _queue;
+    NSMutableArray *_groups;
+    NSString *_batchID;
+    NSUInteger _groupCount;
+    BOOL _failed;
+}
+
+static NSError *posixError(void)
+{
+    return [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+}
+
+static BOOL writeAll(int fileDescriptor, NSData *data)
+{
+    const UInt8 *bytes = [data bytes];
+    NSUInteger remainingLength = [data length];
+
+    while (remainingLength > 0) {
+
+        ssize_t writtenLength = write(fileDescriptor, bytes, remainingLength);
+
+        if (writtenLength < 0) {
+            if (errno == EINTR) { continue; }
+            return NO;
+        }
+
+        bytes += writtenLength;
+        remainingLength -= writtenLength;
+    }
+
+    return YES;
+}
+
+- (instancetype)initWithFolderPath:(NSString*)folderPath batchSize:(NSUInteger)batchSize
+{
+    self = [super init];
+
+    if (self) {
+
+        _folderPath = folderPath;
+        _batchSize = batchSize;
+        _groups = [[NSMutableArray alloc] init];
+        _queue = dispatch_queue_create("corp.sap.Icons.batchwriter", DISPATCH_QUEUE_SERIAL);
+
+        [self recover];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [self commit];
+}
+
+- (NSString*)pathWithName:(NSString*)name
+{
+    return [_folderPath stringByAppendingPathComponent:name];
+}
+
+- (BOOL)syncFolder
+{
+    int folderDescriptor = open([_folderPath fileSystemRepresentation], O_RDONLY | O_CLOEXEC);
+    BOOL success = (folderDescriptor >= 0 && fsync(folderDescriptor) == 0);
+    if (folderDescriptor >= 0) { close(folderDescriptor); }
+
+    return success;
+}
+
+- (void)recover
+{
+    NSArray *contents = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:_folderPath error:nil];
+    NSMutableArray *staleNames = [NSMutableArray array];
+
+    for (NSString *name in contents) {
+
+        if (![name hasPrefix:kMTBatchWriterFilePrefix]) { continue; }
+
+        // the names contain the id of the process that wrote them,
+        // so we don't touch batches that are still being written
+        NSArray *nameComponents = [name componentsSeparatedByString:@"_"];
+        pid_t processID = ([nameComponents count] > 1) ? (pid_t)[[nameComponents objectAtIndex:1] intValue] : 0;
+        if (processID > 0 && (kill(processID, 0) == 0 || errno == EPERM)) { continue; }
+
+        if ([[name pathExtension] isEqualToString:kMTBatchWriterCommitExtension]) {
+
+            // the batch has been committed, so we finish moving its files into place
+            NSArray *manifest = [NSArray arrayWithContentsOfFile:[self pathWithName:name]];
+
+            for (NSArray *entry in manifest) {
+
+                if ([entry isKindOfClass:[NSArray class]] && [entry count] == 2) {
+                    rename([[self pathWithName:[entry firstObject]] fileSystemRepresentation], [[self pathWithName:[entry lastObject]] fileSystemRepresentation]);
+                }
+            }
+        }
+
+        [staleNames addObject:name];
+    }
+
+    // everything else belongs to batches that have not been committed
+    for (NSString *name in staleNames) { unlink([[self pathWithName:name] fileSystemRepresentation]); }
+}
+
+- (void)addFiles:(NSDictionary*)files completionHandler:(void (^) (BOOL success, NSError *error))completionHandler
+{
+    dispatch_async(_queue, ^{
+
+        MTTraceTimestamp traceBegin = MTTraceBegin();
+
+        if (!self->_batchID) { self->_batchID = [NSString stringWithFormat:@"%d_%@", getpid(), [[NSUUID UUID] UUIDString]]; }
+
+        MTBatchWriterGroup *group = [[MTBatchWriterGroup alloc] init];
+        [group setStagedNames:[NSMutableArray array]];
+        [group setFileNames:[NSMutableArray array]];
+        [group setCompletionHandler:completionHandler];
+
+        NSError *error = nil;
+        BOOL success = ([files count] > 0);
+
+        // the files are written without syncing them, they are flushed to disk
+        // together when the batch is committed. Every file is closed right
+        // away, so a batch does not keep hundreds of descriptors open
+        for (NSString *fileName in [[files allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+
+            NSData *fileData = [files objectForKey:fileName];
+            NSString *stagedName = [NSString stringWithFormat:@"%@%@_%lu_%@", kMTBatchWriterFilePrefix, self->_batchID, (unsigned long)self->_groupCount, fileName];
+            int fileDescriptor = open([[self pathWithName:stagedName] fileSystemRepresentation], O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+            if (fileDescriptor < 0) {
+
+                error = posixError();
+                success = NO;
+                break;
+            }
+
+            [[group stagedNames] addObject:stagedName];
+            [[group fileNames] addObject:fileName];
+
+            BOOL written = ([fileData isKindOfClass:[NSData class]] && writeAll(fileDescriptor, fileData));
+            if (!written) { error = ([fileData isKindOfClass:[NSData class]]) ? posixError() : [NSError errorWithDomain:NSOSStatusErrorDomain code:writErr userInfo:nil]; }
+            if (close(fileDescriptor) != 0 && written) { error = posixError(); written = NO; }
+
+            if (!written) {
+
+                success = NO;
+                break;
+            }
+        }
+
+        self->_groupCount++;
+
+        if (success) {
+
+            [self->_groups addObject:group];
+
+        } else {
+
+            [self discardGroup:group];
+            self->_failed = YES;
+            if (completionHandler) { completionHandler(NO, error); }
+        }
+
+        MTTraceEnd("stage files", traceBegin);
+
+        if (self->_batchSize > 0 && [self->_groups count] >= self->_batchSize) { [self commit]; }
+    });
+}
+
+- (void)discardGroup:(MTBatchWriterGroup*)group
+{
+    for (NSString *stagedName in [group stagedNames]) { unlink([[self pathWithName:stagedName] fileSystemRepresentation]); }
+}
+
+- (BOOL)flush
+{
+    __block BOOL success = NO;
+
+    dispatch_sync(_queue, ^{
+
+        [self commit];
+        success = !self->_failed;
+        self->_failed = NO;
+    });
+
+    return success;
+}
+
+- (void)commit
+{
+    if ([_groups count] == 0) { return; }
+
+    MTTraceTimestamp traceBegin = MTTraceBegin();
+
+    NSMutableArray *manifest = [NSMutableArray array];
+    NSMutableArray *syncNames = [NSMutableArray array];
+
+    for (MTBatchWriterGroup *group in _groups) {
+
+        for (NSUInteger i = 0; i < [[group stagedNames] count]; i++) {
+            [manifest addObject:[NSArray arrayWithObjects:[[group stagedNames] objectAtIndex:i], [[group fileNames] objectAtIndex:i], nil]];
+        }
+
+        [syncNames addObjectsFromArray:[group stagedNames]];
+    }
+
+    NSError *error = nil;
+    NSString *manifestName = [NSString stringWithFormat:@"%@%@.%@", kMTBatchWriterFilePrefix, _batchID, kMTBatchWriterManifestExtension];
+    NSString *commitName = [[manifestName stringByDeletingPathExtension] stringByAppendingPathExtension:kMTBatchWriterCommitExtension];
+    NSData *manifestData = [NSPropertyListSerialization dataWithPropertyList:manifest format:NSPropertyListBinaryFormat_v1_0 options:0 error:&error];
+
+    int manifestDescriptor = open([[self pathWithName:manifestName] fileSystemRepresentation], O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    BOOL success = (manifestData && manifestDescriptor >= 0 && writeAll(manifestDescriptor, manifestData));
+    if (!success && !error) { error = posixError(); }
+    if (manifestDescriptor >= 0 && close(manifestDescriptor) != 0 && success) { error = posixError(); success = NO; }
+
+    if (success) {
+
+        // flush the staged files and the manifest in parallel, so the
+        // latencies of the individual flushes (e.g. on network volumes)
+        // overlap instead of adding up. The files are opened again one
+        // at a time per worker, which limits the number of open descriptors.
+        // The workers report failures through an atomic flag on our stack,
+        // which is valid because dispatch_apply() waits for all of them
+        atomic_bool syncFailed = false;
+        atomic_bool *syncFailedFlag = &syncFailed;
+        [syncNames addObject:manifestName];
+
+        dispatch_apply([syncNames count], DISPATCH_APPLY_AUTO, ^(size_t index) {
+
+            int fileDescriptor = open([[self pathWithName:[syncNames objectAtIndex:index]] fileSystemRepresentation], O_RDONLY | O_CLOEXEC);
+            if (fileDescriptor < 0 || fsync(fileDescriptor) != 0) { atomic_store(syncFailedFlag, true); }
+            if (fileDescriptor >= 0) { close(fileDescriptor); }
+        });
+
+        success = !atomic_load(&syncFailed);
+        if (!success) { error = [NSError errorWithDomain:NSPOSIXErrorDomain code:EIO userInfo:nil]; }
+    }
+
+    if (success) {
+
+        // renaming the manifest commits the batch. Syncing the folder makes the
+        // commit marker and the entries of the staged files durable at once
+        success = (rename([[self pathWithName:manifestName] fileSystemRepresentation], [[self pathWithName:commitName] fileSystemRepresentation]) == 0);
+
+        if (success) { success = [self syncFolder]; }
+        if (!success) { error = posixError(); }
+    }
+
+    if (success) {
+
+        // if we crash while moving the files into place, the
+        // batch is completed the next time the folder is recovered
+        for (NSArray *entry in manifest) {
+            rename([[self pathWithName:[entry firstObject]] fileSystemRepresentation], [[self pathWithName:[entry lastObject]] fileSystemRepresentation]);
+        }
+
+        // the commit marker is only removed once the renames are durable. If
+        // the folder can't be synced, we leave it to the next recovery
+        if ([self syncFolder]) { unlink([[self pathWithName:commitName] fileSystemRepresentation]); }
+
+    } else {
+
+        for (MTBatchWriterGroup *group in _groups) { [self discardGroup:group]; }
+        unlink([[self pathWithName:manifestName] fileSystemRepresentation]);
+        unlink([[self pathWithName:commitName] fileSystemRepresentation]);
+        _failed = YES;
+    }
+
+    MTTraceEnd("commit files", traceBegin);
+
+    for (MTBatchWriterGroup *group in _groups) {
+        if ([group completionHandler]) { [group completionHandler](success, (success) ? nil : error); }
+    }
+
+    [_groups removeAllObjects];
+    _batchID = nil;
+    _groupCount = 0;
+}
+
+@end
@@ -18,6 +18,12 @@
 #import <Cocoa/Cocoa.h>
 #import "MTIconView.h"
 
+/*!
+ @define        kMTDropViewContentInset
+ @abstract      The distance between the edges of a drop view and the view containing the actual icon.
+*/
+#define kMTDropViewContentInset  7.0
+
 @class MTDropView;
 
 /*!
@@ -99,4 +105,12 @@
  */
 @property (nonatomic, assign) BOOL isAppBundle;
 
+/*!
+ @method        frameWithContentSize:
+ @abstract      Returns the frame a drop view needs to have, so its icon is exactly of the given size.
+ @param         contentSize The size of the icon.
+ @discussion    Use this method to create off-screen views that render the icon directly at the output size.
+ */
++ (NSRect)frameWithContentSize:(NSSize)contentSize;
+
 @end
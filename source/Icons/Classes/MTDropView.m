@@ -17,12 +17,16 @@
 
 #import "MTDropView.h"
 #import "MTImage.h"
+#import "MTTrace.h"
 #import "Constants.h"
 #import <UniformTypeIdentifiers/UTCoreTypes.h>
 
 @interface MTDropView ()
 @property (nonatomic, strong, readwrite) NSView *dropZoneView;
 @property (nonatomic, assign) BOOL highlight;
+@property (nonatomic, strong, readwrite) NSImage *shapedImage;
+@property (nonatomic, strong, readwrite) NSImage *shapedSourceImage;
+@property (assign) BOOL shapedWithOldIconShape;
 
 @end
 
@@ -108,6 +112,16 @@
     [self addConstraints:[NSArray arrayWithObjects:dropZoneViewCenterX, dropZoneViewCenterY, dropZoneViewWidthRatio, nil]];
 }
 
++ (NSRect)frameWithContentSize:(NSSize)contentSize
+{
+    return NSMakeRect(
+                      0,
+                      0,
+                      contentSize.width + 2 * kMTDropViewContentInset,
+                      contentSize.height + 2 * kMTDropViewContentInset
+                      );
+}
+
 - (void)drawRect:(NSRect)dirtyRect
 {
     [super drawRect:dirtyRect];
@@ -128,11 +142,32 @@
     
     if (!_isAppBundle && _applyIconShape) {
         
-        MTIconView *iconView = [[MTIconView alloc] initWithFrame:NSMakeRect(0, 0, kMTOutputSizeMax, kMTOutputSizeMax)];
-        [iconView setUsesOldIconShape:_usesOldIconShape];
-        [iconView setImage:image];
+        // the icon shape is only rendered again if the image
+        // or the shape have changed since the last time
+        if (image != _shapedSourceImage || _usesOldIconShape != _shapedWithOldIconShape || !_shapedImage) {
+            
+            // images that already have an icon shape (like
+            // exported app icons) are used as they are
+            if ([MTIconView imageHasIconShape:image]) {
+                
+                _shapedImage = image;
+                
+            } else {
+                
+                MTIconView *iconView = [[MTIconView alloc] initWithFrame:NSMakeRect(0, 0, kMTOutputSizeMax, kMTOutputSizeMax)];
+                [iconView setUsesOldIconShape:_usesOldIconShape];
+                [iconView setImage:image];
                 
-        _image = [NSImage imageWithView:iconView size:NSMakeSize(kMTOutputSizeMax, kMTOutputSizeMax)];
+                MTTraceTimestamp traceBegin = MTTraceBegin();
+                _shapedImage = [NSImage imageWithView:iconView size:NSMakeSize(kMTOutputSizeMax, kMTOutputSizeMax)];
+                MTTraceEnd("apply icon shape", traceBegin);
+            }
+            
+            _shapedSourceImage = image;
+            _shapedWithOldIconShape = _usesOldIconShape;
+        }
+        
+        _image = _shapedImage;
        
     } else {
         
@@ -140,6 +175,13 @@
     }
 }
 
+- (void)layoutSubtreeIfNeeded
+{
+    MTTraceTimestamp traceBegin = MTTraceBegin();
+    [super layoutSubtreeIfNeeded];
+    MTTraceEnd("layoutSubtreeIfNeeded", traceBegin);
+}
+
 - (void)mouseDown:(NSEvent *)event
 {
     if (_delegate && [_delegate respondsToSelector:@selector(view:hasBeenClickedAtLocation:)]) {
@@ -0,0 +1,82 @@
+/*
+    MTIconFile.h
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+/*!
+ @abstract      This class provides methods to get the icon of an app bundle without using NSWorkspace.
+ @discussion    The reader only uses Foundation, CoreGraphics and ImageIO. Instead of loading and decoding all
+                representations of an icon, it only reads the table of contents of an .icns file and then decodes
+                the single largest entry (PNG, JPEG 2000, ARGB or RLE compressed RGB with a separate mask).
+ */
+
+@interface MTIconFile : NSObject
+
+/*!
+ @method        iconFileNamesWithInfoDictionary:
+ @abstract      Get the possible file names of a bundle's .icns file.
+ @param         infoDictionary The contents of the bundle's Info.plist.
+ @discussion    Returns an array containing the file names specified by the CFBundleIconFile and CFBundleIconName
+                keys (in this order), with the .icns extension added if necessary. The files may not exist.
+ */
++ (NSArray*)iconFileNamesWithInfoDictionary:(NSDictionary*)infoDictionary;
+
+/*!
+ @method        iconFileURLWithBundleAtURL:
+ @abstract      Get the url of the .icns file of the given bundle.
+ @param         bundleURL The url of the bundle.
+ @discussion    Returns the url of the icon file specified by the CFBundleIconFile (or CFBundleIconName) key of the
+                bundle's Info.plist (XML or binary) or nil, if the bundle does not specify an existing icon file.
+ */
++ (NSURL*)iconFileURLWithBundleAtURL:(NSURL*)bundleURL;
+
+/*!
+ @method        iconNameWithBundleAtURL:
+ @abstract      Get the name of the icon in the bundle's asset catalog.
+ @param         bundleURL The url of the bundle.
+ @discussion    Returns the value of the CFBundleIconName key of the bundle's Info.plist or nil, if the key does not exist.
+ */
++ (NSString*)iconNameWithBundleAtURL:(NSURL*)bundleURL;
+
+/*!
+ @method        createImageWithICNSFileAtURL:
+ @abstract      Decode the largest image of the given .icns file.
+ @param         url The url of the .icns file.
+ @discussion    Returns an image or NULL if an error occurred. The caller is responsible for releasing the image.
+ */
++ (CGImageRef)createImageWithICNSFileAtURL:(NSURL*)url CF_RETURNS_RETAINED;
+
+/*!
+ @method        createImageWithICNSData:
+ @abstract      Decode the largest image of the given .icns data.
+ @param         data The contents of an .icns file.
+ @discussion    Returns an image or NULL if an error occurred. The caller is responsible for releasing the image.
+ */
++ (CGImageRef)createImageWithICNSData:(NSData*)data CF_RETURNS_RETAINED;
+
+/*!
+ @method        createImageWithBundleAtURL:
+ @abstract      Decode the largest icon image of the given bundle.
+ @param         bundleURL The url of the bundle.
+ @discussion    Returns an image or NULL if the bundle has no (supported) icon or an error occurred. If the bundle
+                does not contain an .icns file, the icon is read from the bundle's asset catalog (Assets.car).
+                The caller is responsible for releasing the image.
+ */
++ (CGImageRef)createImageWithBundleAtURL:(NSURL*)bundleURL CF_RETURNS_RETAINED;
+
+@end
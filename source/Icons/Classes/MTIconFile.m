@@ -0,0 +1,431 @@
+/*
+    MTIconFile.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTIconFile.h"
+#import "MTTrace.h"
+#import "MTAssetCatalog.h"
+#import <ImageIO/ImageIO.h>
+
+#define kMTIconFileHeaderSize   8
+#define kMTIconFileEntriesMax   256
+
+typedef struct {
+    OSType type;
+    OSType maskType;
+    NSUInteger pixelSize;
+    BOOL compressed;
+} MTIconFileEntryType;
+
+typedef struct {
+    OSType type;
+    uint64_t offset;
+    uint32_t length;
+} MTIconFileEntry;
+
+typedef NSData* (^MTIconFileReader)(uint64_t offset, NSUInteger length);
+
+// the known entry types, ordered by preference. Types without a mask type
+// contain PNG or JPEG 2000 data (or ARGB data for ic04 and ic05)
+static const MTIconFileEntryType entryTypes[] = {
+    { 'ic10', 0,      1024, NO  },
+    { 'ic14', 0,      512,  NO  },
+    { 'ic09', 0,      512,  NO  },
+    { 'ic13', 0,      256,  NO  },
+    { 'ic08', 0,      256,  NO  },
+    { 'ic07', 0,      128,  NO  },
+    { 'it32', 't8mk', 128,  YES },
+    { 'ic12', 0,      64,   NO  },
+    { 'icp6', 0,      64,   NO  },
+    { 'ih32', 'h8mk', 48,   YES },
+    { 'ic11', 0,      32,   NO  },
+    { 'ic05', 0,      32,   NO  },
+    { 'icp5', 0,      32,   NO  },
+    { 'il32', 'l8mk', 32,   YES },
+    { 'ic04', 0,      16,   NO  },
+    { 'icp4', 0,      16,   NO  },
+    { 'is32', 's8mk', 16,   YES }
+};
+
+static inline uint32_t readUInt32(const UInt8 *bytes)
+{
+    return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+}
+
+static BOOL decodePackBits(const UInt8 *source, NSUInteger sourceLength, NSUInteger *sourcePosition, UInt8 *destination, NSUInteger pixelCount)
+{
+    // the channel data is written into every fourth byte of the
+    // destination, so the channels end up interleaved as RGBA
+    NSUInteger position = *sourcePosition;
+    NSUInteger pixel = 0;
+
+    while (pixel < pixelCount && position < sourceLength) {
+
+        UInt8 control = source[position++];
+
+        if (control < 0x80) {
+
+            NSUInteger count = control + 1;
+            if (position + count > sourceLength || pixel + count > pixelCount) { return NO; }
+
+            for (NSUInteger i = 0; i < count; i++) { destination[(pixel++) * 4] = source[position++]; }
+
+        } else {
+
+            NSUInteger count = control - 0x80 + 3;
+            if (position >= sourceLength || pixel + count > pixelCount) { return NO; }
+
+            UInt8 value = source[position++];
+            for (NSUInteger i = 0; i < count; i++) { destination[(pixel++) * 4] = value; }
+        }
+    }
+
+    *sourcePosition = position;
+
+    return (pixel == pixelCount);
+}
+
+static CGImageRef createImageWithRGBAData(NSMutableData *pixelData, NSUInteger pixelSize)
+{
+    CGImageRef imageRef = NULL;
+    CGDataProviderRef dataProvider = CGDataProviderCreateWithCFData((__bridge CFDataRef)pixelData);
+
+    if (dataProvider) {
+
+        CGColorSpaceRef colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+
+        imageRef = CGImageCreate(
+                                 pixelSize,
+                                 pixelSize,
+                                 8,
+                                 32,
+                                 pixelSize * 4,
+                                 colorSpace,
+                                 (CGBitmapInfo)kCGImageAlphaLast,
+                                 dataProvider,
+                                 NULL,
+                                 false,
+                                 kCGRenderingIntentDefault
+                                 );
+
+        CGColorSpaceRelease(colorSpace);
+        CGDataProviderRelease(dataProvider);
+    }
+
+    return imageRef;
+}
+
+static CGImageRef createImageWithEncodedData(NSData *data)
+{
+    CGImageRef imageRef = NULL;
+    CGImageSourceRef imageSource = CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL);
+
+    if (imageSource) {
+
+        imageRef = CGImageSourceCreateImageAtIndex(imageSource, 0, NULL);
+        CFRelease(imageSource);
+    }
+
+    return imageRef;
+}
+
+static CGImageRef createImageWithARGBData(NSData *data, NSUInteger pixelSize)
+{
+    CGImageRef imageRef = NULL;
+    NSUInteger pixelCount = pixelSize * pixelSize;
+    NSMutableData *pixelData = [NSMutableData dataWithLength:pixelCount * 4];
+    UInt8 *pixels = [pixelData mutableBytes];
+
+    const UInt8 *bytes = [data bytes];
+    NSUInteger position = 4;
+
+    // the channels are stored as A, R, G, B planes
+    if (decodePackBits(bytes, [data length], &position, pixels + 3, pixelCount) &&
+        decodePackBits(bytes, [data length], &position, pixels + 0, pixelCount) &&
+        decodePackBits(bytes, [data length], &position, pixels + 1, pixelCount) &&
+        decodePackBits(bytes, [data length], &position, pixels + 2, pixelCount)) {
+
+        imageRef = createImageWithRGBAData(pixelData, pixelSize);
+    }
+
+    return imageRef;
+}
+
+static CGImageRef createImageWithRGBData(NSData *data, NSData *maskData, NSUInteger pixelSize, OSType type)
+{
+    CGImageRef imageRef = NULL;
+    NSUInteger pixelCount = pixelSize * pixelSize;
+    NSMutableData *pixelData = [NSMutableData dataWithLength:pixelCount * 4];
+    UInt8 *pixels = [pixelData mutableBytes];
+
+    const UInt8 *bytes = [data bytes];
+    NSUInteger length = [data length];
+    BOOL success = NO;
+
+    if (length == pixelCount * 4) {
+
+        // uncompressed 0RGB data
+        for (NSUInteger i = 0; i < pixelCount; i++) {
+            pixels[i * 4] = bytes[i * 4 + 1];
+            pixels[i * 4 + 1] = bytes[i * 4 + 2];
+            pixels[i * 4 + 2] = bytes[i * 4 + 3];
+        }
+
+        success = YES;
+
+    } else {
+
+        // it32 data starts with four zero bytes
+        NSUInteger position = (type == 'it32') ? 4 : 0;
+
+        success = (decodePackBits(bytes, length, &position, pixels + 0, pixelCount) &&
+                   decodePackBits(bytes, length, &position, pixels + 1, pixelCount) &&
+                   decodePackBits(bytes, length, &position, pixels + 2, pixelCount));
+    }
+
+    if (success) {
+
+        const UInt8 *mask = [maskData bytes];
+        BOOL hasMask = ([maskData length] >= pixelCount);
+
+        for (NSUInteger i = 0; i < pixelCount; i++) { pixels[i * 4 + 3] = (hasMask) ? mask[i] : 0xff; }
+
+        imageRef = createImageWithRGBAData(pixelData, pixelSize);
+    }
+
+    return imageRef;
+}
+
+static CGImageRef createImageWithReader(MTIconFileReader reader)
+{
+    CGImageRef imageRef = NULL;
+    NSData *header = reader(0, kMTIconFileHeaderSize);
+
+    if ([header length] == kMTIconFileHeaderSize && readUInt32([header bytes]) == 'icns') {
+
+        uint64_t fileLength = readUInt32([header bytes] + 4);
+        MTIconFileEntry entries[kMTIconFileEntriesMax];
+        NSUInteger entryCount = 0;
+
+        NSData *firstEntryHeader = reader(kMTIconFileHeaderSize, kMTIconFileHeaderSize);
+
+        if ([firstEntryHeader length] == kMTIconFileHeaderSize && readUInt32([firstEntryHeader bytes]) == 'TOC ') {
+
+            // the table of contents lists the type and length of
+            // all entries, so we get all offsets with a single read
+            uint32_t tocLength = readUInt32([firstEntryHeader bytes] + 4);
+            NSData *toc = (tocLength > kMTIconFileHeaderSize) ? reader(kMTIconFileHeaderSize * 2, tocLength - kMTIconFileHeaderSize) : nil;
+            const UInt8 *tocBytes = [toc bytes];
+            uint64_t offset = kMTIconFileHeaderSize + tocLength;
+
+            for (NSUInteger i = 0; i + kMTIconFileHeaderSize <= [toc length] && entryCount < kMTIconFileEntriesMax; i += kMTIconFileHeaderSize) {
+
+                uint32_t entryLength = readUInt32(tocBytes + i + 4);
+                if (entryLength < kMTIconFileHeaderSize) { break; }
+
+                entries[entryCount++] = (MTIconFileEntry){ readUInt32(tocBytes + i), offset + kMTIconFileHeaderSize, entryLength - kMTIconFileHeaderSize };
+                offset += entryLength;
+            }
+
+        } else {
+
+            // walk the entry headers
+            uint64_t offset = kMTIconFileHeaderSize;
+            NSData *entryHeader = firstEntryHeader;
+
+            while ([entryHeader length] == kMTIconFileHeaderSize && entryCount < kMTIconFileEntriesMax) {
+
+                uint32_t entryLength = readUInt32([entryHeader bytes] + 4);
+                if (entryLength < kMTIconFileHeaderSize || offset + entryLength > fileLength) { break; }
+
+                entries[entryCount++] = (MTIconFileEntry){ readUInt32([entryHeader bytes]), offset + kMTIconFileHeaderSize, entryLength - kMTIconFileHeaderSize };
+                offset += entryLength;
+
+                entryHeader = (offset + kMTIconFileHeaderSize <= fileLength) ? reader(offset, kMTIconFileHeaderSize) : nil;
+            }
+        }
+
+        // try the entries in the order of preference until one can be decoded
+        for (NSUInteger t = 0; t < sizeof(entryTypes) / sizeof(entryTypes[0]) && !imageRef; t++) {
+
+            MTIconFileEntryType entryType = entryTypes[t];
+
+            for (NSUInteger i = 0; i < entryCount && !imageRef; i++) {
+
+                if (entries[i].type != entryType.type) { continue; }
+
+                NSData *data = reader(entries[i].offset, entries[i].length);
+                if ([data length] != entries[i].length || [data length] < 4) { continue; }
+
+                if (entryType.compressed) {
+
+                    NSData *maskData = nil;
+
+                    for (NSUInteger m = 0; m < entryCount; m++) {
+                        if (entries[m].type == entryType.maskType) { maskData = reader(entries[m].offset, entries[m].length); break; }
+                    }
+
+                    imageRef = createImageWithRGBData(data, maskData, entryType.pixelSize, entryType.type);
+
+                } else if (readUInt32([data bytes]) == 'ARGB') {
+
+                    imageRef = createImageWithARGBData(data, entryType.pixelSize);
+
+                } else {
+
+                    imageRef = createImageWithEncodedData(data);
+                }
+            }
+        }
+    }
+
+    return imageRef;
+}
+
+@implementation MTIconFile
+
++ (NSDictionary*)infoDictionaryWithBundleAtURL:(NSURL*)bundleURL
+{
+    NSDictionary *infoDictionary = nil;
+    NSURL *infoURL = [bundleURL URLByAppendingPathComponent:@"Contents/Info.plist"];
+    NSData *infoData = [NSData dataWithContentsOfURL:infoURL];
+
+    if (infoData) {
+
+        // this handles both, XML and binary property lists
+        id propertyList = [NSPropertyListSerialization propertyListWithData:infoData
+                                                                    options:NSPropertyListImmutable
+                                                                     format:nil
+                                                                      error:nil
+        ];
+
+        if ([propertyList isKindOfClass:[NSDictionary class]]) { infoDictionary = propertyList; }
+    }
+
+    return infoDictionary;
+}
+
++ (NSArray*)iconFileNamesWithInfoDictionary:(NSDictionary*)infoDictionary
+{
+    NSMutableArray *iconFileNames = [NSMutableArray array];
+    id iconFile = [infoDictionary objectForKey:@"CFBundleIconFile"];
+    id iconName = [infoDictionary objectForKey:@"CFBundleIconName"];
+
+    NSMutableArray *iconNames = [NSMutableArray array];
+    if ([iconFile isKindOfClass:[NSString class]] && [iconFile length] > 0) { [iconNames addObject:iconFile]; }
+    if ([iconName isKindOfClass:[NSString class]] && [iconName length] > 0) { [iconNames addObject:iconName]; }
+
+    for (NSString *anIconName in iconNames) {
+
+        // the file extension is optional
+        NSString *fileName = ([[anIconName pathExtension] length] > 0) ? anIconName : [anIconName stringByAppendingPathExtension:@"icns"];
+        if (![iconFileNames containsObject:fileName]) { [iconFileNames addObject:fileName]; }
+    }
+
+    return iconFileNames;
+}
+
++ (NSURL*)iconFileURLWithBundleAtURL:(NSURL*)bundleURL
+{
+    NSURL *iconFileURL = nil;
+    NSDictionary *infoDictionary = [self infoDictionaryWithBundleAtURL:bundleURL];
+    NSURL *resourcesURL = [bundleURL URLByAppendingPathComponent:@"Contents/Resources"];
+
+    for (NSString *fileName in [self iconFileNamesWithInfoDictionary:infoDictionary]) {
+
+        NSURL *fileURL = [resourcesURL URLByAppendingPathComponent:fileName];
+
+        if ([[NSFileManager defaultManager] fileExistsAtPath:[fileURL path]]) {
+            iconFileURL = fileURL;
+            break;
+        }
+    }
+
+    return iconFileURL;
+}
+
++ (NSString*)iconNameWithBundleAtURL:(NSURL*)bundleURL
+{
+    NSString *iconName = [[self infoDictionaryWithBundleAtURL:bundleURL] objectForKey:@"CFBundleIconName"];
+    return ([iconName isKindOfClass:[NSString class]]) ? iconName : nil;
+}
+
++ (CGImageRef)createImageWithICNSFileAtURL:(NSURL*)url
+{
+    CGImageRef imageRef = NULL;
+    MTTraceTimestamp traceBegin = MTTraceBegin();
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForReadingFromURL:url error:nil];
+
+    if (fileHandle) {
+
+        imageRef = createImageWithReader(^NSData *(uint64_t offset, NSUInteger length) {
+
+            NSData *data = nil;
+            if ([fileHandle seekToOffset:offset error:nil]) { data = [fileHandle readDataUpToLength:length error:nil]; }
+
+            return data;
+        });
+
+        [fileHandle closeAndReturnError:nil];
+    }
+
+    MTTraceEnd("read icns", traceBegin);
+
+    return imageRef;
+}
+
++ (CGImageRef)createImageWithICNSData:(NSData*)data
+{
+    CGImageRef imageRef = NULL;
+
+    if (data) {
+
+        imageRef = createImageWithReader(^NSData *(uint64_t offset, NSUInteger length) {
+
+            NSData *subdata = nil;
+            if (offset + length <= [data length]) { subdata = [data subdataWithRange:NSMakeRange((NSUInteger)offset, length)]; }
+
+            return subdata;
+        });
+    }
+
+    return imageRef;
+}
+
++ (CGImageRef)createImageWithBundleAtURL:(NSURL*)bundleURL
+{
+    CGImageRef imageRef = NULL;
+    NSURL *iconFileURL = [self iconFileURLWithBundleAtURL:bundleURL];
+
+    if (iconFileURL) { imageRef = [self createImageWithICNSFileAtURL:iconFileURL]; }
+
+    if (!imageRef) {
+
+        // modern apps may only ship their icon in a compiled asset catalog
+        NSURL *catalogURL = [bundleURL URLByAppendingPathComponent:@"Contents/Resources/Assets.car"];
+        MTAssetCatalog *assetCatalog = [[MTAssetCatalog alloc] initWithContentsOfURL:catalogURL];
+
+        if (assetCatalog) {
+
+            NSString *iconName = [self iconNameWithBundleAtURL:bundleURL];
+            imageRef = [assetCatalog createImageNamed:([iconName length] > 0) ? iconName : @"AppIcon"];
+        }
+    }
+
+    return imageRef;
+}
+
+@end
@@ -18,14 +18,14 @@
 #import <Foundation/Foundation.h>
 #import "MTImage.h"
 
-@interface MTIconSet : NSObject
+@interface MTIconSet : NSObject <NSCopying>
 
 /*!
  @property      animationDuration
  @abstract      The duration for the animated uninstall image's animation.
  @discussion    The value of this property is a float value, specifying the duration of the animation.
  */
-@property (assign) CGFloat animationDuration;
+@property (nonatomic, assign) CGFloat animationDuration;
 
 /*!
  @property      fileNamePrefix
@@ -48,6 +48,34 @@
 */
 @property (nonatomic, strong, readwrite) NSImage *uninstallIcon;
 
+/*!
+ @method        installIconData
+ @abstract      Get the PNG data of the install icon.
+ @discussion    Returns the PNG data or nil if there's no install icon or an error occurred. The encoded images of
+                an icon set are cached until the corresponding icon (or the animation duration) changes and are
+                shared with copies of the icon set. So an icon set can be copied and written several times with
+                different install icons and file name prefixes (e.g. for several banner variants) without encoding
+                the uninstall icons again. The data methods may be called concurrently from different threads to
+                encode the icons in parallel, as long as each method is only called from one thread at a time.
+ */
+- (NSData*)installIconData;
+
+/*!
+ @method        uninstallIconData
+ @abstract      Get the PNG data of the uninstall icon.
+ @discussion    Returns the PNG data or nil if there's no uninstall icon or an error occurred. See installIconData
+                for details about caching.
+ */
+- (NSData*)uninstallIconData;
+
+/*!
+ @method        animatedUninstallIconData
+ @abstract      Get the APNG data of the animated uninstall icon.
+ @discussion    Returns the APNG data or nil if there's no uninstall icon, the animation duration is 0 or an error
+                occurred. See installIconData for details about caching.
+ */
+- (NSData*)animatedUninstallIconData;
+
 /*!
  @method        createFolderAtPath:folderName:appendTimestamp:
  @abstract      Create a folder at the given path and include an optional timestamp.
@@ -60,6 +88,16 @@
                      folderName:(NSString*)folderName
                 appendTimestamp:(BOOL)timestamp;
 
+/*!
+ @method        filesWithAnimatedOnly:
+ @abstract      Get the encoded images of the icon set, keyed by their file names.
+ @param         animatedOnly If set to YES and a valid uninstall image is set, only the animated version of the uninstall
+                image is returned and the regular uninstall image is skipped.
+ @discussion    Returns a dictionary containing the image data (NSData) keyed by file name, or nil if an image could not
+                be encoded. The file names include the file name prefix, if set.
+ */
+- (NSDictionary*)filesWithAnimatedOnly:(BOOL)animatedOnly;
+
 /*!
  @method        writeToFolder:createFolder:completionHandler:
  @abstract      Write the icon set (install, uninstall and animated uninstall icon) to file.
@@ -69,7 +107,9 @@
                 image is written and the regular uninstall image is skipped.
  @param         completionHandler The completion handler to call when the request is complete.
  @discussion    Returns a boolean indicating if the request was successful, the path where the images have been actually
-                created and a NSError object containing the underlying error if the request failed.
+                created and a NSError object containing the underlying error if the request failed. The images are
+                written using a MTBatchWriter, so either all or none of them are created. The render arena of the
+                calling thread is reset before the completion handler is called.
  */
 - (void)writeToFolder:(NSString *)path
          createFolder:(BOOL)createFolder
@@ -17,26 +17,83 @@
 
 #import "MTIconSet.h"
 #import "Constants.h"
+#import "MTTrace.h"
+#import "MTBatchWriter.h"
 #import <UniformTypeIdentifiers/UTCoreTypes.h>
 
+@interface MTIconSet ()
+@property (nonatomic, strong, readwrite) NSData *installIconPNGData;
+@property (nonatomic, strong, readwrite) NSData *uninstallIconPNGData;
+@property (nonatomic, strong, readwrite) NSData *animatedUninstallIconPNGData;
+@end
+
 @implementation MTIconSet
 
+- (id)copyWithZone:(NSZone *)zone
+{
+    MTIconSet *copiedIconSet = [[[self class] allocWithZone:zone] init];
+    
+    if (copiedIconSet) {
+        
+        // the encoded images are immutable, so
+        // they can be shared with the copy
+        copiedIconSet->_installIcon = _installIcon;
+        copiedIconSet->_uninstallIcon = _uninstallIcon;
+        copiedIconSet->_animationDuration = _animationDuration;
+        copiedIconSet->_fileNamePrefix = _fileNamePrefix;
+        copiedIconSet->_installIconPNGData = _installIconPNGData;
+        copiedIconSet->_uninstallIconPNGData = _uninstallIconPNGData;
+        copiedIconSet->_animatedUninstallIconPNGData = _animatedUninstallIconPNGData;
+    }
+    
+    return copiedIconSet;
+}
+
+- (void)setInstallIcon:(NSImage*)installIcon
+{
+    if (installIcon != _installIcon) {
+        
+        _installIcon = installIcon;
+        _installIconPNGData = nil;
+    }
+}
+
+- (void)setUninstallIcon:(NSImage*)uninstallIcon
+{
+    if (uninstallIcon != _uninstallIcon) {
+        
+        _uninstallIcon = uninstallIcon;
+        _uninstallIconPNGData = nil;
+        _animatedUninstallIconPNGData = nil;
+    }
+}
+
+- (void)setAnimationDuration:(CGFloat)animationDuration
+{
+    if (animationDuration != _animationDuration) {
+        
+        _animationDuration = animationDuration;
+        _animatedUninstallIconPNGData = nil;
+    }
+}
+
 - (void)uninstallAPNGWithCompletionHandler:(void (^) (NSData *imageData))completionHandler
 {
     NSData *imageData = nil;
+    MTTraceTimestamp traceBegin = MTTraceBegin();
     
     if ([_uninstallIcon isValid] && _animationDuration > 0) {
 
         // define the actual animation
         NSArray *rotationPath = [NSArray arrayWithObjects:
                                  [NSNumber numberWithFloat:0.0],
-                                 [NSNumber numberWithFloat:-1.0],
-                                 [NSNumber numberWithFloat:-2.0],
-                                 [NSNumber numberWithFloat:-1.0],
+                                 [NSNumber numberWithFloat:-kMTAnimationRotationAngle / 2],
+                                 [NSNumber numberWithFloat:-kMTAnimationRotationAngle],
+                                 [NSNumber numberWithFloat:-kMTAnimationRotationAngle / 2],
                                  [NSNumber numberWithFloat:0.0],
-                                 [NSNumber numberWithFloat:1.0],
-                                 [NSNumber numberWithFloat:2.0],
-                                 [NSNumber numberWithFloat:1.0],
+                                 [NSNumber numberWithFloat:kMTAnimationRotationAngle / 2],
+                                 [NSNumber numberWithFloat:kMTAnimationRotationAngle],
+                                 [NSNumber numberWithFloat:kMTAnimationRotationAngle / 2],
                                  nil];
         
         // define the loop
@@ -69,32 +126,95 @@
                 
                 CGImageDestinationSetProperties(imageDestination, NULL);
                 
+                // the frames are rendered into the render arena. Every frame image gets
+                // a copy of the pixels, so the arena memory is reused for the next icon
+                // as soon as the image destination has been finalized.
+                MTRenderArenaRef arena = MTRenderArenaGetCurrent();
+                MTRenderArenaMark arenaMark = MTRenderArenaGetMark(arena);
+                NSSize pixelSize = [_uninstallIcon pixelSize];
+                
+                // only the non-transparent part of the icon has to be rotated, the
+                // rest of every frame stays cleared. we add a small margin, so the
+                // edges are interpolated exactly as if the whole icon was drawn.
+                NSRect sourceRect = [_uninstallIcon opaqueRectWithPixelSize:pixelSize];
+                if (!NSIsEmptyRect(sourceRect)) { sourceRect = NSInsetRect(sourceRect, -2, -2); }
+                
+                // frames with the same angle are identical,
+                // so every angle is only rendered once
+                NSMutableDictionary *renderedFrames = [NSMutableDictionary dictionary];
+                
                 for (NSNumber *degrees in rotationPath) {
-                    NSImage *rotatedImage = [_uninstallIcon imageRotatedByDegrees:[degrees floatValue]];
-                    CGImageSourceRef imageSource = CGImageSourceCreateWithData((CFDataRef)[rotatedImage TIFFRepresentation], NULL);
+                    id frameImage = [renderedFrames objectForKey:degrees];
                     
-                    if (imageSource) {
-                        CGImageRef imageRef = CGImageSourceCreateImageAtIndex(imageSource, 0, NULL);
-                        CGImageDestinationAddImage(imageDestination, imageRef, (__bridge CFDictionaryRef)frameProperties);
-                        CGImageRelease(imageRef);
-                        CFRelease(imageSource);
+                    if (!frameImage) {
+                        MTTraceTimestamp frameBegin = MTTraceBegin();
+                        CGContextRef context = [_uninstallIcon createBitmapContextWithPixelSize:pixelSize
+                                                                                         format:MTRenderArenaBitmapFormatRGBA
+                                                                               rotatedByDegrees:[degrees floatValue]
+                                                                                     sourceRect:sourceRect
+                        ];
+                        
+                        if (context) {
+                            frameImage = CFBridgingRelease(MTRenderArenaCreateImage(context));
+                            if (frameImage) { [renderedFrames setObject:frameImage forKey:degrees]; }
+                            
+                            CGContextRelease(context);
+                        }
+                        
+                        MTTraceEnd("render animation frame", frameBegin);
+                    }
+                    
+                    if (frameImage) {
+                        CGImageDestinationAddImage(imageDestination, (__bridge CGImageRef)frameImage, (__bridge CFDictionaryRef)frameProperties);
                     }
                 }
                 
+                MTTraceTimestamp finalizeBegin = MTTraceBegin();
+                
                 if  (CGImageDestinationFinalize(imageDestination)) {
                     imageData = (__bridge NSData *)(data);
                 }
                 
+                MTTraceEnd("CGImageDestinationFinalize", finalizeBegin);
+                
                 CFRelease(imageDestination);
+                [renderedFrames removeAllObjects];
+                MTRenderArenaRestoreMark(arena, arenaMark);
             }
             
             CFRelease(data);
         }
     }
 
+    MTTraceEnd("uninstallAPNG", traceBegin);
+    
     if (completionHandler) { completionHandler(imageData); }
 }
 
+- (NSData*)installIconData
+{
+    if (!_installIconPNGData && [_installIcon isValid]) { _installIconPNGData = [_installIcon pngData]; }
+    return _installIconPNGData;
+}
+
+- (NSData*)uninstallIconData
+{
+    if (!_uninstallIconPNGData && [_uninstallIcon isValid]) { _uninstallIconPNGData = [_uninstallIcon pngData]; }
+    return _uninstallIconPNGData;
+}
+
+- (NSData*)animatedUninstallIconData
+{
+    if (!_animatedUninstallIconPNGData) {
+        
+        [self uninstallAPNGWithCompletionHandler:^(NSData *imageData) {
+            self->_animatedUninstallIconPNGData = imageData;
+        }];
+    }
+    
+    return _animatedUninstallIconPNGData;
+}
+
 + (NSString*)createFolderAtPath:(NSString*)path
                      folderName:(NSString*)folderName
                 appendTimestamp:(BOOL)timestamp
@@ -125,14 +245,72 @@
     return folderPath;
 }
 
+- (NSDictionary*)filesWithAnimatedOnly:(BOOL)animatedOnly
+{
+    NSMutableDictionary *files = [NSMutableDictionary dictionary];
+    BOOL success = YES;
+    
+    // the install image
+    if ([_installIcon isValid]) {
+        
+        NSData *imageData = [self installIconData];
+        NSString *fileName = (_fileNamePrefix) ? [_fileNamePrefix stringByAppendingFormat:@"_%@", kMTFileNameInstall] : kMTFileNameInstall;
+        
+        if (imageData) {
+            [files setObject:imageData forKey:fileName];
+        } else {
+            success = NO;
+        }
+    }
+    
+    // the uninstall image
+    if (success && [_uninstallIcon isValid]) {
+        
+        if (!animatedOnly) {
+            
+            NSData *imageData = [self uninstallIconData];
+            NSString *fileName = (_fileNamePrefix) ? [_fileNamePrefix stringByAppendingFormat:@"_%@", kMTFileNameUninstall] : kMTFileNameUninstall;
+            
+            if (imageData) {
+                [files setObject:imageData forKey:fileName];
+            } else {
+                success = NO;
+            }
+        }
+        
+        if (success && _animationDuration > 0) {
+            
+            // the animated uninstall image
+            NSData *imageData = [self animatedUninstallIconData];
+            NSString *fileName = (_fileNamePrefix) ? [_fileNamePrefix stringByAppendingFormat:@"_%@", kMTFileNameUninstallAnimated] : kMTFileNameUninstallAnimated;
+            
+            if (imageData) {
+                [files setObject:imageData forKey:fileName];
+            } else {
+                success = NO;
+            }
+        }
+    }
+    
+    return (success) ? files : nil;
+}
+
 - (void)writeToFolder:(NSString *)path
          createFolder:(BOOL)createFolder
          animatedOnly:(BOOL)animatedOnly
     completionHandler:(void (^) (BOOL success, NSString* path, NSError *error))completionHandler
 {
     __block BOOL success = YES;
+    __block NSError *error = nil;
     NSString *folderPath = path;
-    NSError *error = nil;
+    
+    // once the icon set has been written, the scratch memory
+    // of the render arena can be reused for the next icon set
+    void (^finishHandler)(BOOL, NSString*, NSError*) = ^(BOOL writeSuccess, NSString *writePath, NSError *writeError) {
+        
+        MTRenderArenaReset(MTRenderArenaGetCurrent());
+        if (completionHandler) { completionHandler(writeSuccess, writePath, writeError); }
+    };
         
     if (createFolder) {
         
@@ -143,53 +321,33 @@
         if (!folderPath) { success = NO; }
     }
     
-    if (success) {
-        
-        // save the install image
-        if ([_installIcon isValid]) {
-            
-            NSString *fileName = (_fileNamePrefix) ? [_fileNamePrefix stringByAppendingFormat:@"_%@", kMTFileNameInstall] : kMTFileNameInstall;
-            success = [[_installIcon pngData] writeToURL:[NSURL fileURLWithPath:[folderPath stringByAppendingPathComponent:fileName]]
-                                                 options:NSDataWritingAtomic
-                                                   error:&error
-            ];
-        }
+    NSDictionary *files = (success) ? [self filesWithAnimatedOnly:animatedOnly] : nil;
+    
+    if (files) {
         
-        // save the uninstall image
-        if (success && [_uninstallIcon isValid]) {
+        // write all images of the set at once, so we
+        // never end up with an incomplete icon set
+        if ([files count] > 0) {
             
-            if (!animatedOnly) {
-                
-                NSString *fileName = (_fileNamePrefix) ? [_fileNamePrefix stringByAppendingFormat:@"_%@", kMTFileNameUninstall] : kMTFileNameUninstall;
-                success = [[_uninstallIcon pngData] writeToURL:[NSURL fileURLWithPath:[folderPath stringByAppendingPathComponent:fileName]]
-                                                       options:NSDataWritingAtomic
-                                                         error:&error
-                           ];
-            }
+            MTTraceTimestamp traceBegin = MTTraceBegin();
+            MTBatchWriter *batchWriter = [[MTBatchWriter alloc] initWithFolderPath:folderPath batchSize:0];
             
-            if (success && _animationDuration > 0) {
+            [batchWriter addFiles:files completionHandler:^(BOOL writeSuccess, NSError *writeError) {
                 
-                // save the animated uninstall image
-                [self uninstallAPNGWithCompletionHandler:^(NSData *imageData) {
-                    
-                    NSError *error = nil;
-                    NSString *fileName = (self->_fileNamePrefix) ? [self->_fileNamePrefix stringByAppendingFormat:@"_%@", kMTFileNameUninstallAnimated] : kMTFileNameUninstallAnimated;
-                    success = [imageData writeToURL:[NSURL fileURLWithPath:[folderPath stringByAppendingPathComponent:fileName]]
-                                            options:NSDataWritingAtomic
-                                            error:&error
-                     ];
-                
-                    if (completionHandler) { completionHandler(success, folderPath, error); }
-                }];
-                
-            } else if (completionHandler) { completionHandler(success, folderPath, error); }
+                success = writeSuccess;
+                error = writeError;
+            }];
             
-        } else if (completionHandler) { completionHandler(success, folderPath, error); }
+            [batchWriter flush];
+            MTTraceEnd("write icon set", traceBegin);
+        }
+        
+        finishHandler(success, folderPath, error);
         
-    } else if (completionHandler) {
+    } else {
         
         error = [NSError errorWithDomain:NSOSStatusErrorDomain code:writErr userInfo:nil];
-        completionHandler(success, folderPath, error); }
+        finishHandler(NO, folderPath, error); }
 }
 
 + (NSString *)fileNamePrefixWithString:(NSString *)prefix
@@ -32,7 +32,7 @@
  @abstract      Specifies whether or not to use the icon shape from before macOS 26.
  @discussion    The value of this property is boolean.
  */
-@property (assign) BOOL usesOldIconShape;
+@property (nonatomic, assign) BOOL usesOldIconShape;
 
 /*!
  @property      boundingRect
@@ -48,6 +48,34 @@
  */
 @property (assign, readonly) CGFloat cornerRadius;
 
+/*!
+ @method        boundingRectWithBounds:
+ @abstract      Returns the bounding rect of the icon shape for a view with the given bounds.
+ @param         bounds The bounds of the view.
+ @discussion    Use this method to get the icon shape without creating an MTIconView instance.
+*/
++ (NSRect)boundingRectWithBounds:(NSRect)bounds;
+
+/*!
+ @method        cornerRadiusWithBounds:usesOldIconShape:
+ @abstract      Returns the corner radius of the icon shape for a view with the given bounds.
+ @param         bounds The bounds of the view.
+ @param         oldShape A boolean specifying whether to use the icon shape from before macOS 26.
+*/
++ (CGFloat)cornerRadiusWithBounds:(NSRect)bounds usesOldIconShape:(BOOL)oldShape;
+
+/*!
+ @method        imageHasIconShape:
+ @abstract      Returns whether the given image already has the shape of an icon.
+ @param         image The image to check.
+ @discussion    The image's alpha channel is sampled at a low resolution and compared with the current and the
+                old icon shape. Returns YES if the image is opaque inside and transparent (or covered by a
+                shadow only) outside one of the shapes, so the image does not have to be drawn into the icon
+                shape again. A small band around the shape's outline is not checked, so the image's shape does
+                not have to match ours exactly (e.g. continuous corners or a slightly different size).
+*/
++ (BOOL)imageHasIconShape:(NSImage*)image;
+
 /*!
  @method        init:
  @discussion    The init method is not available. Please use initWithFrame: instead.
@@ -17,11 +17,19 @@
 
 #import "MTIconView.h"
 #import "Constants.h"
+#import "MTImage.h"
+#import "MTTrace.h"
 #import <QuartzCore/CAShapeLayer.h>
 
 @interface MTIconView ()
 @property (assign) NSRect boundingRect;
 @property (assign) CGFloat cornerRadius;
+@property (nonatomic, strong, readwrite) CALayer *containerLayer;
+@property (nonatomic, strong, readwrite) CALayer *imageLayer;
+@property (nonatomic, strong, readwrite) CAShapeLayer *maskLayer;
+@property (assign) NSSize layerSize;
+@property (assign) BOOL shapeNeedsUpdate;
+@property (assign) BOOL imageNeedsUpdate;
 @end
 
 @implementation MTIconView
@@ -34,56 +42,206 @@
         
         [self setWantsLayer:YES];
         [self updateBoundsWithRect:[self bounds]];
+        
+        _shapeNeedsUpdate = YES;
+        _imageNeedsUpdate = YES;
     }
     
     return self;
 }
 
-- (void)updateBoundsWithRect:(NSRect)bounds
++ (NSRect)boundingRectWithBounds:(NSRect)bounds
 {
-    _boundingRect = NSInsetRect(
-                                bounds,
-                                NSWidth(bounds) * .097,
-                                NSHeight(bounds) * .099
-                                );
-    
-    _cornerRadius = (_usesOldIconShape) ? NSWidth(bounds) * .18 : NSWidth(bounds) * .205;
+    return NSInsetRect(
+                       bounds,
+                       NSWidth(bounds) * .097,
+                       NSHeight(bounds) * .099
+                       );
 }
 
-- (void)updateLayers
++ (CGFloat)cornerRadiusWithBounds:(NSRect)bounds usesOldIconShape:(BOOL)oldShape
 {
-    [[[self layer] sublayers] makeObjectsPerformSelector:@selector(removeFromSuperlayer)];
-
-    NSRect bounds = [self bounds];
-    [self updateBoundsWithRect:bounds];
+    return (oldShape) ? NSWidth(bounds) * .18 : NSWidth(bounds) * .205;
+}
 
-    // draw the icon shape
-    CALayer *containerLayer = [[CALayer alloc] init];
-    [containerLayer setFrame:_boundingRect];
-    [containerLayer setBackgroundColor:[NSColor whiteColor].CGColor];
-    [containerLayer setCornerRadius:_cornerRadius];
+// returns the signed distance of the given point from the outline of the
+// given rounded rect (negative inside, positive outside)
+static CGFloat roundedRectDistance(NSPoint point, NSRect rect, CGFloat cornerRadius)
+{
+    CGFloat qx = fabs(point.x - NSMidX(rect)) - (NSWidth(rect) / 2.0 - cornerRadius);
+    CGFloat qy = fabs(point.y - NSMidY(rect)) - (NSHeight(rect) / 2.0 - cornerRadius);
     
-    // draw the icon's drop shadow
-    [containerLayer setShadowColor:[NSColor blackColor].CGColor];
-    [containerLayer setShadowOffset:CGSizeMake(0, -(NSWidth(bounds) * .0095))];
-    [containerLayer setShadowRadius:NSWidth(bounds) * .013];
-    [containerLayer setShadowOpacity:.3];
+    return hypot(fmax(qx, 0), fmax(qy, 0)) + fmin(fmax(qx, qy), 0) - cornerRadius;
+}
 
-    [[self layer] addSublayer:containerLayer];
++ (BOOL)imageHasIconShape:(NSImage*)image
+{
+    BOOL hasIconShape = NO;
+    MTTraceTimestamp traceBegin = MTTraceBegin();
+    NSSize pixelSize = [image pixelSize];
+    BOOL hasAlphaChannel = [image hasAlphaChannel];
+    
+    // icons are square and have transparent corners, so we
+    // don't have to look at anything else
+    if ([image isValid] && hasAlphaChannel && fabs(pixelSize.width - pixelSize.height) <= 1) {
+        
+        MTRenderArenaRef arena = MTRenderArenaGetCurrent();
+        MTRenderArenaMark arenaMark = MTRenderArenaGetMark(arena);
+        
+        // a few thousand samples are enough to tell an icon
+        // from anything else, so we don't need the full image
+        size_t sampleSize = 64;
+        CGContextRef context = [image createBitmapContextWithPixelSize:NSMakeSize(sampleSize, sampleSize)
+                                                                format:MTRenderArenaBitmapFormatAlphaOnly
+                                                      rotatedByDegrees:0
+        ];
+        
+        if (context) {
+            
+            size_t bytesPerRow = CGBitmapContextGetBytesPerRow(context);
+            const UInt8 *alpha = CGBitmapContextGetData(context);
+            NSRect bounds = NSMakeRect(0, 0, sampleSize, sampleSize);
+            NSRect boundingRect = [MTIconView boundingRectWithBounds:bounds];
+            
+            // anti-aliasing, continuous corners and slightly different
+            // sizes only affect the pixels close to the outline
+            CGFloat tolerance = sampleSize * .03;
+            
+            for (int oldShape = 0; oldShape <= 1 && !hasIconShape; oldShape++) {
+                
+                CGFloat cornerRadius = [MTIconView cornerRadiusWithBounds:bounds usesOldIconShape:oldShape];
+                NSUInteger samples = 0;
+                NSUInteger mismatches = 0;
+                
+                for (size_t y = 0; y < sampleSize; y++) {
+                    for (size_t x = 0; x < sampleSize; x++) {
+                        
+                        CGFloat distance = roundedRectDistance(NSMakePoint(x + .5, y + .5), boundingRect, cornerRadius);
+                        
+                        if (fabs(distance) > tolerance) {
+                            
+                            // the inside must be opaque, the outside may
+                            // contain the icon's drop shadow
+                            UInt8 value = alpha[(y * bytesPerRow) + x];
+                            if ((distance < 0) ? value < 230 : value >= 128) { mismatches++; }
+                            samples++;
+                        }
+                    }
+                }
+                
+                hasIconShape = (samples > 0 && mismatches <= samples / 100);
+            }
+            
+            CGContextRelease(context);
+        }
+        
+        MTRenderArenaRestoreMark(arena, arenaMark);
+    }
+    
+    // opaque images get their own stage, so --stats shows both paths
+    MTTraceEnd((hasAlphaChannel) ? "detect icon shape" : "detect icon shape (opaque)", traceBegin);
+    
+    return hasIconShape;
+}
 
-    // draw the image
-    if ([_image isValid]) {
+- (void)updateBoundsWithRect:(NSRect)bounds
+{
+    _boundingRect = [MTIconView boundingRectWithBounds:bounds];
+    _cornerRadius = [MTIconView cornerRadiusWithBounds:bounds usesOldIconShape:_usesOldIconShape];
+}
 
-        CGImageRef cgImage = [_image CGImageForProposedRect:NULL context:nil hints:nil];
+- (void)setImage:(NSImage *)image
+{
+    if (image != _image) {
+        
+        _image = image;
+        _imageNeedsUpdate = YES;
+        [self setNeedsLayout:YES];
+    }
+}
 
-        CALayer *imageLayer = [[CALayer alloc] init];
-        [imageLayer setFrame:[containerLayer bounds]];
-        [imageLayer setContents:(__bridge id)cgImage];
-        [imageLayer setContentsGravity:kCAGravityResizeAspectFill];
+- (void)setUsesOldIconShape:(BOOL)usesOldIconShape
+{
+    if (usesOldIconShape != _usesOldIconShape) {
+        
+        _usesOldIconShape = usesOldIconShape;
+        [self updateBoundsWithRect:[self bounds]];
+        
+        _shapeNeedsUpdate = YES;
+        [self setNeedsLayout:YES];
+    }
+}
 
-        NSRect imageLayerBounds = [imageLayer bounds];
-        CAShapeLayer *maskLayer = [[CAShapeLayer alloc] init];
-        [maskLayer setFrame:imageLayerBounds];
+- (void)updateLayers
+{
+    NSRect bounds = [self bounds];
+    
+    // the layers are only rebuilt if the icon shape or the image
+    // have changed. Otherwise we keep the existing layers.
+    if (!NSEqualSizes(bounds.size, _layerSize)) { _shapeNeedsUpdate = YES; }
+    if (!_shapeNeedsUpdate && !_imageNeedsUpdate) { return; }
+    
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    
+    if (!_containerLayer) {
+        
+        // draw the icon shape
+        _containerLayer = [[CALayer alloc] init];
+        [_containerLayer setBackgroundColor:[NSColor whiteColor].CGColor];
+        
+        // draw the icon's drop shadow
+        [_containerLayer setShadowColor:[NSColor blackColor].CGColor];
+        [_containerLayer setShadowOpacity:.3];
+        
+        [[self layer] addSublayer:_containerLayer];
+    }
+    
+    if (_shapeNeedsUpdate) {
+        
+        [self updateBoundsWithRect:bounds];
+        _layerSize = bounds.size;
+        
+        [_containerLayer setFrame:_boundingRect];
+        [_containerLayer setCornerRadius:_cornerRadius];
+        [_containerLayer setShadowOffset:CGSizeMake(0, -(NSWidth(bounds) * .0095))];
+        [_containerLayer setShadowRadius:NSWidth(bounds) * .013];
+    }
+    
+    if (_imageNeedsUpdate) {
+        
+        if ([_image isValid]) {
+            
+            if (!_imageLayer) {
+                
+                _imageLayer = [[CALayer alloc] init];
+                [_imageLayer setContentsGravity:kCAGravityResizeAspectFill];
+                
+                _maskLayer = [[CAShapeLayer alloc] init];
+                [_imageLayer setMask:_maskLayer];
+                
+                [_containerLayer addSublayer:_imageLayer];
+                _shapeNeedsUpdate = YES;
+            }
+            
+            CGImageRef cgImage = [_image CGImageForProposedRect:NULL context:nil hints:nil];
+            [_imageLayer setContents:(__bridge id)cgImage];
+            
+        } else {
+            
+            [_imageLayer removeFromSuperlayer];
+            _imageLayer = nil;
+            _maskLayer = nil;
+        }
+    }
+    
+    // draw the image into the icon shape
+    if (_shapeNeedsUpdate && _imageLayer) {
+        
+        [_imageLayer setFrame:[_containerLayer bounds]];
+        
+        NSRect imageLayerBounds = [_imageLayer bounds];
+        [_maskLayer setFrame:imageLayerBounds];
         
         CGPathRef roundedPath = CGPathCreateWithRoundedRect(
                                                             imageLayerBounds,
@@ -91,13 +249,14 @@
                                                             _cornerRadius,
                                                             NULL
                                                             );
-        [maskLayer setPath:roundedPath];
+        [_maskLayer setPath:roundedPath];
         CGPathRelease(roundedPath);
-
-        [imageLayer setMask:maskLayer];
-
-        [containerLayer addSublayer:imageLayer];
     }
+    
+    [CATransaction commit];
+    
+    _shapeNeedsUpdate = NO;
+    _imageNeedsUpdate = NO;
 }
 
 - (void)layout
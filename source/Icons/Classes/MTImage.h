@@ -16,6 +16,7 @@
 */
 
 #import <Cocoa/Cocoa.h>
+#import "MTRenderArena.h"
 
 /*!
  @abstract This class extends the NSImage class and provides methods for scaling and rotating images.
@@ -40,6 +41,17 @@
  */
 - (NSImage*)imageScaledToSize:(CGSize)targetSize maintainAspectRatio:(BOOL)aspectRatio;
 
+/*!
+ @method        imageByScalingToFitPixelSize:
+ @abstract      Scale the image down once, so it fits into the given pixel size (maintaining the aspect ratio).
+ @param         pixelSize The maximum size of the image in pixels.
+ @discussion    Returns a new bitmap-backed image that has been resampled with high quality interpolation, or
+                the image itself if it already fits into the given size. Returns nil if an error occurred.
+                Use this method to avoid that every view and every animation frame has to resample the full
+                resolution source image again.
+ */
+- (NSImage*)imageByScalingToFitPixelSize:(NSSize)pixelSize;
+
 /*!
  @method        canBeScaledToSize:
  @abstract      Check if the image can be scaled to the given size (without upscaling).
@@ -48,10 +60,71 @@
  */
 - (BOOL)canBeScaledToSize:(NSSize)scaleSize;
 
+/*!
+ @method        pixelSize
+ @abstract      Get the size of the image in pixels.
+ @discussion    Returns the pixel size of the image's largest bitmap representation. If the image has no bitmap
+                representation (e.g. a vector or custom drawn image), the image's size is returned.
+ */
+- (NSSize)pixelSize;
+
+/*!
+ @method        hasAlphaChannel
+ @abstract      Get whether the image may contain transparent pixels.
+ @discussion    Returns NO if all of the image's representations are bitmaps without an alpha channel (e.g.
+                JPEG files or opaque PNG files), otherwise returns YES. The pixels of the image are not read, so
+                use this method to choose the faster paths for opaque images before analyzing the image.
+ */
+- (BOOL)hasAlphaChannel;
+
+/*!
+ @method        createBitmapContextWithPixelSize:format:rotatedByDegrees:
+ @abstract      Draw the image into a bitmap context allocated from the render arena of the current thread.
+ @param         pixelSize The size of the bitmap in pixels.
+ @param         format The pixel format of the bitmap.
+ @param         degrees A float defining the angle the image should be rotated by (around its center).
+ @discussion    Returns a bitmap context containing the image or NULL if an error occurred. The caller is
+                responsible for releasing the context. The context is only valid until the render arena is
+                restored to an earlier mark or reset.
+ */
+- (CGContextRef)createBitmapContextWithPixelSize:(NSSize)pixelSize
+                                          format:(MTRenderArenaBitmapFormat)format
+                                rotatedByDegrees:(CGFloat)degrees CF_RETURNS_RETAINED;
+
+/*!
+ @method        createBitmapContextWithPixelSize:format:rotatedByDegrees:sourceRect:
+ @abstract      Draw a part of the image into a bitmap context allocated from the render arena of the current thread.
+ @param         pixelSize The size of the bitmap in pixels.
+ @param         format The pixel format of the bitmap.
+ @param         degrees A float defining the angle the image should be rotated by (around its center).
+ @param         sourceRect The part of the image that should be drawn, in pixels of the bitmap. The rest of the
+                bitmap stays transparent.
+ @discussion    Returns a bitmap context containing the part of the image or NULL if an error occurred. The part
+                is drawn exactly as if the whole image had been drawn, so pass the image's opaque rect to skip
+                the transparent parts of the image. The caller is responsible for releasing the context. The
+                context is only valid until the render arena is restored to an earlier mark or reset.
+ */
+- (CGContextRef)createBitmapContextWithPixelSize:(NSSize)pixelSize
+                                          format:(MTRenderArenaBitmapFormat)format
+                                rotatedByDegrees:(CGFloat)degrees
+                                      sourceRect:(NSRect)sourceRect CF_RETURNS_RETAINED;
+
+/*!
+ @method        opaqueRectWithPixelSize:
+ @abstract      Get the part of the image that is not fully transparent.
+ @param         pixelSize The size of the bitmap the image is drawn into.
+ @discussion    Returns the smallest rect (in pixels of the bitmap, with the origin in the lower left corner)
+                containing the spans of non-transparent pixels of all rows, or NSZeroRect if the image is fully
+                transparent. The image's alpha channel is drawn into the render arena and every row is only
+                scanned from both ends up to its first non-transparent pixel.
+ */
+- (NSRect)opaqueRectWithPixelSize:(NSSize)pixelSize;
+
 /*!
  @method        pngData
  @abstract      Get the PNG data of the image, so it could e.g. be written into a file.
- @discussion    Returns the PNG data of the image or nil if an error occurred.
+ @discussion    Returns the PNG data of the image or nil if an error occurred. The PNG data keeps the RGB color
+                space of the image's bitmap (e.g. Display P3), other images are encoded in sRGB.
  */
 - (NSData*)pngData;
 
@@ -64,6 +137,15 @@
  */
 + (NSImage*)imageWithFileAtURL:(NSURL*)url;
 
+/*!
+ @method        imageWithFileData:
+ @abstract      Get a NSImage object from the given file contents.
+ @param         data The contents of an image file, an .icns file or a flat installer package.
+ @discussion    Returns an NSImage object or nil if the format is not supported or an error occurred. As there is no
+                file name, the format is determined by the magic bytes at the beginning of the data.
+ */
++ (NSImage*)imageWithFileData:(NSData*)data;
+
 /*!
  @method        imageWithView:size
  @abstract      Get a NSImage object of the view with the given size.
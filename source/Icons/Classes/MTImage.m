@@ -16,7 +16,11 @@
 */
 
 #import "MTImage.h"
+#import "MTTrace.h"
+#import "MTIconFile.h"
+#import "MTPackage.h"
 #import <UniformTypeIdentifiers/UTCoreTypes.h>
+#import <ImageIO/ImageIO.h>
 
 @implementation NSImage (MTImage)
 
@@ -52,8 +56,7 @@
     
     if ([self isValid]) {
         
-        NSBitmapImageRep *imageRep = [[NSBitmapImageRep alloc] initWithData:[self TIFFRepresentation]];
-        NSSize imageSize = NSMakeSize([imageRep pixelsWide], [imageRep pixelsHigh]);
+        NSSize imageSize = [self pixelSize];
         
         if (!CGSizeEqualToSize(imageSize, targetSize)) {
             
@@ -101,14 +104,83 @@
     return scaledImage;
 }
 
+- (NSImage*)imageByScalingToFitPixelSize:(NSSize)pixelSize
+{
+    NSImage *scaledImage = nil;
+    
+    if ([self isValid] && pixelSize.width > 0 && pixelSize.height > 0) {
+        
+        NSSize imageSize = [self pixelSize];
+        
+        if (imageSize.width > pixelSize.width || imageSize.height > pixelSize.height) {
+            
+            MTTraceTimestamp traceBegin = MTTraceBegin();
+            
+            CGFloat scaleFactor = fmin(pixelSize.width / imageSize.width, pixelSize.height / imageSize.height);
+            size_t scaledWidth = (size_t)fmax(1, round(imageSize.width * scaleFactor));
+            size_t scaledHeight = (size_t)fmax(1, round(imageSize.height * scaleFactor));
+            
+            // the scaled image outlives the current render job, so its
+            // pixels must not be allocated from the render arena. It keeps
+            // the color space of the source's pixels (if it is an RGB color
+            // space), so wide gamut colors are not clipped to sRGB
+            NSColorSpace *bitmapColorSpace = [self bitmapColorSpace];
+            CGColorSpaceRef sourceColorSpace = [bitmapColorSpace CGColorSpace];
+            CGColorSpaceRef colorSpace = (sourceColorSpace && CGColorSpaceGetModel(sourceColorSpace) == kCGColorSpaceModelRGB) ? CGColorSpaceRetain(sourceColorSpace) : CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+            CGContextRef context = CGBitmapContextCreate(
+                                                         NULL,
+                                                         scaledWidth,
+                                                         scaledHeight,
+                                                         8,
+                                                         0,
+                                                         colorSpace,
+                                                         (CGBitmapInfo)kCGImageAlphaPremultipliedLast
+                                                         );
+            CGColorSpaceRelease(colorSpace);
+            
+            if (context) {
+                
+                CGContextSetInterpolationQuality(context, kCGInterpolationHigh);
+                
+                [NSGraphicsContext saveGraphicsState];
+                [NSGraphicsContext setCurrentContext:[NSGraphicsContext graphicsContextWithCGContext:context flipped:NO]];
+                
+                [self drawInRect:NSMakeRect(0, 0, scaledWidth, scaledHeight)
+                        fromRect:NSZeroRect
+                       operation:NSCompositingOperationCopy
+                        fraction:1.0];
+                
+                [NSGraphicsContext restoreGraphicsState];
+                
+                CGImageRef imageRef = CGBitmapContextCreateImage(context);
+                
+                if (imageRef) {
+                    
+                    scaledImage = [[NSImage alloc] initWithCGImage:imageRef size:NSMakeSize(scaledWidth, scaledHeight)];
+                    CGImageRelease(imageRef);
+                }
+                
+                CGContextRelease(context);
+            }
+            
+            MTTraceEnd("prescale source", traceBegin);
+            
+        } else {
+            scaledImage = self;
+        }
+    }
+    
+    return scaledImage;
+}
+
 - (BOOL)canBeScaledToSize:(NSSize)scaleSize
 {
     BOOL canBeScaled = NO;
         
     if ([self isValid]) {
     
-        NSBitmapImageRep *imageRep = [[NSBitmapImageRep alloc] initWithData:[self TIFFRepresentation]];
-        NSRect sourceImageFrame = NSMakeRect(0, 0, [imageRep pixelsWide], [imageRep pixelsHigh]);
+        NSSize imageSize = [self pixelSize];
+        NSRect sourceImageFrame = NSMakeRect(0, 0, imageSize.width, imageSize.height);
         NSRect targetImageFrame = NSMakeRect(0, 0, scaleSize.width, scaleSize.height);
         
         canBeScaled = NSContainsRect(sourceImageFrame, targetImageFrame);
@@ -117,25 +189,257 @@
     return canBeScaled;
 }
 
+- (NSSize)pixelSize
+{
+    NSSize pixelSize = NSZeroSize;
+    
+    for (NSImageRep *imageRep in [self representations]) {
+        
+        // vector and custom drawn representations
+        // return NSImageRepMatchesDevice here
+        NSInteger pixelsWide = [imageRep pixelsWide];
+        NSInteger pixelsHigh = [imageRep pixelsHigh];
+        
+        if (pixelsWide * pixelsHigh > pixelSize.width * pixelSize.height) {
+            pixelSize = NSMakeSize(pixelsWide, pixelsHigh);
+        }
+    }
+    
+    if (NSEqualSizes(pixelSize, NSZeroSize)) { pixelSize = [self size]; }
+    
+    return pixelSize;
+}
+
+- (BOOL)hasAlphaChannel
+{
+    BOOL hasAlphaChannel = ([[self representations] count] == 0);
+    
+    for (NSImageRep *imageRep in [self representations]) {
+        
+        // vector and custom drawn representations may
+        // always draw transparent pixels
+        if ([imageRep hasAlpha] || [imageRep pixelsWide] == NSImageRepMatchesDevice) {
+            
+            hasAlphaChannel = YES;
+            break;
+        }
+    }
+    
+    return hasAlphaChannel;
+}
+
+- (CGContextRef)createBitmapContextWithPixelSize:(NSSize)pixelSize
+                                          format:(MTRenderArenaBitmapFormat)format
+                                rotatedByDegrees:(CGFloat)degrees
+{
+    return [self createBitmapContextWithPixelSize:pixelSize
+                                           format:format
+                                 rotatedByDegrees:degrees
+                                       sourceRect:NSMakeRect(0, 0, round(pixelSize.width), round(pixelSize.height))
+    ];
+}
+
+- (NSColorSpace*)bitmapColorSpace
+{
+    NSColorSpace *colorSpace = nil;
+    
+    for (NSImageRep *imageRep in [self representations]) {
+        
+        if ([imageRep isKindOfClass:[NSBitmapImageRep class]]) {
+            
+            colorSpace = [(NSBitmapImageRep*)imageRep colorSpace];
+            break;
+        }
+    }
+    
+    return colorSpace;
+}
+
+- (CGContextRef)createBitmapContextWithPixelSize:(NSSize)pixelSize
+                                          format:(MTRenderArenaBitmapFormat)format
+                                rotatedByDegrees:(CGFloat)degrees
+                                      sourceRect:(NSRect)sourceRect
+{
+    // the bitmap gets the color space of the image's pixels (if any), so
+    // drawing the image does not convert (and clip) wide gamut colors
+    NSColorSpace *colorSpace = [self bitmapColorSpace];
+    
+    CGContextRef context = MTRenderArenaCreateBitmapContext(
+                                                            MTRenderArenaGetCurrent(),
+                                                            (size_t)round(pixelSize.width),
+                                                            (size_t)round(pixelSize.height),
+                                                            format,
+                                                            [colorSpace CGColorSpace]
+                                                            );
+    
+    if (context) {
+        
+        NSRect imageRect = NSMakeRect(0, 0, CGBitmapContextGetWidth(context), CGBitmapContextGetHeight(context));
+        NSRect drawRect = NSIntersectionRect(sourceRect, imageRect);
+        
+        // the bitmap is cleared, so there's nothing
+        // to draw if the part of the image is empty
+        if (!NSIsEmptyRect(drawRect)) {
+            
+            if (degrees != 0) {
+                
+                // rotate from center
+                CGContextTranslateCTM(context, NSMidX(imageRect), NSMidY(imageRect));
+                CGContextRotateCTM(context, degrees * M_PI / 180.0);
+                CGContextTranslateCTM(context, -NSMidX(imageRect), -NSMidY(imageRect));
+            }
+            
+            [NSGraphicsContext saveGraphicsState];
+            [NSGraphicsContext setCurrentContext:[NSGraphicsContext graphicsContextWithCGContext:context flipped:NO]];
+            
+            // map the part of the bitmap to the same part of the image
+            NSSize imageSize = [self size];
+            CGFloat scaleX = imageSize.width / NSWidth(imageRect);
+            CGFloat scaleY = imageSize.height / NSHeight(imageRect);
+            NSRect fromRect = (NSEqualRects(drawRect, imageRect)) ? NSZeroRect : NSMakeRect(
+                                                                                             NSMinX(drawRect) * scaleX,
+                                                                                             NSMinY(drawRect) * scaleY,
+                                                                                             NSWidth(drawRect) * scaleX,
+                                                                                             NSHeight(drawRect) * scaleY
+                                                                                             );
+            
+            [self drawInRect:drawRect
+                    fromRect:fromRect
+                   operation:NSCompositingOperationCopy
+                    fraction:1.0];
+            
+            [NSGraphicsContext restoreGraphicsState];
+        }
+    }
+    
+    return context;
+}
+
+- (NSRect)opaqueRectWithPixelSize:(NSSize)pixelSize
+{
+    // an image without alpha channel covers the whole bitmap
+    if (![self hasAlphaChannel]) { return NSMakeRect(0, 0, round(pixelSize.width), round(pixelSize.height)); }
+    
+    NSRect opaqueRect = NSZeroRect;
+    MTTraceTimestamp traceBegin = MTTraceBegin();
+    
+    MTRenderArenaRef arena = MTRenderArenaGetCurrent();
+    MTRenderArenaMark arenaMark = MTRenderArenaGetMark(arena);
+    
+    CGContextRef context = [self createBitmapContextWithPixelSize:pixelSize
+                                                           format:MTRenderArenaBitmapFormatAlphaOnly
+                                                 rotatedByDegrees:0
+    ];
+    
+    if (context) {
+        
+        size_t width = CGBitmapContextGetWidth(context);
+        size_t height = CGBitmapContextGetHeight(context);
+        size_t bytesPerRow = CGBitmapContextGetBytesPerRow(context);
+        const UInt8 *alpha = CGBitmapContextGetData(context);
+        
+        size_t minX = width, maxX = 0, minRow = height, maxRow = 0;
+        
+        for (size_t y = 0; y < height; y++) {
+            
+            // find the span of non-transparent pixels of this row by scanning
+            // it from both ends, so the pixels in between are never read
+            const UInt8 *row = alpha + (y * bytesPerRow);
+            size_t left = 0;
+            while (left < width && !row[left]) { left++; }
+            
+            if (left < width) {
+                
+                size_t right = width - 1;
+                while (!row[right]) { right--; }
+                
+                if (left < minX) { minX = left; }
+                if (right > maxX) { maxX = right; }
+                if (y < minRow) { minRow = y; }
+                maxRow = y;
+            }
+        }
+        
+        // the first row of the bitmap is the top of the image
+        if (minX <= maxX && minRow <= maxRow) {
+            opaqueRect = NSMakeRect(minX, height - (maxRow + 1), maxX - minX + 1, maxRow - minRow + 1);
+        }
+        
+        CGContextRelease(context);
+    }
+    
+    MTRenderArenaRestoreMark(arena, arenaMark);
+    MTTraceEnd("opaqueRect", traceBegin);
+    
+    return opaqueRect;
+}
+
 - (NSData*)pngData
 {
     NSData *imageData = nil;
+    MTTraceTimestamp traceBegin = MTTraceBegin();
     
-    NSBitmapImageRep *bitmapData = [[NSBitmapImageRep alloc] initWithData:[self TIFFRepresentation]];
-    NSDictionary *imageProps = [NSDictionary dictionaryWithObject:[NSNumber numberWithFloat:1.0]
-                                                           forKey:NSImageCompressionFactor
-    ];
+    // the pixels are rendered into scratch memory of the render arena
+    // and handed to the encoder without going through a TIFF blob
+    MTRenderArenaRef arena = MTRenderArenaGetCurrent();
+    MTRenderArenaMark arenaMark = MTRenderArenaGetMark(arena);
     
-    imageData = [bitmapData representationUsingType:NSBitmapImageFileTypePNG
-                                         properties:imageProps
+    CGContextRef context = [self createBitmapContextWithPixelSize:[self pixelSize]
+                                                           format:MTRenderArenaBitmapFormatRGBA
+                                                 rotatedByDegrees:0
     ];
     
+    if (context) {
+        
+        CGImageRef imageRef = MTRenderArenaCreateImage(context);
+        
+        if (imageRef) {
+            
+            NSMutableData *data = [NSMutableData data];
+            CGImageDestinationRef imageDestination = CGImageDestinationCreateWithData(
+                                                                                      (__bridge CFMutableDataRef)data,
+                                                                                      (CFStringRef)[UTTypePNG identifier],
+                                                                                      1,
+                                                                                      NULL
+                                                                                      );
+            
+            if (imageDestination) {
+                
+                CGImageDestinationAddImage(imageDestination, imageRef, NULL);
+                if (CGImageDestinationFinalize(imageDestination)) { imageData = data; }
+                
+                CFRelease(imageDestination);
+            }
+            
+            CGImageRelease(imageRef);
+        }
+        
+        CGContextRelease(context);
+    }
+    
+    MTRenderArenaRestoreMark(arena, arenaMark);
+    MTTraceEnd("pngData", traceBegin);
+    
     return imageData;
 }
 
++ (NSImage*)imageByConsumingCGImage:(CGImageRef)imageRef
+{
+    NSImage *image = nil;
+    
+    if (imageRef) {
+        
+        image = [[NSImage alloc] initWithCGImage:imageRef size:NSMakeSize(CGImageGetWidth(imageRef), CGImageGetHeight(imageRef))];
+        CGImageRelease(imageRef);
+    }
+    
+    return image;
+}
+
 + (NSImage*)imageWithFileAtURL:(NSURL*)url
 {
     NSImage *returnImage = nil;
+    MTTraceTimestamp traceBegin = MTTraceBegin();
     url = [url URLByResolvingSymlinksInPath];
     
     if ([[NSFileManager defaultManager] fileExistsAtPath:[url path]]) {
@@ -147,6 +451,28 @@
         
         if ([utiValue isEqualTo:[UTTypeApplicationBundle identifier]]) {
             
+            // we try to read the bundle's .icns file directly, which
+            // only decodes the largest image instead of all of them
+            sourceImage = [NSImage imageByConsumingCGImage:[MTIconFile createImageWithBundleAtURL:url]];
+            
+        } else if ([[[url pathExtension] lowercaseString] isEqualToString:@"icns"]) {
+            
+            sourceImage = [NSImage imageByConsumingCGImage:[MTIconFile createImageWithICNSFileAtURL:url]];
+            
+        } else if ([MTPackage isPackageAtURL:url]) {
+            
+            // get the icon of the app inside the package or disk image without installing it
+            if ([[[url pathExtension] lowercaseString] isEqualToString:@"dmg"]) {
+                sourceImage = [NSImage imageByConsumingCGImage:[MTPackage createImageWithDiskImageAtURL:url]];
+            } else {
+                sourceImage = [NSImage imageByConsumingCGImage:[MTPackage createImageWithPackageAtURL:url]];
+            }
+            
+            if (![sourceImage isValid]) { sourceImage = nil; }
+        }
+        
+        if (![sourceImage isValid] && [utiValue isEqualTo:[UTTypeApplicationBundle identifier]]) {
+            
             sourceImage = [[NSWorkspace sharedWorkspace] iconForFile:[url path]];
             
             if ([sourceImage isValid]) {
@@ -158,13 +484,54 @@
                 [sourceImage addRepresentation:imageRep];
             }
             
-        } else {
+        } else if (![sourceImage isValid]) {
             sourceImage = [[NSImage alloc] initWithContentsOfURL:url];
         }
         
         if ([sourceImage isValid]) { returnImage = sourceImage; }
     }
     
+    MTTraceEnd("imageWithFileAtURL", traceBegin);
+    
+    return returnImage;
+}
+
++ (NSImage*)imageWithFileData:(NSData*)data
+{
+    NSImage *returnImage = nil;
+    MTTraceTimestamp traceBegin = MTTraceBegin();
+    const UInt8 *bytes = [data bytes];
+    NSUInteger length = [data length];
+    NSImage *sourceImage = nil;
+    
+    if (length >= 4 && memcmp(bytes, "icns", 4) == 0) {
+        
+        sourceImage = [NSImage imageByConsumingCGImage:[MTIconFile createImageWithICNSData:data]];
+        
+    } else if (length >= 4 && memcmp(bytes, "xar!", 4) == 0) {
+        
+        sourceImage = [NSImage imageByConsumingCGImage:[MTPackage createImageWithPackageData:data]];
+        
+    } else if (length >= 5 && memcmp(bytes, "%PDF-", 5) == 0) {
+        
+        sourceImage = [[NSImage alloc] initWithData:data];
+        
+    } else if (length > 0) {
+        
+        // Image I/O checks the magic bytes of all the bitmap formats it supports
+        CGImageSourceRef imageSource = CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL);
+        
+        if (imageSource) {
+            
+            if (CGImageSourceGetType(imageSource)) { sourceImage = [[NSImage alloc] initWithData:data]; }
+            CFRelease(imageSource);
+        }
+    }
+    
+    if ([sourceImage isValid]) { returnImage = sourceImage; }
+    
+    MTTraceEnd("imageWithFileData", traceBegin);
+    
     return returnImage;
 }
 
@@ -176,14 +543,19 @@
         
         NSRect rect = [view bounds];
         
+        MTTraceTimestamp traceBegin = MTTraceBegin();
         NSBitmapImageRep *imageRep = [view bitmapImageRepForCachingDisplayInRect:rect];
         [view cacheDisplayInRect:rect toBitmapImageRep:imageRep];
+        MTTraceEnd("cacheDisplayInRect", traceBegin);
         
         scaledImage = [NSImage imageWithSize:size
                                      flipped:NO
                               drawingHandler:^BOOL(NSRect dstRect) {
             
+            MTTraceTimestamp traceBegin = MTTraceBegin();
             [imageRep drawInRect:dstRect];
+            MTTraceEnd("downsample view image", traceBegin);
+            
             return YES;
         }
         ];
@@ -43,6 +43,13 @@
 */
 @property (nonatomic, assign) NSPoint overlayPosition;
 
+/*!
+ @property      overlayTransform
+ @abstract      Returns the position, scaling factor and aspect ratio of the overlay image.
+ @discussion    The value of this property is MTOverlayTransform.
+*/
+@property (nonatomic, assign, readonly) MTOverlayTransform overlayTransform;
+
 /*!
  @property      bannerAttributes
  @abstract      The attributes for the banner (color, text and text color).
@@ -88,10 +88,10 @@
     [self addSubview:_containerView];
     
     // add constraints
-    NSLayoutConstraint *containerLeft = [[_containerView leadingAnchor] constraintEqualToAnchor:[self leadingAnchor] constant:7];
-    NSLayoutConstraint *containerRight = [[_containerView trailingAnchor] constraintEqualToAnchor:[self trailingAnchor] constant:-7];
-    NSLayoutConstraint *containerTop = [[_containerView topAnchor] constraintEqualToAnchor:[self topAnchor] constant:7];
-    NSLayoutConstraint *containerBottom = [[_containerView bottomAnchor] constraintEqualToAnchor:[self bottomAnchor] constant:-7];
+    NSLayoutConstraint *containerLeft = [[_containerView leadingAnchor] constraintEqualToAnchor:[self leadingAnchor] constant:kMTDropViewContentInset];
+    NSLayoutConstraint *containerRight = [[_containerView trailingAnchor] constraintEqualToAnchor:[self trailingAnchor] constant:-kMTDropViewContentInset];
+    NSLayoutConstraint *containerTop = [[_containerView topAnchor] constraintEqualToAnchor:[self topAnchor] constant:kMTDropViewContentInset];
+    NSLayoutConstraint *containerBottom = [[_containerView bottomAnchor] constraintEqualToAnchor:[self bottomAnchor] constant:-kMTDropViewContentInset];
     [self addConstraints:[NSArray arrayWithObjects:containerLeft, containerRight, containerTop, containerBottom, nil]];
     
     // create the icon image
@@ -117,25 +117,22 @@
     _overlayImageView = [[MTOverlayImageView alloc] initWithFrame:[_containerView bounds]];
     [_overlayImageView setDelegate:self];
     [_overlayImageView setWantsLayer:YES];
-    [_overlayImageView setTranslatesAutoresizingMaskIntoConstraints:NO];
     [_overlayImageView setImageScaling:NSImageScaleProportionallyUpOrDown];
     [_overlayImageView unregisterDraggedTypes];
-    [_overlayImageView setContentCompressionResistancePriority:NSLayoutPriorityDefaultLow forOrientation:NSLayoutConstraintOrientationHorizontal];
-    [_overlayImageView setContentCompressionResistancePriority:NSLayoutPriorityDefaultLow forOrientation:NSLayoutConstraintOrientationVertical];
     [_overlayImageView setToolTip:NSLocalizedString(@"overlayImageTooltip", nil)];
     [_overlayImageView setAccessibilityIdentifier:@"Overlay Image View"];
     
+    // the overlay image view is not managed by Auto Layout. Its frame
+    // is calculated from the overlay transform whenever the transform
+    // or the size of the container view changes.
+    [_overlayImageView setTranslatesAutoresizingMaskIntoConstraints:YES];
+    [_overlayImageView setAutoresizingMask:NSViewNotSizable];
+    
     _overlayPosition = NSMakePoint(1, 1);
     _overlayImageScalingFactor = kMTOverlayImageScalingDefault;
     _overlayImageAspectRatio = 1;
-  
-    // add constraints
-    NSLayoutConstraint *overlayCenterX = [[_overlayImageView centerXAnchor] constraintEqualToAnchor:[_containerView centerXAnchor]];
-    NSLayoutConstraint *overlayCenterY = [[_overlayImageView centerYAnchor] constraintEqualToAnchor:[_containerView centerYAnchor]];
-    NSLayoutConstraint *overlayWidth = [[_overlayImageView widthAnchor] constraintEqualToAnchor:[_containerView widthAnchor] multiplier:_overlayImageScalingFactor];
 
     [_containerView addSubview:_overlayImageView];
-    [_containerView addConstraints:[NSArray arrayWithObjects:overlayCenterX, overlayCenterY, overlayWidth, nil]];
     
     // add the banner overlay
     _bannerView = [[MTBannerView alloc] initWithFrame:[_containerView bounds]];
@@ -219,35 +216,40 @@
     [_bannerView setClipToIconShape:drawBannerInIconShape];
 }
 
-- (void)setOverlayImageScalingFactor:(CGFloat)scalingFactor
+- (MTOverlayTransform)overlayTransform
 {
-    _overlayImageScalingFactor = scalingFactor;
+    MTOverlayTransform transform = {
+        .position = _overlayPosition,
+        .scale = _overlayImageScalingFactor,
+        .aspectRatio = _overlayImageAspectRatio
+    };
+    
+    return transform;
+}
 
-    // update the overlay image view
-    NSArray *containerViewConstraints = [_containerView constraints];
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"firstItem == %@ AND (firstAttribute == %d OR firstAttribute == %d)", _overlayImageView, NSLayoutAttributeWidth, NSLayoutAttributeHeight];
-    NSArray *filteredArray = [containerViewConstraints filteredArrayUsingPredicate:predicate];
-
-    for (NSLayoutConstraint *existingConstraint in filteredArray) {
-
-        NSLayoutConstraint *newConstraint = [NSLayoutConstraint constraintWithItem:[existingConstraint firstItem]
-                                                                         attribute:[existingConstraint firstAttribute]
-                                                                         relatedBy:[existingConstraint relation]
-                                                                            toItem:[existingConstraint secondItem]
-                                                                         attribute:[existingConstraint secondAttribute]
-                                                                        multiplier:scalingFactor
-                                                                          constant:[existingConstraint constant]
-        ];
-        [newConstraint setPriority:[existingConstraint priority]];
-        [newConstraint setIdentifier:[existingConstraint identifier]];
-        [newConstraint setShouldBeArchived:[existingConstraint shouldBeArchived]];
-
-        // deactivate the existing contraint and activate the new one
-        [NSLayoutConstraint deactivateConstraints:[NSArray arrayWithObject:existingConstraint]];
-        [NSLayoutConstraint activateConstraints:[NSArray arrayWithObject:newConstraint]];
-    }
+- (void)updateOverlayFrame
+{
+    NSRect overlayFrame = MTOverlayFrameWithTransform([self overlayTransform], [_containerView bounds]);
     
-    [self layoutSubtreeIfNeeded];
+    if (!NSEqualRects(overlayFrame, [_overlayImageView frame])) {
+        
+        [CATransaction begin];
+        [CATransaction setDisableActions:YES];
+        [_overlayImageView setFrame:overlayFrame];
+        [CATransaction commit];
+    }
+}
+
+- (void)layout
+{
+    [super layout];
+    [self updateOverlayFrame];
+}
+
+- (void)setOverlayImageScalingFactor:(CGFloat)scalingFactor
+{
+    _overlayImageScalingFactor = scalingFactor;
+    [self updateOverlayFrame];
     
     [[NSNotificationCenter defaultCenter] postNotificationName:kMTNotificationNameOverlayImageScalingChanged
                                                         object:self
@@ -258,80 +260,13 @@
 - (void)setOverlayImageAspectRatio:(CGFloat)aspectRatio
 {
     _overlayImageAspectRatio = aspectRatio;
-    
-    // update the overlay image view
-    [_overlayImageView removeConstraints:[_overlayImageView constraints]];
-    
-    NSLayoutConstraint *overlayAspect = [NSLayoutConstraint constraintWithItem:_overlayImageView
-                                                                     attribute:NSLayoutAttributeWidth
-                                                                     relatedBy:NSLayoutRelationEqual
-                                                                        toItem:_overlayImageView
-                                                                     attribute:NSLayoutAttributeHeight
-                                                                    multiplier:_overlayImageAspectRatio
-                                                                      constant:0
-    ];
-    
-    [_overlayImageView addConstraint:overlayAspect];
-    
-    // update the overlay image view
-    NSArray *containerViewConstraints = [_containerView constraints];
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"firstItem == %@ AND (firstAttribute == %d OR firstAttribute == %d)", _overlayImageView, NSLayoutAttributeWidth, NSLayoutAttributeHeight];
-    NSArray *filteredArray = [containerViewConstraints filteredArrayUsingPredicate:predicate];
-
-    for (NSLayoutConstraint *existingConstraint in filteredArray) {
-        
-        NSLayoutAttribute attribute = (_overlayImageAspectRatio < 1) ? NSLayoutAttributeHeight : NSLayoutAttributeWidth;
-
-        NSLayoutConstraint *newConstraint = [NSLayoutConstraint constraintWithItem:[existingConstraint firstItem]
-                                                                         attribute:attribute
-                                                                         relatedBy:[existingConstraint relation]
-                                                                            toItem:[existingConstraint secondItem]
-                                                                         attribute:attribute
-                                                                        multiplier:[existingConstraint multiplier]
-                                                                          constant:[existingConstraint constant]
-        ];
-        [newConstraint setPriority:[existingConstraint priority]];
-        [newConstraint setIdentifier:[existingConstraint identifier]];
-        [newConstraint setShouldBeArchived:[existingConstraint shouldBeArchived]];
-
-        // deactivate the existing contraint and activate the new one
-        [NSLayoutConstraint deactivateConstraints:[NSArray arrayWithObject:existingConstraint]];
-        [NSLayoutConstraint activateConstraints:[NSArray arrayWithObject:newConstraint]];
-    }
-    
-    [self layoutSubtreeIfNeeded];
+    [self updateOverlayFrame];
 }
 
 - (void)setOverlayPosition:(NSPoint)position
 {
     _overlayPosition = position;
-    
-    NSArray *imageViewConstraints = [_containerView constraints];
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"firstItem == %@ AND (firstAttribute == %d OR firstAttribute == %d)", _overlayImageView, NSLayoutAttributeCenterX, NSLayoutAttributeCenterY];
-    NSArray *filteredArray = [imageViewConstraints filteredArrayUsingPredicate:predicate];
-
-    for (NSLayoutConstraint *existingConstraint in filteredArray) {
-        
-        CGFloat newMultiplier = ([existingConstraint firstAttribute] == NSLayoutAttributeCenterX) ? position.x : position.y;
-        
-        NSLayoutConstraint *newConstraint = [NSLayoutConstraint constraintWithItem:[existingConstraint firstItem]
-                                                                         attribute:[existingConstraint firstAttribute]
-                                                                         relatedBy:[existingConstraint relation]
-                                                                            toItem:[existingConstraint secondItem]
-                                                                         attribute:[existingConstraint secondAttribute]
-                                                                        multiplier:newMultiplier
-                                                                          constant:[existingConstraint constant]
-        ];
-        [newConstraint setPriority:[existingConstraint priority]];
-        [newConstraint setIdentifier:[existingConstraint identifier]];
-        [newConstraint setShouldBeArchived:[existingConstraint shouldBeArchived]];
-        
-        // deactivate the existing contraint and activate the new one
-        [NSLayoutConstraint deactivateConstraints:[NSArray arrayWithObject:existingConstraint]];
-        [NSLayoutConstraint activateConstraints:[NSArray arrayWithObject:newConstraint]];
-    }
-    
-    [self layoutSubtreeIfNeeded];
+    [self updateOverlayFrame];
     
     [[NSNotificationCenter defaultCenter] postNotificationName:kMTNotificationNameOverlayImagePositionChanged
                                                         object:self
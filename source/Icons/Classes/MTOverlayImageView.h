@@ -19,6 +19,30 @@
 
 @class MTOverlayImageView;
 
+/*!
+ @typedef       MTOverlayTransform
+ @abstract      Describes the placement of an overlay image independently of the size of its container.
+ @field         position The normalized center of the overlay image. The x value is measured from the container's
+                leading edge and the y value from its top edge. A value of 0 specifies the edge, a value of 1
+                the center and a value of 2 the opposite edge of the container.
+ @field         scale The size of the overlay image's longer side as a fraction of the container size.
+ @field         aspectRatio The aspect ratio (width / height) of the overlay image.
+*/
+typedef struct {
+    NSPoint position;
+    CGFloat scale;
+    CGFloat aspectRatio;
+} MTOverlayTransform;
+
+/*!
+ @function      MTOverlayFrameWithTransform
+ @abstract      Returns the frame of an overlay image with the given transform.
+ @param         transform The transform of the overlay image.
+ @param         bounds The bounds of the overlay image's container.
+ @discussion    Returns the frame of the overlay image in the coordinate system of the container.
+*/
+NSRect MTOverlayFrameWithTransform(MTOverlayTransform transform, NSRect bounds);
+
 /*!
  @protocol      MTOverlayImageViewDelegate
  @abstract      Defines an interface for delegates of MTOverlayImageView to be notified if specific aspects of the view have changed.
@@ -22,6 +22,33 @@
 @property (assign) BOOL shouldBeRemoved;
 @end
 
+NSRect MTOverlayFrameWithTransform(MTOverlayTransform transform, NSRect bounds)
+{
+    CGFloat containerWidth = NSWidth(bounds);
+    CGFloat containerHeight = NSHeight(bounds);
+    CGFloat aspectRatio = (transform.aspectRatio > 0) ? transform.aspectRatio : 1;
+    CGFloat width = 0;
+    CGFloat height = 0;
+    
+    // the longer side of the image is scaled to
+    // the corresponding side of the container
+    if (aspectRatio < 1) {
+        
+        height = containerHeight * transform.scale;
+        width = height * aspectRatio;
+        
+    } else {
+        
+        width = containerWidth * transform.scale;
+        height = width / aspectRatio;
+    }
+    
+    CGFloat centerX = NSMinX(bounds) + containerWidth / 2.0 * transform.position.x;
+    CGFloat centerY = NSMaxY(bounds) - containerHeight / 2.0 * transform.position.y;
+    
+    return NSMakeRect(centerX - width / 2.0, centerY - height / 2.0, width, height);
+}
+
 @implementation MTOverlayImageView
 
 - (void)setImage:(NSImage *)image
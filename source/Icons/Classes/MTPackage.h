@@ -0,0 +1,72 @@
+/*
+    MTPackage.h
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+/*!
+ @abstract      This class provides methods to get the icon of an application that is contained in an installer
+                package or a disk image, without installing the package or copying the application.
+ @discussion    Flat packages are read as xar archives. Only the table of contents is decompressed to find the
+                payloads, which are then streamed (gzip or pbzx compressed cpio archives) until the application's
+                Info.plist and the referenced .icns file or asset catalog have been found. Decompression stops as
+                soon as the icon has been decoded and the contents of all other files are skipped without being
+                copied. Disk images are attached read-only without being shown in the Finder, so only the blocks
+                that are actually read are decompressed.
+ */
+
+@interface MTPackage : NSObject
+
+/*!
+ @method        isPackageAtURL:
+ @abstract      Returns if the file at the given url is an installer package or a disk image.
+ @param         url The url of the file.
+ @discussion    Returns YES if the file is a flat package (.pkg), a bundle package or a disk image (.dmg), otherwise
+                returns NO. Only the file extension is checked.
+ */
++ (BOOL)isPackageAtURL:(NSURL*)url;
+
+/*!
+ @method        createImageWithPackageAtURL:
+ @abstract      Decode the largest icon image of the first application contained in the given installer package.
+ @param         url The url of the flat package or bundle package.
+ @discussion    Returns an image or NULL if the package does not contain an application with a (supported) icon or
+                an error occurred. The caller is responsible for releasing the image.
+ */
++ (CGImageRef)createImageWithPackageAtURL:(NSURL*)url CF_RETURNS_RETAINED;
+
+/*!
+ @method        createImageWithPackageData:
+ @abstract      Decode the largest icon image of the first application contained in the given flat package.
+ @param         data The contents of the flat package (e.g. read from standard input).
+ @discussion    Returns an image or NULL if the package does not contain an application with a (supported) icon or
+                an error occurred. The caller is responsible for releasing the image.
+ */
++ (CGImageRef)createImageWithPackageData:(NSData*)data CF_RETURNS_RETAINED;
+
+/*!
+ @method        createImageWithDiskImageAtURL:
+ @abstract      Decode the largest icon image of the first application contained in the given disk image.
+ @param         url The url of the disk image.
+ @discussion    The disk image is attached read-only to a temporary mount point and detached afterwards. If the
+                disk image does not contain an application but an installer package, the icon is read from the
+                package. Returns an image or NULL if no (supported) icon has been found or an error occurred. The
+                caller is responsible for releasing the image.
+ */
++ (CGImageRef)createImageWithDiskImageAtURL:(NSURL*)url CF_RETURNS_RETAINED;
+
+@end
@@ -0,0 +1,893 @@
+/*
+    MTPackage.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTPackage.h"
+#import "MTIconFile.h"
+#import "MTAssetCatalog.h"
+#import "MTTrace.h"
+#import <compression.h>
+#import <os/log.h>
+
+#define kMTPackageStreamChunkSize       (256 * 1024)
+#define kMTPackageXarHeaderSize         28
+#define kMTPackageTOCSizeMax            (64 * 1024 * 1024)
+#define kMTPackagePBZXHeaderSize        12
+#define kMTPackagePBZXChunkHeaderSize   16
+#define kMTPackagePBZXChunkSizeMax      (64 * 1024 * 1024)
+#define kMTPackageODCHeaderSize         76
+#define kMTPackageNewcHeaderSize        110
+#define kMTPackageEntryNameMax          4096
+#define kMTPackageEntrySizeMax          (256 * 1024 * 1024)
+#define kMTPackageAssetCatalogName      @"Assets.car"
+
+static inline uint16_t readBE16(const UInt8 *bytes) { return (uint16_t)((bytes[0] << 8) | bytes[1]); }
+static inline uint32_t readBE32(const UInt8 *bytes) { return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3]; }
+static inline uint64_t readBE64(const UInt8 *bytes) { return ((uint64_t)readBE32(bytes) << 32) | readBE32(bytes + 4); }
+
+static uint64_t parseNumber(const UInt8 *bytes, NSUInteger length, unsigned int base, BOOL *valid)
+{
+    // cpio headers contain numbers as octal (odc) or hexadecimal (newc) strings
+    uint64_t value = 0;
+
+    for (NSUInteger i = 0; i < length; i++) {
+
+        UInt8 character = bytes[i];
+        unsigned int digit = base;
+
+        if (character >= '0' && character <= '9') {
+            digit = character - '0';
+        } else if (character >= 'a' && character <= 'f') {
+            digit = character - 'a' + 10;
+        } else if (character >= 'A' && character <= 'F') {
+            digit = character - 'A' + 10;
+        }
+
+        if (digit >= base) { *valid = NO; return 0; }
+        value = value * base + digit;
+    }
+
+    return value;
+}
+
+#pragma mark - Streams
+
+/*
+ A stream delivers the bytes of a file range or of a decompressed
+ payload in chunks. Subclasses provide the chunks, the base class
+ buffers them, so callers can read or skip an exact number of bytes.
+ */
+@interface MTPackageStream : NSObject
+- (NSData*)nextChunk;
+- (NSData*)peekDataOfLength:(NSUInteger)length;
+- (NSData*)readDataOfLength:(NSUInteger)length;
+- (BOOL)skipDataOfLength:(uint64_t)length;
+@end
+
+@implementation MTPackageStream
+{
+    NSMutableData *_buffer;
+    NSUInteger _bufferPosition;
+    BOOL _endOfStream;
+}
+
+- (instancetype)init
+{
+    self = [super init];
+
+    if (self) {
+        _buffer = [[NSMutableData alloc] init];
+    }
+
+    return self;
+}
+
+- (NSData*)nextChunk
+{
+    return nil;
+}
+
+- (BOOL)fillBufferToLength:(NSUInteger)length
+{
+    while ([_buffer length] - _bufferPosition < length && !_endOfStream) {
+
+        NSData *chunk = [self nextChunk];
+
+        if ([chunk length] > 0) {
+
+            // drop the bytes that have already been consumed
+            if (_bufferPosition > 0) {
+                [_buffer replaceBytesInRange:NSMakeRange(0, _bufferPosition) withBytes:NULL length:0];
+                _bufferPosition = 0;
+            }
+
+            [_buffer appendData:chunk];
+
+        } else {
+
+            _endOfStream = YES;
+        }
+    }
+
+    return ([_buffer length] - _bufferPosition >= length);
+}
+
+- (NSData*)peekDataOfLength:(NSUInteger)length
+{
+    [self fillBufferToLength:length];
+    NSUInteger availableLength = MIN(length, [_buffer length] - _bufferPosition);
+
+    return [_buffer subdataWithRange:NSMakeRange(_bufferPosition, availableLength)];
+}
+
+- (NSData*)readDataOfLength:(NSUInteger)length
+{
+    NSData *data = [self peekDataOfLength:length];
+    _bufferPosition += [data length];
+
+    return data;
+}
+
+- (BOOL)skipDataOfLength:(uint64_t)length
+{
+    uint64_t remainingLength = length;
+
+    while (remainingLength > 0) {
+
+        NSUInteger availableLength = [_buffer length] - _bufferPosition;
+
+        if (availableLength == 0) {
+
+            if (![self fillBufferToLength:1]) { break; }
+            availableLength = [_buffer length] - _bufferPosition;
+        }
+
+        // skipped bytes are never copied
+        NSUInteger skipLength = (NSUInteger)MIN((uint64_t)availableLength, remainingLength);
+        _bufferPosition += skipLength;
+        remainingLength -= skipLength;
+    }
+
+    return (remainingLength == 0);
+}
+
+@end
+
+typedef NSData* (^MTPackageReader)(uint64_t offset, NSUInteger length);
+
+static MTPackageReader readerWithFileHandle(NSFileHandle *fileHandle)
+{
+    return ^NSData *(uint64_t offset, NSUInteger length) {
+
+        NSData *data = nil;
+        if ([fileHandle seekToOffset:offset error:nil]) { data = [fileHandle readDataUpToLength:length error:nil]; }
+
+        return data;
+    };
+}
+
+static MTPackageReader readerWithData(NSData *data)
+{
+    return ^NSData *(uint64_t offset, NSUInteger length) {
+
+        NSData *subdata = nil;
+
+        if (offset < [data length]) {
+
+            // the chunks are only used while the data is alive, so they don't have to be copied
+            length = (NSUInteger)MIN((uint64_t)length, [data length] - offset);
+            subdata = [NSData dataWithBytesNoCopy:(UInt8*)[data bytes] + offset length:length freeWhenDone:NO];
+
+        } else {
+            subdata = [NSData data];
+        }
+
+        return subdata;
+    };
+}
+
+@interface MTPackageReaderStream : MTPackageStream
+- (instancetype)initWithReader:(MTPackageReader)reader offset:(uint64_t)offset length:(uint64_t)length;
+@end
+
+@implementation MTPackageReaderStream
+{
+    MTPackageReader _reader;
+    uint64_t _offset;
+    uint64_t _remainingLength;
+}
+
+- (instancetype)initWithReader:(MTPackageReader)reader offset:(uint64_t)offset length:(uint64_t)length
+{
+    self = [super init];
+
+    if (self) {
+
+        _reader = reader;
+        _offset = offset;
+        _remainingLength = length;
+    }
+
+    return self;
+}
+
+- (NSData*)nextChunk
+{
+    NSData *chunk = nil;
+
+    if (_remainingLength > 0) {
+
+        chunk = _reader(_offset, (NSUInteger)MIN((uint64_t)kMTPackageStreamChunkSize, _remainingLength));
+        _offset += [chunk length];
+        _remainingLength = ([chunk length] > 0) ? _remainingLength - [chunk length] : 0;
+    }
+
+    return chunk;
+}
+
+@end
+
+@interface MTPackageDataStream : MTPackageStream
+- (instancetype)initWithData:(NSData*)data;
+@end
+
+@implementation MTPackageDataStream
+{
+    NSData *_data;
+}
+
+- (instancetype)initWithData:(NSData*)data
+{
+    self = [super init];
+
+    if (self) {
+        _data = data;
+    }
+
+    return self;
+}
+
+- (NSData*)nextChunk
+{
+    NSData *chunk = _data;
+    _data = nil;
+
+    return chunk;
+}
+
+@end
+
+@interface MTPackageDecompressingStream : MTPackageStream
+- (instancetype)initWithStream:(MTPackageStream*)stream algorithm:(compression_algorithm)algorithm;
+@end
+
+@implementation MTPackageDecompressingStream
+{
+    MTPackageStream *_source;
+    NSData *_input;
+    compression_stream _stream;
+    BOOL _initialized;
+    BOOL _inputFinished;
+    BOOL _finished;
+}
+
+- (instancetype)initWithStream:(MTPackageStream*)stream algorithm:(compression_algorithm)algorithm
+{
+    self = [super init];
+
+    if (self) {
+
+        _source = stream;
+        _initialized = (compression_stream_init(&_stream, COMPRESSION_STREAM_DECODE, algorithm) == COMPRESSION_STATUS_OK);
+        if (!_initialized) { self = nil; }
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    if (_initialized) { compression_stream_destroy(&_stream); }
+}
+
+- (NSData*)nextChunk
+{
+    NSMutableData *chunk = nil;
+
+    if (!_finished) {
+
+        chunk = [NSMutableData dataWithLength:kMTPackageStreamChunkSize];
+        _stream.dst_ptr = [chunk mutableBytes];
+        _stream.dst_size = kMTPackageStreamChunkSize;
+
+        while (_stream.dst_size > 0 && !_finished) {
+
+            if (_stream.src_size == 0 && !_inputFinished) {
+
+                _input = [_source readDataOfLength:kMTPackageStreamChunkSize];
+                _inputFinished = ([_input length] == 0);
+                _stream.src_ptr = [_input bytes];
+                _stream.src_size = [_input length];
+            }
+
+            size_t previousSize = _stream.dst_size;
+            compression_status status = compression_stream_process(&_stream, (_inputFinished) ? COMPRESSION_STREAM_FINALIZE : 0);
+
+            // stop at the end of the compressed data, on errors and
+            // if truncated input does not produce any more output
+            if (status != COMPRESSION_STATUS_OK || (_inputFinished && _stream.dst_size == previousSize)) { _finished = YES; }
+        }
+
+        [chunk setLength:kMTPackageStreamChunkSize - _stream.dst_size];
+    }
+
+    return ([chunk length] > 0) ? chunk : nil;
+}
+
+@end
+
+@interface MTPackagePBZXStream : MTPackageStream
+- (instancetype)initWithStream:(MTPackageStream*)stream;
+@end
+
+@implementation MTPackagePBZXStream
+{
+    MTPackageStream *_source;
+    MTPackageStream *_chunkStream;
+}
+
+- (instancetype)initWithStream:(MTPackageStream*)stream
+{
+    self = [super init];
+
+    if (self) {
+        _source = stream;
+    }
+
+    return self;
+}
+
+- (NSData*)nextChunk
+{
+    NSData *chunk = nil;
+
+    while (!chunk) {
+
+        if (_chunkStream) {
+
+            chunk = [_chunkStream nextChunk];
+            if (!chunk) { _chunkStream = nil; }
+
+        } else {
+
+            // every chunk is a separate xz stream (or stored uncompressed
+            // if compression did not reduce its size), so chunks are only
+            // decompressed when the archive is read up to their position
+            NSData *header = [_source readDataOfLength:kMTPackagePBZXChunkHeaderSize];
+            if ([header length] < kMTPackagePBZXChunkHeaderSize) { break; }
+
+            uint64_t length = readBE64([header bytes] + 8);
+            if (length == 0 || length > kMTPackagePBZXChunkSizeMax) { break; }
+
+            NSData *data = [_source readDataOfLength:(NSUInteger)length];
+            if ([data length] < length) { break; }
+
+            const UInt8 *bytes = [data bytes];
+
+            if (length >= 6 && memcmp(bytes, "\xfd" "7zXZ\0", 6) == 0) {
+
+                _chunkStream = [[MTPackageDecompressingStream alloc] initWithStream:[[MTPackageDataStream alloc] initWithData:data]
+                                                                         algorithm:COMPRESSION_LZMA];
+                if (!_chunkStream) { break; }
+
+            } else {
+
+                chunk = data;
+            }
+        }
+    }
+
+    return chunk;
+}
+
+@end
+
+#pragma mark - Package reader
+
+static BOOL skipGzipHeader(MTPackageStream *stream)
+{
+    BOOL success = NO;
+    NSData *header = [stream readDataOfLength:10];
+    const UInt8 *bytes = [header bytes];
+
+    if ([header length] == 10 && bytes[0] == 0x1f && bytes[1] == 0x8b && bytes[2] == 8) {
+
+        UInt8 flags = bytes[3];
+        success = YES;
+
+        // optional extra field
+        if (flags & 0x04) {
+
+            NSData *extraLength = [stream readDataOfLength:2];
+            const UInt8 *lengthBytes = [extraLength bytes];
+            success = ([extraLength length] == 2 && [stream skipDataOfLength:lengthBytes[0] | (lengthBytes[1] << 8)]);
+        }
+
+        // optional file name and comment, both zero-terminated
+        for (UInt8 flag = 0x08; flag <= 0x10 && success; flag <<= 1) {
+
+            if (flags & flag) {
+
+                NSData *character = nil;
+                do { character = [stream readDataOfLength:1]; } while ([character length] == 1 && *(const UInt8*)[character bytes] != 0);
+                success = ([character length] == 1);
+            }
+        }
+
+        // optional header checksum
+        if ((flags & 0x02) && success) { success = [stream skipDataOfLength:2]; }
+    }
+
+    return success;
+}
+
+static MTPackageStream *archiveStreamWithPayloadStream(MTPackageStream *payloadStream)
+{
+    MTPackageStream *archiveStream = nil;
+    NSData *magic = [payloadStream peekDataOfLength:4];
+    const UInt8 *bytes = [magic bytes];
+
+    if ([magic length] == 4) {
+
+        if (bytes[0] == 0x1f && bytes[1] == 0x8b) {
+
+            // libcompression expects raw deflate data without the gzip header
+            if (skipGzipHeader(payloadStream)) {
+                archiveStream = [[MTPackageDecompressingStream alloc] initWithStream:payloadStream algorithm:COMPRESSION_ZLIB];
+            }
+
+        } else if (memcmp(bytes, "pbzx", 4) == 0) {
+
+            if ([payloadStream skipDataOfLength:kMTPackagePBZXHeaderSize]) {
+                archiveStream = [[MTPackagePBZXStream alloc] initWithStream:payloadStream];
+            }
+
+        } else if (memcmp(bytes, "0707", 4) == 0) {
+
+            archiveStream = payloadStream;
+        }
+    }
+
+    return archiveStream;
+}
+
+static NSString *bundlePathWithPath(NSString *path)
+{
+    NSString *bundlePath = nil;
+    NSArray *pathComponents = [path pathComponents];
+
+    for (NSUInteger i = 0; i < [pathComponents count]; i++) {
+
+        if ([[[pathComponents objectAtIndex:i] pathExtension] caseInsensitiveCompare:@"app"] == NSOrderedSame) {
+            bundlePath = [NSString pathWithComponents:[pathComponents subarrayWithRange:NSMakeRange(0, i + 1)]];
+            break;
+        }
+    }
+
+    return bundlePath;
+}
+
+static uint64_t unsignedValueOfChildElement(NSXMLElement *element, NSString *name)
+{
+    NSString *stringValue = [[[element elementsForName:name] firstObject] stringValue];
+    return ([stringValue length] > 0) ? strtoull([stringValue UTF8String], NULL, 10) : 0;
+}
+
+@implementation MTPackage
+
++ (BOOL)isPackageAtURL:(NSURL*)url
+{
+    NSString *fileExtension = [[url pathExtension] lowercaseString];
+    NSArray *packageExtensions = [NSArray arrayWithObjects:@"pkg", @"mpkg", @"dmg", nil];
+
+    return [packageExtensions containsObject:fileExtension];
+}
+
++ (CGImageRef)createImageWithPackageAtURL:(NSURL*)url
+{
+    CGImageRef imageRef = NULL;
+    MTTraceTimestamp traceBegin = MTTraceBegin();
+    BOOL isDirectory = NO;
+
+    if ([[NSFileManager defaultManager] fileExistsAtPath:[url path] isDirectory:&isDirectory]) {
+
+        // bundle packages contain a single gzip compressed cpio archive,
+        // flat packages are xar archives containing one or more payloads
+        NSURL *archiveURL = (isDirectory) ? [url URLByAppendingPathComponent:@"Contents/Archive.pax.gz"] : url;
+        NSFileHandle *fileHandle = [NSFileHandle fileHandleForReadingFromURL:archiveURL error:nil];
+
+        if (fileHandle) {
+
+            if (isDirectory) {
+
+                MTPackageStream *payloadStream = [[MTPackageReaderStream alloc] initWithReader:readerWithFileHandle(fileHandle) offset:0 length:UINT64_MAX];
+                imageRef = [self createImageWithArchiveStream:archiveStreamWithPayloadStream(payloadStream)];
+
+            } else {
+
+                imageRef = [self createImageWithFlatPackageReader:readerWithFileHandle(fileHandle)];
+            }
+
+            [fileHandle closeAndReturnError:nil];
+        }
+    }
+
+    MTTraceEnd("read package", traceBegin);
+
+    return imageRef;
+}
+
++ (CGImageRef)createImageWithPackageData:(NSData*)data
+{
+    CGImageRef imageRef = NULL;
+    MTTraceTimestamp traceBegin = MTTraceBegin();
+
+    if (data) { imageRef = [self createImageWithFlatPackageReader:readerWithData(data)]; }
+
+    MTTraceEnd("read package", traceBegin);
+
+    return imageRef;
+}
+
++ (CGImageRef)createImageWithFlatPackageReader:(MTPackageReader)reader
+{
+    CGImageRef imageRef = NULL;
+    NSData *header = reader(0, kMTPackageXarHeaderSize);
+    const UInt8 *bytes = [header bytes];
+
+    if ([header length] == kMTPackageXarHeaderSize && readBE32(bytes) == 'xar!') {
+
+        uint16_t headerSize = readBE16(bytes + 4);
+        uint64_t tocCompressedLength = readBE64(bytes + 8);
+        uint64_t tocLength = readBE64(bytes + 16);
+
+        if (tocCompressedLength > 2 && tocCompressedLength <= kMTPackageTOCSizeMax && tocLength <= kMTPackageTOCSizeMax) {
+
+            // the table of contents is a zlib compressed xml document
+            NSData *tocCompressedData = reader(headerSize, (NSUInteger)tocCompressedLength);
+            NSMutableData *tocData = [NSMutableData dataWithLength:(NSUInteger)tocLength];
+
+            size_t decodedLength = 0;
+
+            if ([tocCompressedData length] == tocCompressedLength) {
+
+                decodedLength = compression_decode_buffer(
+                                                          [tocData mutableBytes],
+                                                          [tocData length],
+                                                          (const UInt8*)[tocCompressedData bytes] + 2,
+                                                          [tocCompressedData length] - 2,
+                                                          NULL,
+                                                          COMPRESSION_ZLIB
+                                                          );
+            }
+
+            NSXMLDocument *toc = (decodedLength == tocLength) ? [[NSXMLDocument alloc] initWithData:tocData options:0 error:nil] : nil;
+            NSArray *payloads = [toc nodesForXPath:@"//file[name='Payload']/data" error:nil];
+            uint64_t heapOffset = headerSize + tocCompressedLength;
+
+            // distribution packages contain a payload for each component
+            // package, so we use the first one that contains an app
+            for (NSXMLElement *payload in payloads) {
+
+                if (![payload isKindOfClass:[NSXMLElement class]]) { continue; }
+
+                uint64_t offset = unsignedValueOfChildElement(payload, @"offset");
+                uint64_t length = unsignedValueOfChildElement(payload, @"length");
+                NSString *encoding = [[[[payload elementsForName:@"encoding"] firstObject] attributeForName:@"style"] stringValue];
+
+                MTPackageStream *payloadStream = [[MTPackageReaderStream alloc] initWithReader:reader
+                                                                                        offset:heapOffset + offset
+                                                                                        length:length
+                ];
+
+                if ([encoding isEqualToString:@"application/x-gzip"]) {
+
+                    // xar compresses files with zlib, so the zlib header has to be skipped
+                    payloadStream = ([payloadStream skipDataOfLength:2]) ? [[MTPackageDecompressingStream alloc] initWithStream:payloadStream algorithm:COMPRESSION_ZLIB] : nil;
+
+                } else if (encoding && ![encoding isEqualToString:@"application/octet-stream"]) {
+
+                    payloadStream = nil;
+                }
+
+                if (payloadStream) {
+
+                    imageRef = [self createImageWithArchiveStream:archiveStreamWithPayloadStream(payloadStream)];
+                    if (imageRef) { break; }
+                }
+            }
+        }
+    }
+
+    return imageRef;
+}
+
++ (CGImageRef)createImageWithArchiveStream:(MTPackageStream*)archiveStream
+{
+    CGImageRef imageRef = NULL;
+    NSString *bundlePath = nil;
+    NSDictionary *infoDictionary = nil;
+    NSMutableDictionary *resources = [NSMutableDictionary dictionary];
+
+    while (archiveStream && !imageRef) {
+
+        NSData *magic = [archiveStream peekDataOfLength:6];
+        if ([magic length] < 6) { break; }
+
+        BOOL isNewFormat = (memcmp([magic bytes], "070701", 6) == 0 || memcmp([magic bytes], "070702", 6) == 0);
+        if (!isNewFormat && memcmp([magic bytes], "070707", 6) != 0) { break; }
+
+        NSUInteger headerSize = (isNewFormat) ? kMTPackageNewcHeaderSize : kMTPackageODCHeaderSize;
+        NSData *header = [archiveStream readDataOfLength:headerSize];
+        if ([header length] < headerSize) { break; }
+
+        const UInt8 *bytes = [header bytes];
+        BOOL isValid = YES;
+        uint64_t mode = 0, nameSize = 0, fileSize = 0;
+
+        if (isNewFormat) {
+
+            mode = parseNumber(bytes + 14, 8, 16, &isValid);
+            fileSize = parseNumber(bytes + 54, 8, 16, &isValid);
+            nameSize = parseNumber(bytes + 94, 8, 16, &isValid);
+
+        } else {
+
+            mode = parseNumber(bytes + 18, 6, 8, &isValid);
+            nameSize = parseNumber(bytes + 59, 6, 8, &isValid);
+            fileSize = parseNumber(bytes + 65, 11, 8, &isValid);
+        }
+
+        if (!isValid || nameSize == 0 || nameSize > kMTPackageEntryNameMax) { break; }
+
+        NSData *nameData = [archiveStream readDataOfLength:(NSUInteger)nameSize];
+        if ([nameData length] < nameSize) { break; }
+
+        // entries of the new format are padded to a multiple of four bytes
+        uint64_t namePadding = (isNewFormat) ? (4 - (headerSize + nameSize) % 4) % 4 : 0;
+        uint64_t dataPadding = (isNewFormat) ? (4 - fileSize % 4) % 4 : 0;
+        if (![archiveStream skipDataOfLength:namePadding]) { break; }
+
+        NSString *path = [[NSString alloc] initWithBytes:[nameData bytes]
+                                                  length:strnlen((const char*)[nameData bytes], (size_t)nameSize)
+                                                encoding:NSUTF8StringEncoding
+        ];
+
+        if ([path isEqualToString:@"TRAILER!!!"]) { break; }
+        if ([path hasPrefix:@"./"]) { path = [path substringFromIndex:2]; }
+
+        // the first app in the archive is the one we are looking for
+        if (!bundlePath) { bundlePath = bundlePathWithPath(path); }
+
+        BOOL isInfoPlist = NO;
+        BOOL isWanted = NO;
+
+        if (bundlePath && (mode & 0170000) == 0100000 && fileSize <= kMTPackageEntrySizeMax) {
+
+            NSString *fileName = [path lastPathComponent];
+            NSString *resourcesPath = [bundlePath stringByAppendingPathComponent:@"Contents/Resources"];
+
+            if ([path isEqualToString:[bundlePath stringByAppendingPathComponent:@"Contents/Info.plist"]]) {
+
+                isInfoPlist = YES;
+                isWanted = YES;
+
+            } else if ([[path stringByDeletingLastPathComponent] isEqualToString:resourcesPath]) {
+
+                if (infoDictionary) {
+
+                    // we only keep the files the Info.plist refers to
+                    NSArray *iconFileNames = [MTIconFile iconFileNamesWithInfoDictionary:infoDictionary];
+                    isWanted = ([iconFileNames containsObject:fileName] ||
+                                ([fileName isEqualToString:kMTPackageAssetCatalogName] &&
+                                 ([infoDictionary objectForKey:@"CFBundleIconName"] || [iconFileNames count] == 0)));
+
+                } else {
+
+                    isWanted = ([[[fileName pathExtension] lowercaseString] isEqualToString:@"icns"] ||
+                                [fileName isEqualToString:kMTPackageAssetCatalogName]);
+                }
+            }
+        }
+
+        if (isWanted) {
+
+            NSData *fileData = [archiveStream readDataOfLength:(NSUInteger)fileSize];
+            if ([fileData length] < fileSize) { break; }
+
+            if (isInfoPlist) {
+
+                id propertyList = [NSPropertyListSerialization propertyListWithData:fileData
+                                                                            options:NSPropertyListImmutable
+                                                                             format:nil
+                                                                              error:nil
+                ];
+
+                infoDictionary = ([propertyList isKindOfClass:[NSDictionary class]]) ? propertyList : [NSDictionary dictionary];
+
+            } else {
+
+                [resources setObject:fileData forKey:[path lastPathComponent]];
+            }
+
+            // stop reading the archive as soon as we got the icon
+            if (infoDictionary) { imageRef = [self createImageWithInfoDictionary:infoDictionary resources:resources]; }
+
+        } else if (![archiveStream skipDataOfLength:fileSize]) {
+
+            break;
+        }
+
+        if (![archiveStream skipDataOfLength:dataPadding]) { break; }
+    }
+
+    if (!imageRef && [resources count] > 0) {
+
+        // the Info.plist is missing or refers to files that do not
+        // exist, so we use the asset catalog or any of the icon files
+        imageRef = [self createImageWithInfoDictionary:infoDictionary resources:resources];
+
+        for (NSString *fileName in [[resources allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+
+            if (imageRef) { break; }
+            if ([[[fileName pathExtension] lowercaseString] isEqualToString:@"icns"]) {
+                imageRef = [MTIconFile createImageWithICNSData:[resources objectForKey:fileName]];
+            }
+        }
+    }
+
+    return imageRef;
+}
+
++ (CGImageRef)createImageWithInfoDictionary:(NSDictionary*)infoDictionary resources:(NSDictionary*)resources
+{
+    CGImageRef imageRef = NULL;
+
+    for (NSString *fileName in [MTIconFile iconFileNamesWithInfoDictionary:infoDictionary]) {
+
+        NSData *iconData = [resources objectForKey:fileName];
+
+        if (iconData) {
+
+            imageRef = [MTIconFile createImageWithICNSData:iconData];
+            if (imageRef) { break; }
+        }
+    }
+
+    NSData *catalogData = [resources objectForKey:kMTPackageAssetCatalogName];
+
+    if (!imageRef && catalogData) {
+
+        MTAssetCatalog *assetCatalog = [[MTAssetCatalog alloc] initWithData:catalogData];
+        id iconName = [infoDictionary objectForKey:@"CFBundleIconName"];
+
+        imageRef = [assetCatalog createImageNamed:([iconName isKindOfClass:[NSString class]] && [iconName length] > 0) ? iconName : @"AppIcon"];
+    }
+
+    return imageRef;
+}
+
++ (CGImageRef)createImageWithDiskImageAtURL:(NSURL*)url
+{
+    CGImageRef imageRef = NULL;
+    MTTraceTimestamp traceBegin = MTTraceBegin();
+
+    NSURL *mountURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+
+    if ([[NSFileManager defaultManager] createDirectoryAtURL:mountURL withIntermediateDirectories:YES attributes:nil error:nil]) {
+
+        // the disk image is attached read-only and without being shown in the
+        // Finder. A license agreement (if any) is accepted by writing "Y" to
+        // the standard input of hdiutil
+        BOOL success = [self runDiskImageUtilityWithArguments:[NSArray arrayWithObjects:
+                                                               @"attach",
+                                                               @"-readonly",
+                                                               @"-nobrowse",
+                                                               @"-noautoopen",
+                                                               @"-noverify",
+                                                               @"-mountpoint",
+                                                               [mountURL path],
+                                                               [url path],
+                                                               nil
+                                                               ]
+        ];
+
+        if (success) {
+
+            NSArray *contents = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:mountURL
+                                                              includingPropertiesForKeys:nil
+                                                                                 options:NSDirectoryEnumerationSkipsHiddenFiles
+                                                                                   error:nil
+            ];
+
+            contents = [contents sortedArrayUsingComparator:^NSComparisonResult(NSURL *url1, NSURL *url2) {
+                return [[url1 lastPathComponent] compare:[url2 lastPathComponent]];
+            }];
+
+            // prefer an app over an installer package
+            for (NSURL *fileURL in contents) {
+
+                if ([[[fileURL pathExtension] lowercaseString] isEqualToString:@"app"]) {
+                    imageRef = [MTIconFile createImageWithBundleAtURL:fileURL];
+                    if (imageRef) { break; }
+                }
+            }
+
+            for (NSURL *fileURL in contents) {
+
+                if (imageRef) { break; }
+
+                NSString *fileExtension = [[fileURL pathExtension] lowercaseString];
+
+                if ([fileExtension isEqualToString:@"pkg"] || [fileExtension isEqualToString:@"mpkg"]) {
+                    imageRef = [self createImageWithPackageAtURL:fileURL];
+                }
+            }
+
+            if (![self runDiskImageUtilityWithArguments:[NSArray arrayWithObjects:@"detach", [mountURL path], @"-force", nil]]) {
+                os_log_error(OS_LOG_DEFAULT, "SAPCorp: Failed to detach disk image %{public}@ mounted at %{public}@", [url path], [mountURL path]);
+            }
+        }
+
+        // the mount point is only removed if it is empty, so we never
+        // delete the contents of a volume that is still attached
+        if (rmdir([mountURL fileSystemRepresentation]) != 0) {
+            os_log_error(OS_LOG_DEFAULT, "SAPCorp: Failed to remove mount point %{public}@: %{public}s", [mountURL path], strerror(errno));
+        }
+    }
+
+    MTTraceEnd("read disk image", traceBegin);
+
+    return imageRef;
+}
+
++ (BOOL)runDiskImageUtilityWithArguments:(NSArray*)arguments
+{
+    BOOL success = NO;
+
+    NSPipe *inputPipe = [NSPipe pipe];
+    NSTask *task = [[NSTask alloc] init];
+    [task setExecutableURL:[NSURL fileURLWithPath:@"/usr/bin/hdiutil"]];
+    [task setArguments:arguments];
+    [task setStandardInput:inputPipe];
+    [task setStandardOutput:[NSFileHandle fileHandleWithNullDevice]];
+    [task setStandardError:[NSFileHandle fileHandleWithNullDevice]];
+
+    // the answer is written before launching the task, so it is buffered
+    // by the pipe and we never write to a pipe that has already been closed
+    [[inputPipe fileHandleForWriting] writeData:[@"Y\n" dataUsingEncoding:NSUTF8StringEncoding] error:nil];
+    [[inputPipe fileHandleForWriting] closeAndReturnError:nil];
+
+    if ([task launchAndReturnError:nil]) {
+
+        [task waitUntilExit];
+        success = ([task terminationStatus] == 0);
+    }
+
+    return success;
+}
+
+@end
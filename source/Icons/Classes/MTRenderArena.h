@@ -0,0 +1,162 @@
+/*
+    MTRenderArena.h
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+/*!
+ @typedef       MTRenderArenaRef
+ @abstract      An opaque reference to a bump allocator for short-lived pixel and scratch buffers.
+ @discussion    Every thread has its own arena, so an arena must never be shared between threads. Memory
+                returned by an arena must not be freed and is only valid until the arena is restored to
+                an earlier mark or reset. Arenas of threads that exit are returned to a pool and are
+                handed out again to new threads.
+*/
+typedef struct MTRenderArena *MTRenderArenaRef;
+
+/*!
+ @typedef       MTRenderArenaMark
+ @abstract      A position within an arena, returned by MTRenderArenaGetMark().
+ @discussion    A mark becomes invalid when the arena is reset.
+*/
+typedef struct {
+    void *chunk;
+    size_t used;
+    size_t bytesInUse;
+} MTRenderArenaMark;
+
+/*!
+ @typedef       MTRenderArenaBitmapFormat
+ @abstract      The pixel formats of bitmap contexts created by MTRenderArenaCreateBitmapContext().
+ @constant      MTRenderArenaBitmapFormatRGBA Premultiplied 8 bit RGBA in the color space passed to
+                MTRenderArenaCreateBitmapContext() or in sRGB, if no usable color space has been passed.
+ @constant      MTRenderArenaBitmapFormatAlphaOnly An 8 bit alpha channel without color information.
+*/
+typedef enum {
+    MTRenderArenaBitmapFormatRGBA = 0,
+    MTRenderArenaBitmapFormatAlphaOnly = 1
+} MTRenderArenaBitmapFormat;
+
+/*!
+ @typedef       MTRenderArenaStatistics
+ @abstract      Usage statistics of an arena or of all arenas of the process.
+ @field         chunkAllocations The number of times the arena had to allocate memory from the system.
+ @field         reservedBytes The number of bytes currently reserved by the arena.
+ @field         peakBytes The maximum number of bytes that have been in use at the same time.
+ @field         resets The number of times the arena has been reset.
+*/
+typedef struct {
+    NSUInteger chunkAllocations;
+    size_t reservedBytes;
+    size_t peakBytes;
+    NSUInteger resets;
+} MTRenderArenaStatistics;
+
+/*!
+ @function      MTRenderArenaGetCurrent
+ @abstract      Returns the arena of the current thread.
+ @discussion    The arena is created (or taken from the pool) the first time this function is called on a thread.
+*/
+MTRenderArenaRef MTRenderArenaGetCurrent(void);
+
+/*!
+ @function      MTRenderArenaAllocate
+ @abstract      Allocates the given number of bytes from the given arena.
+ @param         arena The arena to allocate from.
+ @param         size The number of bytes to allocate.
+ @discussion    Returns a pointer to uninitialized memory, aligned to 64 bytes, or NULL if an error occurred.
+*/
+void *MTRenderArenaAllocate(MTRenderArenaRef arena, size_t size);
+
+/*!
+ @function      MTRenderArenaGetMark
+ @abstract      Returns the current position of the given arena.
+ @param         arena The arena.
+ @discussion    Pass the returned mark to MTRenderArenaRestoreMark() to release all memory that has been allocated
+                after the mark has been taken.
+*/
+MTRenderArenaMark MTRenderArenaGetMark(MTRenderArenaRef arena);
+
+/*!
+ @function      MTRenderArenaRestoreMark
+ @abstract      Releases all memory that has been allocated after the given mark has been taken.
+ @param         arena The arena.
+ @param         mark A mark returned by MTRenderArenaGetMark() for the same arena.
+ @discussion    The memory is kept by the arena and reused by the following allocations.
+*/
+void MTRenderArenaRestoreMark(MTRenderArenaRef arena, MTRenderArenaMark mark);
+
+/*!
+ @function      MTRenderArenaReset
+ @abstract      Releases all memory allocated from the given arena.
+ @param         arena The arena.
+ @discussion    Call this function after an icon has been completely processed. If the arena had to grow while
+                processing the icon, its chunks are merged into a single one, so processing the next icon of
+                the same size does not allocate any memory from the system.
+*/
+void MTRenderArenaReset(MTRenderArenaRef arena);
+
+/*!
+ @function      MTRenderArenaTrim
+ @abstract      Releases all memory allocated from the given arena and returns its chunks to the system.
+ @param         arena The arena.
+ @discussion    Unlike MTRenderArenaReset(), the arena does not keep any memory for the next icon. Call this
+                function after a job has been finished, if the process should not keep the memory around
+                (e.g. in an extension with a limited amount of memory).
+*/
+void MTRenderArenaTrim(MTRenderArenaRef arena);
+
+/*!
+ @function      MTRenderArenaGetStatistics
+ @abstract      Returns the usage statistics of the given arena.
+ @param         arena The arena.
+*/
+MTRenderArenaStatistics MTRenderArenaGetStatistics(MTRenderArenaRef arena);
+
+/*!
+ @function      MTRenderArenaGetTotalStatistics
+ @abstract      Returns the usage statistics of all arenas of the process, including the arenas of threads that have exited.
+ @discussion    The peak is the sum of the peaks of the arenas, so it is an upper bound of the memory that has been in use
+                at the same time. Call this function when the other threads don't use their arenas, otherwise the statistics
+                may be inaccurate.
+*/
+MTRenderArenaStatistics MTRenderArenaGetTotalStatistics(void);
+
+/*!
+ @function      MTRenderArenaCreateBitmapContext
+ @abstract      Creates a bitmap context whose pixel buffer is allocated from the given arena.
+ @param         arena The arena to allocate the pixel buffer from.
+ @param         width The width of the bitmap in pixels.
+ @param         height The height of the bitmap in pixels.
+ @param         format The pixel format of the bitmap.
+ @param         colorSpace The RGB color space of the bitmap or NULL for sRGB. It is ignored for alpha-only
+                bitmaps and if it can't be used for 8 bit bitmaps, sRGB is used instead.
+ @discussion    Returns a cleared bitmap context or NULL if an error occurred. The caller is responsible for
+                releasing the context. The context must not be used after the arena has been restored to
+                an earlier mark or reset.
+*/
+CGContextRef MTRenderArenaCreateBitmapContext(MTRenderArenaRef arena, size_t width, size_t height, MTRenderArenaBitmapFormat format, CGColorSpaceRef colorSpace);
+
+/*!
+ @function      MTRenderArenaCreateImage
+ @abstract      Creates an image from the pixels of the given bitmap context.
+ @param         context A bitmap context created by MTRenderArenaCreateBitmapContext().
+ @discussion    Returns an image or NULL if an error occurred. The caller is responsible for releasing the image.
+                The pixels are copied into memory owned by the image, so the image stays valid after the arena
+                has been restored to an earlier mark or reset.
+*/
+CGImageRef MTRenderArenaCreateImage(CGContextRef context);
@@ -0,0 +1,398 @@
+/*
+    MTRenderArena.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTRenderArena.h"
+#import <os/lock.h>
+#import <pthread.h>
+
+#define kMTRenderArenaAlignment         64
+#define kMTRenderArenaChunkSizeDefault  (4 * 1024 * 1024)
+#define kMTRenderArenaRetainedSizeMax   (256 * 1024 * 1024)
+#define kMTRenderArenaPoolSizeMax       8
+
+typedef struct MTRenderArenaChunk {
+    struct MTRenderArenaChunk *next;
+    size_t size;
+    size_t used;
+} MTRenderArenaChunk;
+
+struct MTRenderArena {
+    struct MTRenderArena *nextArena;
+    MTRenderArenaChunk *firstChunk;
+    MTRenderArenaChunk *currentChunk;
+    size_t bytesInUse;
+    MTRenderArenaStatistics statistics;
+};
+
+static pthread_key_t arenaKey;
+static os_unfair_lock poolLock = OS_UNFAIR_LOCK_INIT;
+static MTRenderArenaRef arenaPool[kMTRenderArenaPoolSizeMax];
+static NSUInteger arenaPoolCount = 0;
+
+// all arenas (in use or pooled) and the statistics of the
+// destroyed ones, so the statistics of the process can be
+// collected. Both are protected by the pool lock
+static MTRenderArenaRef allArenas = NULL;
+static MTRenderArenaStatistics destroyedArenaStatistics = { 0, 0, 0, 0 };
+
+static inline size_t alignedSize(size_t size)
+{
+    return (size + kMTRenderArenaAlignment - 1) & ~((size_t)kMTRenderArenaAlignment - 1);
+}
+
+static inline void *chunkData(MTRenderArenaChunk *chunk)
+{
+    // the chunk header occupies the first aligned block of the chunk
+    return (char*)chunk + kMTRenderArenaAlignment;
+}
+
+static MTRenderArenaChunk *createChunk(MTRenderArenaRef arena, size_t size)
+{
+    void *memory = NULL;
+    MTRenderArenaChunk *chunk = NULL;
+
+    if (posix_memalign(&memory, kMTRenderArenaAlignment, kMTRenderArenaAlignment + size) == 0) {
+
+        chunk = memory;
+        chunk->next = NULL;
+        chunk->size = size;
+        chunk->used = 0;
+
+        arena->statistics.chunkAllocations++;
+        arena->statistics.reservedBytes += size;
+    }
+
+    return chunk;
+}
+
+static void freeChunks(MTRenderArenaRef arena)
+{
+    MTRenderArenaChunk *chunk = arena->firstChunk;
+
+    while (chunk) {
+
+        MTRenderArenaChunk *nextChunk = chunk->next;
+        arena->statistics.reservedBytes -= chunk->size;
+        free(chunk);
+        chunk = nextChunk;
+    }
+
+    arena->firstChunk = NULL;
+    arena->currentChunk = NULL;
+    arena->bytesInUse = 0;
+}
+
+static void addStatistics(MTRenderArenaStatistics *total, MTRenderArenaStatistics statistics)
+{
+    total->chunkAllocations += statistics.chunkAllocations;
+    total->reservedBytes += statistics.reservedBytes;
+    total->peakBytes += statistics.peakBytes;
+    total->resets += statistics.resets;
+}
+
+static void destroyArena(MTRenderArenaRef arena)
+{
+    freeChunks(arena);
+
+    os_unfair_lock_lock(&poolLock);
+
+    MTRenderArenaRef *link = &allArenas;
+    while (*link && *link != arena) { link = &(*link)->nextArena; }
+    if (*link) { *link = arena->nextArena; }
+
+    addStatistics(&destroyedArenaStatistics, arena->statistics);
+
+    os_unfair_lock_unlock(&poolLock);
+
+    free(arena);
+}
+
+static void releaseArena(void *value)
+{
+    // the thread exits, so we put its arena back into
+    // the pool to be used by the next worker thread
+    MTRenderArenaRef arena = value;
+    MTRenderArenaReset(arena);
+
+    BOOL pooled = NO;
+    os_unfair_lock_lock(&poolLock);
+
+    if (arenaPoolCount < kMTRenderArenaPoolSizeMax) {
+        arenaPool[arenaPoolCount++] = arena;
+        pooled = YES;
+    }
+
+    os_unfair_lock_unlock(&poolLock);
+
+    if (!pooled) { destroyArena(arena); }
+}
+
+static void createArenaKey(void)
+{
+    pthread_key_create(&arenaKey, releaseArena);
+}
+
+MTRenderArenaRef MTRenderArenaGetCurrent(void)
+{
+    static pthread_once_t keyOnce = PTHREAD_ONCE_INIT;
+    pthread_once(&keyOnce, createArenaKey);
+
+    MTRenderArenaRef arena = pthread_getspecific(arenaKey);
+
+    if (!arena) {
+
+        os_unfair_lock_lock(&poolLock);
+        if (arenaPoolCount > 0) { arena = arenaPool[--arenaPoolCount]; }
+        os_unfair_lock_unlock(&poolLock);
+
+        if (!arena) {
+
+            arena = calloc(1, sizeof(struct MTRenderArena));
+
+            if (arena) {
+                os_unfair_lock_lock(&poolLock);
+                arena->nextArena = allArenas;
+                allArenas = arena;
+                os_unfair_lock_unlock(&poolLock);
+            }
+        }
+
+        if (arena) { pthread_setspecific(arenaKey, arena); }
+    }
+
+    return arena;
+}
+
+void *MTRenderArenaAllocate(MTRenderArenaRef arena, size_t size)
+{
+    void *memory = NULL;
+
+    if (arena && size > 0) {
+
+        size = alignedSize(size);
+        MTRenderArenaChunk *chunk = arena->currentChunk;
+
+        // chunks following the current chunk are unused, so
+        // we move on until we find one that is large enough
+        while (chunk && chunk->size - chunk->used < size && chunk->next) {
+
+            chunk = chunk->next;
+            chunk->used = 0;
+        }
+
+        if (!chunk || chunk->size - chunk->used < size) {
+
+            MTRenderArenaChunk *newChunk = createChunk(arena, (size > kMTRenderArenaChunkSizeDefault) ? size : kMTRenderArenaChunkSizeDefault);
+
+            if (newChunk) {
+
+                if (chunk) {
+                    chunk->next = newChunk;
+                } else {
+                    arena->firstChunk = newChunk;
+                }
+            }
+
+            chunk = newChunk;
+        }
+
+        if (chunk) {
+
+            memory = (char*)chunkData(chunk) + chunk->used;
+            chunk->used += size;
+            arena->currentChunk = chunk;
+
+            arena->bytesInUse += size;
+            if (arena->bytesInUse > arena->statistics.peakBytes) { arena->statistics.peakBytes = arena->bytesInUse; }
+        }
+    }
+
+    return memory;
+}
+
+MTRenderArenaMark MTRenderArenaGetMark(MTRenderArenaRef arena)
+{
+    MTRenderArenaMark mark = { NULL, 0, 0 };
+
+    if (arena && arena->currentChunk) {
+        mark.chunk = arena->currentChunk;
+        mark.used = arena->currentChunk->used;
+        mark.bytesInUse = arena->bytesInUse;
+    }
+
+    return mark;
+}
+
+void MTRenderArenaRestoreMark(MTRenderArenaRef arena, MTRenderArenaMark mark)
+{
+    if (arena) {
+
+        if (mark.chunk) {
+
+            arena->currentChunk = mark.chunk;
+            arena->currentChunk->used = mark.used;
+
+        } else {
+
+            arena->currentChunk = arena->firstChunk;
+            if (arena->currentChunk) { arena->currentChunk->used = 0; }
+        }
+
+        arena->bytesInUse = mark.bytesInUse;
+    }
+}
+
+void MTRenderArenaReset(MTRenderArenaRef arena)
+{
+    if (arena) {
+
+        size_t reservedBytes = arena->statistics.reservedBytes;
+        BOOL multipleChunks = (arena->firstChunk && arena->firstChunk->next);
+
+        if (reservedBytes > kMTRenderArenaRetainedSizeMax) {
+
+            // don't keep an unusually large amount of memory around
+            freeChunks(arena);
+
+        } else if (multipleChunks) {
+
+            // merge the chunks into a single one that is
+            // large enough for the next icon of this size
+            freeChunks(arena);
+            arena->firstChunk = createChunk(arena, reservedBytes);
+        }
+
+        arena->currentChunk = arena->firstChunk;
+        if (arena->currentChunk) { arena->currentChunk->used = 0; }
+
+        arena->bytesInUse = 0;
+        arena->statistics.resets++;
+    }
+}
+
+void MTRenderArenaTrim(MTRenderArenaRef arena)
+{
+    if (arena) {
+
+        freeChunks(arena);
+        arena->statistics.resets++;
+    }
+}
+
+MTRenderArenaStatistics MTRenderArenaGetStatistics(MTRenderArenaRef arena)
+{
+    MTRenderArenaStatistics statistics = { 0, 0, 0, 0 };
+    if (arena) { statistics = arena->statistics; }
+
+    return statistics;
+}
+
+MTRenderArenaStatistics MTRenderArenaGetTotalStatistics(void)
+{
+    os_unfair_lock_lock(&poolLock);
+
+    MTRenderArenaStatistics statistics = destroyedArenaStatistics;
+    for (MTRenderArenaRef arena = allArenas; arena; arena = arena->nextArena) { addStatistics(&statistics, arena->statistics); }
+
+    os_unfair_lock_unlock(&poolLock);
+
+    return statistics;
+}
+
+CGContextRef MTRenderArenaCreateBitmapContext(MTRenderArenaRef arena, size_t width, size_t height, MTRenderArenaBitmapFormat format, CGColorSpaceRef colorSpace)
+{
+    CGContextRef context = NULL;
+
+    if (width > 0 && height > 0) {
+
+        BOOL alphaOnly = (format == MTRenderArenaBitmapFormatAlphaOnly);
+        size_t bytesPerRow = alignedSize(width * ((alphaOnly) ? 1 : 4));
+        void *pixels = MTRenderArenaAllocate(arena, bytesPerRow * height);
+
+        if (pixels) {
+
+            // arena memory is not cleared
+            memset(pixels, 0, bytesPerRow * height);
+
+            static CGColorSpaceRef sRGBColorSpace = NULL;
+            static dispatch_once_t onceToken;
+            dispatch_once(&onceToken, ^{
+                sRGBColorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+            });
+
+            if (alphaOnly) {
+
+                context = CGBitmapContextCreate(pixels, width, height, 8, bytesPerRow, NULL, (CGBitmapInfo)kCGImageAlphaOnly);
+
+            } else {
+
+                // keep the color space of the source (e.g. Display P3), so
+                // wide gamut colors are not clipped to sRGB
+                if (colorSpace && CGColorSpaceGetModel(colorSpace) == kCGColorSpaceModelRGB) {
+                    context = CGBitmapContextCreate(pixels, width, height, 8, bytesPerRow, colorSpace, (CGBitmapInfo)kCGImageAlphaPremultipliedLast);
+                }
+
+                if (!context) {
+                    context = CGBitmapContextCreate(pixels, width, height, 8, bytesPerRow, sRGBColorSpace, (CGBitmapInfo)kCGImageAlphaPremultipliedLast);
+                }
+            }
+        }
+    }
+
+    return context;
+}
+
+CGImageRef MTRenderArenaCreateImage(CGContextRef context)
+{
+    CGImageRef imageRef = NULL;
+    CGColorSpaceRef colorSpace = CGBitmapContextGetColorSpace(context);
+    void *pixels = CGBitmapContextGetData(context);
+
+    // alpha-only bitmaps can't be turned into images
+    if (colorSpace && pixels) {
+
+        size_t height = CGBitmapContextGetHeight(context);
+        size_t bytesPerRow = CGBitmapContextGetBytesPerRow(context);
+
+        // the image may be used (e.g. by an image destination that has not been finalized
+        // yet) after the arena memory has been reused, so it gets a copy of the pixels
+        CFDataRef pixelData = CFDataCreate(kCFAllocatorDefault, pixels, bytesPerRow * height);
+        CGDataProviderRef dataProvider = (pixelData) ? CGDataProviderCreateWithCFData(pixelData) : NULL;
+        if (pixelData) { CFRelease(pixelData); }
+
+        if (dataProvider) {
+
+            imageRef = CGImageCreate(
+                                     CGBitmapContextGetWidth(context),
+                                     height,
+                                     CGBitmapContextGetBitsPerComponent(context),
+                                     CGBitmapContextGetBitsPerPixel(context),
+                                     bytesPerRow,
+                                     colorSpace,
+                                     CGBitmapContextGetBitmapInfo(context),
+                                     dataProvider,
+                                     NULL,
+                                     false,
+                                     kCGRenderingIntentDefault
+                                     );
+
+            CGDataProviderRelease(dataProvider);
+        }
+    }
+
+    return imageRef;
+}
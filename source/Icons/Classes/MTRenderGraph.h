@@ -0,0 +1,107 @@
+/*
+    MTRenderGraph.h
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @enum          MTRenderGraphNodeOptions
+ @abstract      Options for the nodes of a render graph.
+ @constant      MTRenderGraphNodeOptionsNone The node is executed on a background thread and its output is released
+                as soon as all of its consumers have been executed.
+ @constant      MTRenderGraphNodeOptionsMainThread The node is executed on the thread that runs the graph. Use this
+                option for nodes that access views.
+ @constant      MTRenderGraphNodeOptionsRetainOutput The output of the node is kept after the graph has been run,
+                so it can be retrieved using outputForKey:.
+*/
+typedef NS_OPTIONS(NSUInteger, MTRenderGraphNodeOptions) {
+    MTRenderGraphNodeOptionsNone         = 0,
+    MTRenderGraphNodeOptionsMainThread   = 1 << 0,
+    MTRenderGraphNodeOptionsRetainOutput = 1 << 1
+};
+
+/*!
+ @abstract      A directed acyclic graph of processing steps (e.g. decode, scale, inset, render, encode).
+ @discussion    Every node is identified by a key that describes its operation and its inputs. Adding a node whose key
+                already exists does not add another node, so steps that are needed by several paths (e.g. the scaled
+                source image used by the install and the uninstall icon) are only executed once. When the graph is run,
+                independent nodes are executed concurrently and intermediate outputs are released as soon as their last
+                consumer has been executed. Because nodes can only depend on nodes that have already been added, the
+                graph can't contain cycles.
+ */
+
+@interface MTRenderGraph : NSObject
+
+/*!
+ @method        keyWithOperation:parameters:dependencies:
+ @abstract      Returns a node key for the given operation.
+ @param         operation The name of the operation (e.g. "scale").
+ @param         parameters A string describing the parameters of the operation (may be nil).
+ @param         dependencies The keys of the nodes the operation depends on (may be nil).
+ @discussion    Two nodes that perform the same operation with the same parameters on the same inputs get the same
+                key and are therefore only executed once.
+ */
++ (NSString*)keyWithOperation:(NSString*)operation
+                   parameters:(NSString*)parameters
+                 dependencies:(NSArray*)dependencies;
+
+/*!
+ @method        addNodeWithKey:dependencies:options:block:
+ @abstract      Adds a node to the graph.
+ @param         key The key of the node.
+ @param         dependencies The keys of the nodes whose outputs are passed to the block (may be nil).
+ @param         options The options of the node.
+ @param         block The block that is executed to calculate the output of the node. The outputs of the dependencies
+                are passed in the same order as the keys in the dependencies array. A block that returns nil marks the
+                node as failed. The block of a node that depends on a failed node is not executed and the node is marked
+                as failed as well, so the inputs passed to a block are never nil.
+ @discussion    Returns the key of the node or nil, if one of the dependencies does not exist. If a node with the given
+                key already exists, the existing node is used and the given block is ignored. Nodes must not be added
+                while the graph is running.
+ */
+- (NSString*)addNodeWithKey:(NSString*)key
+               dependencies:(NSArray*)dependencies
+                    options:(MTRenderGraphNodeOptions)options
+                      block:(id (^)(NSArray *inputs))block;
+
+/*!
+ @method        run
+ @abstract      Executes all nodes of the graph.
+ @discussion    This method returns after all nodes have been executed. Nodes with the MTRenderGraphNodeOptionsMainThread
+                option are executed on the calling thread, all other nodes are executed on background threads. If the
+                graph contains main thread nodes, this method must be called on the main thread.
+ */
+- (void)run;
+
+/*!
+ @method        nodeFailedForKey:
+ @abstract      Returns whether the node with the given key has failed.
+ @param         key The key of the node.
+ @discussion    Returns YES if the node's block returned nil or if the node has not been executed because one of its
+                dependencies failed. Returns NO if the node does not exist or has not been executed yet.
+ */
+- (BOOL)nodeFailedForKey:(NSString*)key;
+
+/*!
+ @method        outputForKey:
+ @abstract      Returns the output of the node with the given key.
+ @param         key The key of the node.
+ @discussion    Returns the output of the node or nil, if the node does not exist, has not been executed yet, did not
+                return an output, or if its output has already been released.
+ */
+- (id)outputForKey:(NSString*)key;
+
+@end
@@ -0,0 +1,271 @@
+/*
+    MTRenderGraph.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTRenderGraph.h"
+#import "MTTrace.h"
+#import <os/lock.h>
+
+@interface MTRenderGraphNode : NSObject
+@property (nonatomic, strong, readwrite) NSString *key;
+@property (nonatomic, strong, readwrite) NSArray *dependencies;
+@property (nonatomic, strong, readwrite) NSMutableArray *consumers;
+@property (nonatomic, copy, readwrite) id (^block)(NSArray *inputs);
+@property (nonatomic, assign) MTRenderGraphNodeOptions options;
+@property (nonatomic, assign) NSUInteger pendingDependencies;
+@property (nonatomic, assign) NSUInteger pendingConsumers;
+@property (nonatomic, strong, readwrite) id output;
+@property (nonatomic, assign) BOOL failed;
+@end
+
+@implementation MTRenderGraphNode
+@end
+
+@interface MTRenderGraph ()
+@property (nonatomic, strong, readwrite) NSMutableDictionary *nodes;
+@property (nonatomic, strong, readwrite) NSMutableArray *readyNodes;
+@property (nonatomic, assign) NSUInteger finishedNodes;
+@end
+
+@implementation MTRenderGraph
+{
+    os_unfair_lock _lock;
+    dispatch_semaphore_t _nodeFinished;
+}
+
+- (instancetype)init
+{
+    self = [super init];
+
+    if (self) {
+
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _nodes = [[NSMutableDictionary alloc] init];
+        _readyNodes = [[NSMutableArray alloc] init];
+    }
+
+    return self;
+}
+
++ (NSString*)keyWithOperation:(NSString*)operation
+                   parameters:(NSString*)parameters
+                 dependencies:(NSArray*)dependencies
+{
+    NSString *key = [NSString stringWithFormat:@"%@[%@](%@)",
+                     operation,
+                     (parameters) ? parameters : @"",
+                     (dependencies) ? [dependencies componentsJoinedByString:@","] : @""
+    ];
+
+    return key;
+}
+
+- (NSString*)addNodeWithKey:(NSString*)key
+               dependencies:(NSArray*)dependencies
+                    options:(MTRenderGraphNodeOptions)options
+                      block:(id (^)(NSArray *inputs))block
+{
+    NSString *nodeKey = nil;
+
+    if (key && block) {
+
+        if ([_nodes objectForKey:key]) {
+
+            // the same operation on the same inputs has already been
+            // added, so the existing node is shared by both consumers
+            nodeKey = key;
+
+        } else {
+
+            BOOL dependenciesExist = YES;
+
+            for (NSString *dependency in dependencies) {
+                if (![_nodes objectForKey:dependency]) { dependenciesExist = NO; break; }
+            }
+
+            if (dependenciesExist) {
+
+                MTRenderGraphNode *node = [[MTRenderGraphNode alloc] init];
+                [node setKey:key];
+                [node setDependencies:(dependencies) ? dependencies : [NSArray array]];
+                [node setConsumers:[NSMutableArray array]];
+                [node setBlock:block];
+                [node setOptions:options];
+
+                [_nodes setObject:node forKey:key];
+                nodeKey = key;
+            }
+        }
+    }
+
+    return nodeKey;
+}
+
+- (void)run
+{
+    MTTraceTimestamp traceBegin = MTTraceBegin();
+
+    _nodeFinished = dispatch_semaphore_create(0);
+    _finishedNodes = 0;
+    [_readyNodes removeAllObjects];
+
+    // connect the nodes with their consumers
+    for (MTRenderGraphNode *node in [_nodes allValues]) {
+
+        [node setOutput:nil];
+        [node setFailed:NO];
+        [[node consumers] removeAllObjects];
+        [node setPendingDependencies:[[node dependencies] count]];
+    }
+
+    for (MTRenderGraphNode *node in [_nodes allValues]) {
+
+        for (NSString *dependency in [node dependencies]) {
+            [[[_nodes objectForKey:dependency] consumers] addObject:node];
+        }
+    }
+
+    for (MTRenderGraphNode *node in [_nodes allValues]) {
+
+        [node setPendingConsumers:[[node consumers] count]];
+        if ([node pendingDependencies] == 0) { [_readyNodes addObject:node]; }
+    }
+
+    NSUInteger nodeCount = [_nodes count];
+    dispatch_queue_t backgroundQueue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+
+    while (YES) {
+
+        NSMutableArray *mainThreadNodes = [NSMutableArray array];
+
+        os_unfair_lock_lock(&_lock);
+
+        BOOL finished = (_finishedNodes == nodeCount);
+
+        for (MTRenderGraphNode *node in _readyNodes) {
+
+            if ([node options] & MTRenderGraphNodeOptionsMainThread) {
+
+                [mainThreadNodes addObject:node];
+
+            } else {
+
+                dispatch_async(backgroundQueue, ^{
+                    [self executeNode:node];
+                });
+            }
+        }
+
+        [_readyNodes removeAllObjects];
+        os_unfair_lock_unlock(&_lock);
+
+        if (finished) { break; }
+
+        if ([mainThreadNodes count] > 0) {
+
+            for (MTRenderGraphNode *node in mainThreadNodes) { [self executeNode:node]; }
+
+        } else {
+
+            // wait until one of the background nodes has
+            // been executed and check for new ready nodes
+            dispatch_semaphore_wait(_nodeFinished, DISPATCH_TIME_FOREVER);
+        }
+    }
+
+    MTTraceEnd("run render graph", traceBegin);
+}
+
+- (void)executeNode:(MTRenderGraphNode*)node
+{
+    NSMutableArray *inputs = [NSMutableArray arrayWithCapacity:[[node dependencies] count]];
+    BOOL dependencyFailed = NO;
+
+    os_unfair_lock_lock(&_lock);
+
+    for (NSString *dependency in [node dependencies]) {
+
+        MTRenderGraphNode *dependencyNode = [_nodes objectForKey:dependency];
+        if ([dependencyNode failed]) { dependencyFailed = YES; break; }
+
+        [inputs addObject:[dependencyNode output]];
+    }
+
+    os_unfair_lock_unlock(&_lock);
+
+    id output = nil;
+
+    // a node whose inputs are incomplete is not executed, so
+    // the failure is passed on to all nodes that depend on it
+    if (!dependencyFailed) {
+
+        @autoreleasepool {
+            output = [node block](inputs);
+        }
+    }
+
+    inputs = nil;
+
+    os_unfair_lock_lock(&_lock);
+
+    [node setOutput:output];
+    [node setFailed:(output == nil)];
+
+    // release the outputs of dependencies whose consumers have all been executed
+    for (NSString *dependency in [node dependencies]) {
+
+        MTRenderGraphNode *dependencyNode = [_nodes objectForKey:dependency];
+        [dependencyNode setPendingConsumers:[dependencyNode pendingConsumers] - 1];
+
+        if ([dependencyNode pendingConsumers] == 0 && !([dependencyNode options] & MTRenderGraphNodeOptionsRetainOutput)) {
+            [dependencyNode setOutput:nil];
+        }
+    }
+
+    if ([node pendingConsumers] == 0 && !([node options] & MTRenderGraphNodeOptionsRetainOutput)) { [node setOutput:nil]; }
+
+    // schedule the consumers whose inputs are complete
+    for (MTRenderGraphNode *consumer in [node consumers]) {
+
+        [consumer setPendingDependencies:[consumer pendingDependencies] - 1];
+        if ([consumer pendingDependencies] == 0) { [_readyNodes addObject:consumer]; }
+    }
+
+    _finishedNodes++;
+    os_unfair_lock_unlock(&_lock);
+
+    dispatch_semaphore_signal(_nodeFinished);
+}
+
+- (BOOL)nodeFailedForKey:(NSString*)key
+{
+    os_unfair_lock_lock(&_lock);
+    BOOL failed = [[_nodes objectForKey:key] failed];
+    os_unfair_lock_unlock(&_lock);
+
+    return failed;
+}
+
+- (id)outputForKey:(NSString*)key
+{
+    os_unfair_lock_lock(&_lock);
+    id output = [[_nodes objectForKey:key] output];
+    os_unfair_lock_unlock(&_lock);
+
+    return output;
+}
+
+@end
@@ -0,0 +1,326 @@
+/*
+    MTRenderPreset.h
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Cocoa/Cocoa.h>
+#import "MTBannerView.h"
+#import "MTUninstallIconView.h"
+
+#define kMTRenderPresetFileExtension    @"iconpreset"
+
+/*!
+ @class         MTRenderPreset
+ @abstract      An immutable object containing the validated settings that are used to create an icon set.
+ @discussion    A render preset is compiled once from the settings (all values are clamped to their valid ranges,
+                the default banner is looked up and parsed and the delete badge is loaded) and can then be shared
+                by any number of concurrent renders. Render presets can be written to a file and loaded again, so
+                the command line tool can create icon sets with the same settings as the app and the app extension.
+
+                A preset file starts with a fixed-size little-endian header (magic "MTRP", major and minor schema
+                version, header length, flags and all numeric settings), followed by the length-prefixed banner
+                name, banner (RTF), delete badge and file name prefix. Files are memory-mapped and loading a preset
+                just copies the header, the banner and the badge are parsed when they are first used. A new minor
+                version may only append fields to the header, so files of a newer minor version can still be
+                read. Files with a different major version are rejected.
+*/
+
+@interface MTRenderPreset : NSObject <NSCopying, NSSecureCoding>
+
+/*!
+ @property      outputSize
+ @abstract      The size of the icons in pixels.
+ @discussion    The value of this property is an unsigned integer. If 0, the largest size the source image can be
+                scaled to is used.
+*/
+@property (nonatomic, assign, readonly) NSUInteger outputSize;
+
+/*!
+ @property      autoImageInset
+ @abstract      Specifies if the inset of the uninstall icon's image is calculated from the image.
+ @discussion    The value of this property is a boolean.
+*/
+@property (nonatomic, assign, readonly) BOOL autoImageInset;
+
+/*!
+ @property      imageInset
+ @abstract      The inset of the uninstall icon's image.
+ @discussion    The value of this property is a float. It is only used if autoImageInset is NO.
+*/
+@property (nonatomic, assign, readonly) CGFloat imageInset;
+
+/*!
+ @property      animationDuration
+ @abstract      The duration of the animated uninstall icon's animation.
+ @discussion    The value of this property is a float. It is 0 if no animated uninstall icon is created.
+*/
+@property (nonatomic, assign, readonly) CGFloat animationDuration;
+
+/*!
+ @property      createsInstallIcon
+ @abstract      Specifies if the install icon is created.
+ @discussion    The value of this property is a boolean.
+*/
+@property (nonatomic, assign, readonly) BOOL createsInstallIcon;
+
+/*!
+ @property      createsUninstallIcon
+ @abstract      Specifies if the (static) uninstall icon is created.
+ @discussion    The value of this property is a boolean.
+*/
+@property (nonatomic, assign, readonly) BOOL createsUninstallIcon;
+
+/*!
+ @property      createsAnimatedUninstallIcon
+ @abstract      Specifies if the animated uninstall icon is created.
+ @discussion    The value of this property is a boolean.
+*/
+@property (nonatomic, assign, readonly) BOOL createsAnimatedUninstallIcon;
+
+/*!
+ @property      appliesIconShape
+ @abstract      Specifies if images (other than application icons) are rendered in the icon shape.
+ @discussion    The value of this property is a boolean.
+*/
+@property (nonatomic, assign, readonly) BOOL appliesIconShape;
+
+/*!
+ @property      usesOldIconShape
+ @abstract      Specifies if the old icon shape is used.
+ @discussion    The value of this property is a boolean.
+*/
+@property (nonatomic, assign, readonly) BOOL usesOldIconShape;
+
+/*!
+ @property      drawsBannerInIconShape
+ @abstract      Specifies if the banner is drawn inside of the icon shape.
+ @discussion    The value of this property is a boolean.
+*/
+@property (nonatomic, assign, readonly) BOOL drawsBannerInIconShape;
+
+/*!
+ @property      bannerName
+ @abstract      The name of the default banner.
+ @discussion    The value of this property is a NSString object. May be nil.
+*/
+@property (nonatomic, strong, readonly) NSString *bannerName;
+
+/*!
+ @property      bannerAttributes
+ @abstract      The text and the attributes of the default banner.
+ @discussion    The value of this property is a NSAttributedString object. May be nil.
+*/
+@property (nonatomic, strong, readonly) NSAttributedString *bannerAttributes;
+
+/*!
+ @property      bannerPosition
+ @abstract      The position of the banner.
+ @discussion    The value of this property is of type MTBannerPosition.
+*/
+@property (nonatomic, assign, readonly) MTBannerPosition bannerPosition;
+
+/*!
+ @property      bannerTextMargin
+ @abstract      The margin of the banner's text.
+ @discussion    The value of this property is a float.
+*/
+@property (nonatomic, assign, readonly) CGFloat bannerTextMargin;
+
+/*!
+ @property      bannerAngle
+ @abstract      The angle of the banner.
+ @discussion    The value of this property is a float.
+*/
+@property (nonatomic, assign, readonly) CGFloat bannerAngle;
+
+/*!
+ @property      bannerHeight
+ @abstract      The height of the banner.
+ @discussion    The value of this property is a float.
+*/
+@property (nonatomic, assign, readonly) CGFloat bannerHeight;
+
+/*!
+ @property      bannerMargin
+ @abstract      The margin of the banner.
+ @discussion    The value of this property is a float.
+*/
+@property (nonatomic, assign, readonly) CGFloat bannerMargin;
+
+/*!
+ @property      deleteBadgeImage
+ @abstract      The custom delete badge.
+ @discussion    The value of this property is a NSImage object. May be nil.
+*/
+@property (nonatomic, strong, readonly) NSImage *deleteBadgeImage;
+
+/*!
+ @property      badgeSize
+ @abstract      The size of the custom delete badge.
+ @discussion    The value of this property is a float.
+*/
+@property (nonatomic, assign, readonly) CGFloat badgeSize;
+
+/*!
+ @property      badgeMargin
+ @abstract      The margin of the custom delete badge.
+ @discussion    The value of this property is a float.
+*/
+@property (nonatomic, assign, readonly) CGFloat badgeMargin;
+
+/*!
+ @property      badgePosition
+ @abstract      The position of the custom delete badge.
+ @discussion    The value of this property is of type MTBadgePosition.
+*/
+@property (nonatomic, assign, readonly) MTBadgePosition badgePosition;
+
+/*!
+ @property      badgeShowsShadow
+ @abstract      Specifies if the custom delete badge has a shadow.
+ @discussion    The value of this property is a boolean.
+*/
+@property (nonatomic, assign, readonly) BOOL badgeShowsShadow;
+
+/*!
+ @property      badgeShadowRadius
+ @abstract      The blur radius of the custom delete badge's shadow.
+ @discussion    The value of this property is a float.
+*/
+@property (nonatomic, assign, readonly) CGFloat badgeShadowRadius;
+
+/*!
+ @property      badgeShadowOffset
+ @abstract      The offset of the custom delete badge's shadow.
+ @discussion    The value of this property is a float.
+*/
+@property (nonatomic, assign, readonly) CGFloat badgeShadowOffset;
+
+/*!
+ @property      badgeShadowAngle
+ @abstract      The angle of the custom delete badge's shadow.
+ @discussion    The value of this property is a float.
+*/
+@property (nonatomic, assign, readonly) CGFloat badgeShadowAngle;
+
+/*!
+ @property      badgeShadowColor
+ @abstract      The color of the custom delete badge's shadow.
+ @discussion    The value of this property is a NSColor object.
+*/
+@property (nonatomic, strong, readonly) NSColor *badgeShadowColor;
+
+/*!
+ @property      usesFileNamePrefix
+ @abstract      Specifies if the file names get a prefix.
+ @discussion    The value of this property is a boolean.
+*/
+@property (nonatomic, assign, readonly) BOOL usesFileNamePrefix;
+
+/*!
+ @property      fileNamePrefix
+ @abstract      The user defined file name prefix.
+ @discussion    The value of this property is a NSString object. If nil and usesFileNamePrefix is YES, the name of
+                the source file should be used as prefix.
+*/
+@property (nonatomic, strong, readonly) NSString *fileNamePrefix;
+
+/*!
+ @method        init
+ @abstract      Initialize a MTRenderPreset object with the default settings.
+ @discussion    Returns an initialized MTRenderPreset object.
+*/
+- (instancetype)init;
+
+/*!
+ @method        initWithSettings:
+ @abstract      Compile a MTRenderPreset object from the given settings.
+ @param         settings A dictionary containing the settings, keyed by their NSUserDefaults keys. Missing settings
+                get their default values. If the dictionary specifies that the app extension uses the default
+                settings, only the default values are used.
+ @discussion    Returns an initialized MTRenderPreset object.
+*/
+- (instancetype)initWithSettings:(NSDictionary*)settings NS_DESIGNATED_INITIALIZER;
+
+/*!
+ @method        presetWithUserDefaults:
+ @abstract      Get the render preset for the given user defaults.
+ @param         userDefaults The user defaults containing the settings.
+ @discussion    Returns a MTRenderPreset object. The preset is compiled once and returned again until one of the
+                settings it depends on has been changed.
+*/
++ (instancetype)presetWithUserDefaults:(NSUserDefaults*)userDefaults;
+
+/*!
+ @method        presetWithUserDefaults:savedBanner:
+ @abstract      Get a render preset for the given user defaults that uses the given saved banner.
+ @param         userDefaults The user defaults containing the settings.
+ @param         bannerDict A dictionary of the user defaults' saved banners.
+ @discussion    Returns a MTRenderPreset object. Other than presetWithUserDefaults:, the preset is always compiled
+                from the app's settings, even if the app extension has been configured to use the default settings.
+*/
++ (instancetype)presetWithUserDefaults:(NSUserDefaults*)userDefaults savedBanner:(NSDictionary*)bannerDict;
+
+/*!
+ @method        presetsWithUserDefaults:
+ @abstract      Get a render preset for each of the saved banners of the given user defaults.
+ @param         userDefaults The user defaults containing the settings.
+ @discussion    Returns an array of MTRenderPreset objects, in the order of the saved banners.
+*/
++ (NSArray*)presetsWithUserDefaults:(NSUserDefaults*)userDefaults;
+
+/*!
+ @method        savedBannerDictionary
+ @abstract      Get the banner of the render preset in the format of the app's saved banners.
+ @discussion    Returns a NSDictionary object or nil, if the preset does not contain a banner. A banner exported
+                with presetWithUserDefaults:savedBanner: is returned with exactly the same values.
+*/
+- (NSDictionary*)savedBannerDictionary;
+
+/*!
+ @method        presetWithData:error:
+ @abstract      Load a render preset from the contents of a preset file.
+ @param         data The contents of a preset file.
+ @param         error A reference to a NSError object that contains a detailed error message if an error occurred. May be nil.
+ @discussion    Returns a MTRenderPreset object or nil if an error occurred.
+*/
++ (instancetype)presetWithData:(NSData*)data error:(NSError**)error;
+
+/*!
+ @method        presetWithContentsOfURL:error:
+ @abstract      Load a render preset from a file.
+ @param         url The url of a file created with writeToURL:error:.
+ @param         error A reference to a NSError object that contains a detailed error message if an error occurred. May be nil.
+ @discussion    Returns a MTRenderPreset object or nil if an error occurred.
+*/
++ (instancetype)presetWithContentsOfURL:(NSURL*)url error:(NSError**)error;
+
+/*!
+ @method        presetData
+ @abstract      Get the contents of a preset file for the render preset.
+ @discussion    Returns a NSData object.
+*/
+- (NSData*)presetData;
+
+/*!
+ @method        writeToURL:error:
+ @abstract      Write the render preset to a file.
+ @param         url The url of the file.
+ @param         error A reference to a NSError object that contains a detailed error message if an error occurred. May be nil.
+ @discussion    Returns YES if the file has been written successfully, otherwise returns NO.
+*/
+- (BOOL)writeToURL:(NSURL*)url error:(NSError**)error;
+
+@end
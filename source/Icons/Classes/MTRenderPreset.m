@@ -0,0 +1,613 @@
+/*
+    MTRenderPreset.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTRenderPreset.h"
+#import "MTColor.h"
+#import "Constants.h"
+#import <os/log.h>
+
+#define kMTRenderPresetMagic                0x5052544D  // "MTRP"
+#define kMTRenderPresetMajorVersion         1
+#define kMTRenderPresetMinorVersion         0
+#define kMTRenderPresetNoBlob               UINT32_MAX
+#define kMTRenderPresetDataKey              @"PresetData"
+
+typedef NS_OPTIONS(uint32_t, MTRenderPresetFlags) {
+    MTRenderPresetFlagAutoImageInset        = 1 << 0,
+    MTRenderPresetFlagInstallIcon           = 1 << 1,
+    MTRenderPresetFlagUninstallIcon         = 1 << 2,
+    MTRenderPresetFlagAnimatedUninstallIcon = 1 << 3,
+    MTRenderPresetFlagIconShape             = 1 << 4,
+    MTRenderPresetFlagOldIconShape          = 1 << 5,
+    MTRenderPresetFlagBannerInIconShape     = 1 << 6,
+    MTRenderPresetFlagBadgeShadow           = 1 << 7,
+    MTRenderPresetFlagFileNamePrefix        = 1 << 8
+};
+
+// the fixed-size part of a preset file. all values are
+// little-endian, floats are stored as the bits of a double.
+// a new minor version may only append fields to the header
+// (and blobs to the file), so older versions can still read
+// the file. a new major version is not compatible.
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t  majorVersion;
+    uint8_t  minorVersion;
+    uint16_t headerLength;
+    uint32_t flags;
+    uint32_t outputSize;
+    int32_t  bannerPosition;
+    int32_t  badgePosition;
+    int64_t  badgeShadowColor;
+    uint64_t imageInset;
+    uint64_t animationDuration;
+    uint64_t bannerTextMargin;
+    uint64_t bannerAngle;
+    uint64_t bannerHeight;
+    uint64_t bannerMargin;
+    uint64_t badgeSize;
+    uint64_t badgeMargin;
+    uint64_t badgeShadowRadius;
+    uint64_t badgeShadowOffset;
+    uint64_t badgeShadowAngle;
+} MTRenderPresetHeader;
+
+@interface MTRenderPreset ()
+@property (nonatomic, strong, readwrite) NSData *bannerData;
+@property (nonatomic, strong, readwrite) NSData *deleteBadgeData;
+@property (nonatomic, assign) NSInteger shadowColorValue;
+@end
+
+@implementation MTRenderPreset
+{
+    dispatch_once_t _compileToken;
+}
+
+@synthesize bannerAttributes = _bannerAttributes;
+@synthesize deleteBadgeImage = _deleteBadgeImage;
+@synthesize badgeShadowColor = _badgeShadowColor;
+
+static id settingForKey(NSDictionary *settings, NSString *key, Class valueClass)
+{
+    id value = [settings objectForKey:key];
+    return ([value isKindOfClass:valueClass]) ? value : nil;
+}
+
+static BOOL boolSetting(NSDictionary *settings, NSString *key, BOOL defaultValue)
+{
+    NSNumber *value = settingForKey(settings, key, [NSNumber class]);
+    return (value) ? [value boolValue] : defaultValue;
+}
+
+static CGFloat floatSetting(NSDictionary *settings, NSString *key, CGFloat defaultValue, CGFloat minValue, CGFloat maxValue)
+{
+    NSNumber *value = settingForKey(settings, key, [NSNumber class]);
+    return (value) ? fmin(fmax([value doubleValue], minValue), maxValue) : defaultValue;
+}
+
+static NSInteger integerSetting(NSDictionary *settings, NSString *key, NSInteger defaultValue, NSInteger minValue, NSInteger maxValue)
+{
+    NSNumber *value = settingForKey(settings, key, [NSNumber class]);
+    return (value && [value integerValue] >= minValue && [value integerValue] <= maxValue) ? [value integerValue] : defaultValue;
+}
+
+static uint64_t storeDouble(double value)
+{
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+
+    return OSSwapHostToLittleInt64(bits);
+}
+
+static double loadDouble(uint64_t storedValue, double minValue, double maxValue)
+{
+    double value = 0;
+    uint64_t bits = OSSwapLittleToHostInt64(storedValue);
+    memcpy(&value, &bits, sizeof(value));
+
+    return fmin(fmax(value, minValue), maxValue);
+}
+
+static int32_t loadInteger(int32_t storedValue, int32_t minValue, int32_t maxValue, int32_t defaultValue)
+{
+    int32_t value = (int32_t)OSSwapLittleToHostInt32(storedValue);
+    return (value >= minValue && value <= maxValue) ? value : defaultValue;
+}
+
+static void appendBlob(NSMutableData *data, NSData *blob)
+{
+    uint32_t blobLength = OSSwapHostToLittleInt32((blob) ? (uint32_t)[blob length] : kMTRenderPresetNoBlob);
+    [data appendBytes:&blobLength length:sizeof(blobLength)];
+    if (blob) { [data appendData:blob]; }
+}
+
+static BOOL readBlob(NSData *data, NSUInteger *offset, NSData **outBlob)
+{
+    BOOL success = NO;
+    uint32_t blobLength = 0;
+
+    if (*offset <= [data length] && [data length] - *offset >= sizeof(blobLength)) {
+
+        [data getBytes:&blobLength range:NSMakeRange(*offset, sizeof(blobLength))];
+        blobLength = OSSwapLittleToHostInt32(blobLength);
+        *offset += sizeof(blobLength);
+
+        if (blobLength == kMTRenderPresetNoBlob) {
+
+            *outBlob = nil;
+            success = YES;
+
+        } else if ([data length] - *offset >= blobLength) {
+
+            *outBlob = [data subdataWithRange:NSMakeRange(*offset, blobLength)];
+            *offset += blobLength;
+            success = YES;
+        }
+    }
+
+    return success;
+}
+
+static NSString *stringWithBlob(NSData *blob)
+{
+    return (blob) ? [[NSString alloc] initWithData:blob encoding:NSUTF8StringEncoding] : nil;
+}
+
++ (BOOL)supportsSecureCoding
+{
+    return YES;
+}
+
++ (NSDictionary*)settingsWithUserDefaults:(NSUserDefaults*)userDefaults
+{
+    NSMutableDictionary *settings = [NSMutableDictionary dictionary];
+
+    for (NSString *key in [self settingsKeys]) {
+
+        id value = [userDefaults objectForKey:key];
+        if (value) { [settings setObject:value forKey:key]; }
+    }
+
+    return settings;
+}
+
++ (NSArray*)settingsKeys
+{
+    return [NSArray arrayWithObjects:
+            kMTDefaultsExtensionDefaultSettingsKey,
+            kMTDefaultsAutoOutputSizeKey,
+            kMTDefaultsOutputSizeKey,
+            kMTDefaultsAutoImageSizeKey,
+            kMTDefaultsImageSizeAdjustmentKey,
+            kMTDefaultsAnimationDurationKey,
+            kMTDefaultsSaveInstallIconKey,
+            kMTDefaultsSaveUninstallIconKey,
+            kMTDefaultsSaveAnimatedUninstallIconKey,
+            kMTDefaultsRenderImagesInIconShapeKey,
+            kMTDefaultsUseOldIconShapeKey,
+            kMTDefaultsDrawBannerInIconShapeKey,
+            kMTDefaultsSavedBannersKey,
+            kMTDefaultsDeleteBadgeSFSymbolKey,
+            kMTDefaultsDeleteBadgeIconBookmarkKey,
+            kMTDefaultsBadgeIconSizeKey,
+            kMTDefaultsBadgeIconMarginKey,
+            kMTDefaultsBadgePositionDefaultKey,
+            kMTDefaultsBadgeIconAddShadowKey,
+            kMTDefaultsBadgeIconShadowRadiusKey,
+            kMTDefaultsBadgeIconShadowOffsetKey,
+            kMTDefaultsBadgeIconShadowAngleKey,
+            kMTDefaultsBadgeIconShadowColorKey,
+            kMTDefaultsUsePrefixKey,
+            kMTDefaultsUserDefinedPrefixKey,
+            nil
+    ];
+}
+
+- (instancetype)init
+{
+    return [self initWithSettings:nil];
+}
+
+- (instancetype)initWithSettings:(NSDictionary*)settings
+{
+    self = [super init];
+
+    if (self) {
+
+        // the old icon shape is a general setting, so it's
+        // also used if the extension uses the default settings
+        _usesOldIconShape = boolSetting(settings, kMTDefaultsUseOldIconShapeKey, NO);
+        if (boolSetting(settings, kMTDefaultsExtensionDefaultSettingsKey, NO)) { settings = nil; }
+
+        // output size
+        if (!boolSetting(settings, kMTDefaultsAutoOutputSizeKey, YES)) {
+
+            NSNumber *outputSize = settingForKey(settings, kMTDefaultsOutputSizeKey, [NSNumber class]);
+            _outputSize = ([kMTOutputSizes containsObject:outputSize]) ? [outputSize unsignedIntegerValue] : kMTOutputSizeDefault;
+        }
+
+        // icons
+        _createsInstallIcon = boolSetting(settings, kMTDefaultsSaveInstallIconKey, YES);
+        _createsUninstallIcon = boolSetting(settings, kMTDefaultsSaveUninstallIconKey, YES);
+        _createsAnimatedUninstallIcon = boolSetting(settings, kMTDefaultsSaveAnimatedUninstallIconKey, YES);
+        _autoImageInset = boolSetting(settings, kMTDefaultsAutoImageSizeKey, YES);
+        _imageInset = floatSetting(settings, kMTDefaultsImageSizeAdjustmentKey, 0, kMTImageInsetMin, kMTImageInsetMax);
+        _animationDuration = floatSetting(settings, kMTDefaultsAnimationDurationKey, kMTAnimationDurationDefault, kMTAnimationDurationMin, kMTAnimationDurationMax);
+        _appliesIconShape = boolSetting(settings, kMTDefaultsRenderImagesInIconShapeKey, NO);
+        _drawsBannerInIconShape = boolSetting(settings, kMTDefaultsDrawBannerInIconShapeKey, NO);
+
+        // banner
+        _bannerTextMargin = kMTBannerTextMarginDefault;
+        _bannerAngle = kMTBannerAngleDefault;
+        _bannerHeight = kMTBannerHeightDefault;
+        _bannerMargin = kMTBannerMarginDefault;
+
+        for (NSDictionary *bannerDict in settingForKey(settings, kMTDefaultsSavedBannersKey, [NSArray class])) {
+
+            if ([bannerDict isKindOfClass:[NSDictionary class]] && boolSetting(bannerDict, kMTDefaultsBannerIsDefaultKey, NO)) {
+
+                // If the banner was saved with an older version of the application that does
+                // not support one or more of the following attributes, we will use the default
+                // values to make sure the banner looks the same as in the old version.
+                _bannerName = settingForKey(bannerDict, kMTDefaultsBannerNameKey, [NSString class]);
+                _bannerData = settingForKey(bannerDict, kMTDefaultsBannerDataKey, [NSData class]);
+                _bannerPosition = (MTBannerPosition)integerSetting(bannerDict, kMTDefaultsBannerPositionKey, MTBannerPositionTopLeft, MTBannerPositionTopLeft, MTBannerPositionBottom);
+                _bannerTextMargin = floatSetting(bannerDict, kMTDefaultsBannerTextMarginKey, kMTBannerTextMarginDefault, kMTBannerTextMarginMin, kMTBannerTextMarginMax);
+                _bannerAngle = floatSetting(bannerDict, kMTDefaultsBannerAngleKey, kMTBannerAngleDefault, kMTBannerAngleMin, kMTBannerAngleMax);
+                _bannerHeight = floatSetting(bannerDict, kMTDefaultsBannerHeightKey, kMTBannerHeightDefault, kMTBannerHeightMin, kMTBannerHeightMax);
+                _bannerMargin = floatSetting(bannerDict, kMTDefaultsBannerMarginKey, kMTBannerMarginDefault, kMTBannerMarginMin, kMTBannerMarginMax);
+                break;
+            }
+        }
+
+        // delete badge
+        _deleteBadgeData = settingForKey(settings, kMTDefaultsDeleteBadgeSFSymbolKey, [NSData class]);
+        NSData *bookmarkData = settingForKey(settings, kMTDefaultsDeleteBadgeIconBookmarkKey, [NSData class]);
+
+        if (!_deleteBadgeData && bookmarkData) {
+
+            BOOL stale = NO;
+            NSError *error = nil;
+
+            NSURL *deleteBadgeURL = [NSURL URLByResolvingBookmarkData:bookmarkData
+                                                              options:0
+                                                        relativeToURL:nil
+                                                  bookmarkDataIsStale:&stale
+                                                                error:&error
+            ];
+
+            if (deleteBadgeURL) {
+
+                if ([deleteBadgeURL startAccessingSecurityScopedResource]) {
+
+                    _deleteBadgeData = [NSData dataWithContentsOfURL:deleteBadgeURL];
+                    [deleteBadgeURL stopAccessingSecurityScopedResource];
+
+                } else {
+                    os_log_error(OS_LOG_DEFAULT, "SAPCorp: Failed to access delete badge url %{public}@", deleteBadgeURL);
+                }
+
+            } else {
+                os_log_error(OS_LOG_DEFAULT, "SAPCorp: Failed to get delete badge url: %{public}@", error);
+            }
+        }
+
+        _badgeSize = floatSetting(settings, kMTDefaultsBadgeIconSizeKey, kMTBadgeIconSizeDefault, kMTBadgeIconSizeMin, kMTBadgeIconSizeMax);
+        _badgeMargin = floatSetting(settings, kMTDefaultsBadgeIconMarginKey, kMTBadgeIconMarginDefault, kMTBadgeIconMarginMin, kMTBadgeIconMarginMax);
+        _badgePosition = (MTBadgePosition)integerSetting(settings, kMTDefaultsBadgePositionDefaultKey, MTBadgePositionTopLeft, MTBadgePositionTopLeft, MTBadgePositionBottomRight);
+        _badgeShowsShadow = boolSetting(settings, kMTDefaultsBadgeIconAddShadowKey, YES);
+        _badgeShadowRadius = floatSetting(settings, kMTDefaultsBadgeIconShadowRadiusKey, kMTBadgeShadowRadiusDefault, kMTBadgeShadowRadiusMin, kMTBadgeShadowRadiusMax);
+        _badgeShadowOffset = floatSetting(settings, kMTDefaultsBadgeIconShadowOffsetKey, kMTBadgeShadowOffsetDefault, kMTBadgeShadowOffsetMin, kMTBadgeShadowOffsetMax);
+        _badgeShadowAngle = floatSetting(settings, kMTDefaultsBadgeIconShadowAngleKey, kMTBadgeShadowAngleDefault, kMTBadgeShadowAngleMin, kMTBadgeShadowAngleMax);
+
+        NSNumber *shadowColor = settingForKey(settings, kMTDefaultsBadgeIconShadowColorKey, [NSNumber class]);
+        _shadowColorValue = (shadowColor) ? [shadowColor integerValue] : kMTBadgeShadowColorDefault;
+
+        // file name prefix
+        _usesFileNamePrefix = boolSetting(settings, kMTDefaultsUsePrefixKey, NO);
+        _fileNamePrefix = settingForKey(settings, kMTDefaultsUserDefinedPrefixKey, [NSString class]);
+    }
+
+    return self;
+}
+
+- (void)compile
+{
+    // the banner and the badge are parsed only once for all
+    // renders and not at all if a preset is just loaded
+    dispatch_once(&_compileToken, ^{
+
+        self->_bannerAttributes = (self->_bannerData) ? [[NSAttributedString alloc] initWithRTF:self->_bannerData documentAttributes:nil] : nil;
+        self->_badgeShadowColor = [NSColor colorFromInteger:self->_shadowColorValue];
+
+        NSImage *deleteBadgeImage = (self->_deleteBadgeData) ? [[NSImage alloc] initWithData:self->_deleteBadgeData] : nil;
+        self->_deleteBadgeImage = ([deleteBadgeImage isValid]) ? deleteBadgeImage : nil;
+    });
+}
+
+- (NSAttributedString*)bannerAttributes
+{
+    [self compile];
+    return _bannerAttributes;
+}
+
+- (NSImage*)deleteBadgeImage
+{
+    [self compile];
+    return _deleteBadgeImage;
+}
+
+- (NSColor*)badgeShadowColor
+{
+    [self compile];
+    return _badgeShadowColor;
+}
+
++ (instancetype)presetWithUserDefaults:(NSUserDefaults*)userDefaults
+{
+    static NSDictionary *cachedSettings = nil;
+    static MTRenderPreset *cachedPreset = nil;
+
+    // reading the settings is cheap compared to parsing the banner
+    // and loading the badge, so we compile the preset again only
+    // if one of the settings has been changed
+    NSDictionary *settings = [self settingsWithUserDefaults:userDefaults];
+    MTRenderPreset *preset = nil;
+
+    @synchronized (self) {
+
+        if (!cachedPreset || ![cachedSettings isEqualToDictionary:settings]) {
+
+            cachedPreset = [[MTRenderPreset alloc] initWithSettings:settings];
+            cachedSettings = settings;
+        }
+
+        preset = cachedPreset;
+    }
+
+    return preset;
+}
+
++ (instancetype)presetWithSettings:(NSDictionary*)settings savedBanner:(NSDictionary*)bannerDict
+{
+    NSMutableDictionary *bannerSettings = [NSMutableDictionary dictionaryWithDictionary:settings];
+    [bannerSettings removeObjectForKey:kMTDefaultsExtensionDefaultSettingsKey];
+
+    NSMutableDictionary *defaultBanner = [NSMutableDictionary dictionaryWithDictionary:bannerDict];
+    [defaultBanner setObject:[NSNumber numberWithBool:YES] forKey:kMTDefaultsBannerIsDefaultKey];
+    [bannerSettings setObject:[NSArray arrayWithObject:defaultBanner] forKey:kMTDefaultsSavedBannersKey];
+
+    return [[MTRenderPreset alloc] initWithSettings:bannerSettings];
+}
+
++ (instancetype)presetWithUserDefaults:(NSUserDefaults*)userDefaults savedBanner:(NSDictionary*)bannerDict
+{
+    return [self presetWithSettings:[self settingsWithUserDefaults:userDefaults] savedBanner:bannerDict];
+}
+
++ (NSArray*)presetsWithUserDefaults:(NSUserDefaults*)userDefaults
+{
+    NSMutableArray *presets = [NSMutableArray array];
+    NSDictionary *settings = [self settingsWithUserDefaults:userDefaults];
+
+    for (NSDictionary *bannerDict in settingForKey(settings, kMTDefaultsSavedBannersKey, [NSArray class])) {
+
+        if ([bannerDict isKindOfClass:[NSDictionary class]]) {
+            [presets addObject:[self presetWithSettings:settings savedBanner:bannerDict]];
+        }
+    }
+
+    return presets;
+}
+
+- (NSDictionary*)savedBannerDictionary
+{
+    NSMutableDictionary *bannerDict = nil;
+
+    if (_bannerData) {
+
+        // the app stores the banner geometry as floats, so
+        // we do the same to get exactly the same dictionary
+        bannerDict = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+                      _bannerData, kMTDefaultsBannerDataKey,
+                      [NSNumber numberWithInteger:_bannerPosition], kMTDefaultsBannerPositionKey,
+                      [NSNumber numberWithFloat:_bannerTextMargin], kMTDefaultsBannerTextMarginKey,
+                      [NSNumber numberWithFloat:_bannerAngle], kMTDefaultsBannerAngleKey,
+                      [NSNumber numberWithFloat:_bannerHeight], kMTDefaultsBannerHeightKey,
+                      [NSNumber numberWithFloat:_bannerMargin], kMTDefaultsBannerMarginKey,
+                      nil
+        ];
+
+        if (_bannerName) { [bannerDict setObject:_bannerName forKey:kMTDefaultsBannerNameKey]; }
+    }
+
+    return bannerDict;
+}
+
+- (instancetype)copyWithZone:(NSZone *)zone
+{
+    // render presets are immutable
+    return self;
+}
+
+#pragma mark Preset files
+
+- (NSData*)presetData
+{
+    MTRenderPresetFlags flags = 0;
+    if (_autoImageInset) { flags |= MTRenderPresetFlagAutoImageInset; }
+    if (_createsInstallIcon) { flags |= MTRenderPresetFlagInstallIcon; }
+    if (_createsUninstallIcon) { flags |= MTRenderPresetFlagUninstallIcon; }
+    if (_createsAnimatedUninstallIcon) { flags |= MTRenderPresetFlagAnimatedUninstallIcon; }
+    if (_appliesIconShape) { flags |= MTRenderPresetFlagIconShape; }
+    if (_usesOldIconShape) { flags |= MTRenderPresetFlagOldIconShape; }
+    if (_drawsBannerInIconShape) { flags |= MTRenderPresetFlagBannerInIconShape; }
+    if (_badgeShowsShadow) { flags |= MTRenderPresetFlagBadgeShadow; }
+    if (_usesFileNamePrefix) { flags |= MTRenderPresetFlagFileNamePrefix; }
+
+    MTRenderPresetHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = OSSwapHostToLittleInt32(kMTRenderPresetMagic);
+    header.majorVersion = kMTRenderPresetMajorVersion;
+    header.minorVersion = kMTRenderPresetMinorVersion;
+    header.headerLength = OSSwapHostToLittleInt16(sizeof(header));
+    header.flags = OSSwapHostToLittleInt32(flags);
+    header.outputSize = OSSwapHostToLittleInt32((uint32_t)_outputSize);
+    header.bannerPosition = OSSwapHostToLittleInt32((int32_t)_bannerPosition);
+    header.badgePosition = OSSwapHostToLittleInt32((int32_t)_badgePosition);
+    header.badgeShadowColor = OSSwapHostToLittleInt64((int64_t)_shadowColorValue);
+    header.imageInset = storeDouble(_imageInset);
+    header.animationDuration = storeDouble(_animationDuration);
+    header.bannerTextMargin = storeDouble(_bannerTextMargin);
+    header.bannerAngle = storeDouble(_bannerAngle);
+    header.bannerHeight = storeDouble(_bannerHeight);
+    header.bannerMargin = storeDouble(_bannerMargin);
+    header.badgeSize = storeDouble(_badgeSize);
+    header.badgeMargin = storeDouble(_badgeMargin);
+    header.badgeShadowRadius = storeDouble(_badgeShadowRadius);
+    header.badgeShadowOffset = storeDouble(_badgeShadowOffset);
+    header.badgeShadowAngle = storeDouble(_badgeShadowAngle);
+
+    NSMutableData *presetData = [NSMutableData dataWithBytes:&header length:sizeof(header)];
+    appendBlob(presetData, [_bannerName dataUsingEncoding:NSUTF8StringEncoding]);
+    appendBlob(presetData, _bannerData);
+    appendBlob(presetData, _deleteBadgeData);
+    appendBlob(presetData, [_fileNamePrefix dataUsingEncoding:NSUTF8StringEncoding]);
+
+    return presetData;
+}
+
+- (BOOL)readPresetData:(NSData*)data error:(NSError**)error
+{
+    BOOL success = NO;
+
+    MTRenderPresetHeader header;
+    memset(&header, 0, sizeof(header));
+    [data getBytes:&header length:sizeof(header)];
+
+    // files written by a newer minor version of the app may have
+    // a longer header, we just skip the fields we do not know
+    NSUInteger headerLength = OSSwapLittleToHostInt16(header.headerLength);
+
+    if ([data length] >= sizeof(header) &&
+        OSSwapLittleToHostInt32(header.magic) == kMTRenderPresetMagic &&
+        header.majorVersion == kMTRenderPresetMajorVersion &&
+        headerLength >= sizeof(header) && headerLength <= [data length]) {
+
+        NSData *bannerName = nil, *bannerData = nil, *deleteBadgeData = nil, *fileNamePrefix = nil;
+        NSUInteger offset = headerLength;
+
+        if (readBlob(data, &offset, &bannerName) &&
+            readBlob(data, &offset, &bannerData) &&
+            readBlob(data, &offset, &deleteBadgeData) &&
+            readBlob(data, &offset, &fileNamePrefix)) {
+
+            MTRenderPresetFlags flags = OSSwapLittleToHostInt32(header.flags);
+            _autoImageInset = (flags & MTRenderPresetFlagAutoImageInset) != 0;
+            _createsInstallIcon = (flags & MTRenderPresetFlagInstallIcon) != 0;
+            _createsUninstallIcon = (flags & MTRenderPresetFlagUninstallIcon) != 0;
+            _createsAnimatedUninstallIcon = (flags & MTRenderPresetFlagAnimatedUninstallIcon) != 0;
+            _appliesIconShape = (flags & MTRenderPresetFlagIconShape) != 0;
+            _usesOldIconShape = (flags & MTRenderPresetFlagOldIconShape) != 0;
+            _drawsBannerInIconShape = (flags & MTRenderPresetFlagBannerInIconShape) != 0;
+            _badgeShowsShadow = (flags & MTRenderPresetFlagBadgeShadow) != 0;
+            _usesFileNamePrefix = (flags & MTRenderPresetFlagFileNamePrefix) != 0;
+
+            NSUInteger outputSize = OSSwapLittleToHostInt32(header.outputSize);
+            _outputSize = ([kMTOutputSizes containsObject:[NSNumber numberWithUnsignedInteger:outputSize]]) ? outputSize : 0;
+            _bannerPosition = (MTBannerPosition)loadInteger(header.bannerPosition, MTBannerPositionTopLeft, MTBannerPositionBottom, MTBannerPositionTopLeft);
+            _badgePosition = (MTBadgePosition)loadInteger(header.badgePosition, MTBadgePositionTopLeft, MTBadgePositionBottomRight, MTBadgePositionTopLeft);
+            _shadowColorValue = (NSInteger)OSSwapLittleToHostInt64(header.badgeShadowColor);
+
+            _imageInset = loadDouble(header.imageInset, kMTImageInsetMin, kMTImageInsetMax);
+            _animationDuration = loadDouble(header.animationDuration, kMTAnimationDurationMin, kMTAnimationDurationMax);
+            _bannerTextMargin = loadDouble(header.bannerTextMargin, kMTBannerTextMarginMin, kMTBannerTextMarginMax);
+            _bannerAngle = loadDouble(header.bannerAngle, kMTBannerAngleMin, kMTBannerAngleMax);
+            _bannerHeight = loadDouble(header.bannerHeight, kMTBannerHeightMin, kMTBannerHeightMax);
+            _bannerMargin = loadDouble(header.bannerMargin, kMTBannerMarginMin, kMTBannerMarginMax);
+            _badgeSize = loadDouble(header.badgeSize, kMTBadgeIconSizeMin, kMTBadgeIconSizeMax);
+            _badgeMargin = loadDouble(header.badgeMargin, kMTBadgeIconMarginMin, kMTBadgeIconMarginMax);
+            _badgeShadowRadius = loadDouble(header.badgeShadowRadius, kMTBadgeShadowRadiusMin, kMTBadgeShadowRadiusMax);
+            _badgeShadowOffset = loadDouble(header.badgeShadowOffset, kMTBadgeShadowOffsetMin, kMTBadgeShadowOffsetMax);
+            _badgeShadowAngle = loadDouble(header.badgeShadowAngle, kMTBadgeShadowAngleMin, kMTBadgeShadowAngleMax);
+
+            _bannerName = stringWithBlob(bannerName);
+            _bannerData = bannerData;
+            _deleteBadgeData = deleteBadgeData;
+            _fileNamePrefix = stringWithBlob(fileNamePrefix);
+
+            success = YES;
+        }
+    }
+
+    if (!success && error) { *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadCorruptFileError userInfo:nil]; }
+
+    return success;
+}
+
++ (instancetype)presetWithData:(NSData*)data error:(NSError**)error
+{
+    MTRenderPreset *preset = [[MTRenderPreset alloc] initWithSettings:nil];
+    if (![preset readPresetData:data error:error]) { preset = nil; }
+
+    return preset;
+}
+
++ (instancetype)presetWithContentsOfURL:(NSURL*)url error:(NSError**)error
+{
+    MTRenderPreset *preset = nil;
+
+    // preset files are mapped, so only the pages we
+    // actually read have to be loaded from disk
+    NSData *presetData = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:error];
+    if (presetData) { preset = [self presetWithData:presetData error:error]; }
+
+    return preset;
+}
+
+- (BOOL)writeToURL:(NSURL*)url error:(NSError**)error
+{
+    return [[self presetData] writeToURL:url options:NSDataWritingAtomic error:error];
+}
+
+#pragma mark NSSecureCoding
+
+- (instancetype)initWithCoder:(NSCoder *)coder
+{
+    self = [self initWithSettings:nil];
+
+    if (self) {
+
+        NSError *error = nil;
+        NSData *presetData = [coder decodeObjectOfClass:[NSData class] forKey:kMTRenderPresetDataKey];
+
+        if (![self readPresetData:presetData error:&error]) {
+
+            [coder failWithError:error];
+            return nil;
+        }
+    }
+
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder
+{
+    [coder encodeObject:[self presetData] forKey:kMTRenderPresetDataKey];
+}
+
+@end
@@ -0,0 +1,112 @@
+/*
+    MTTrace.h
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+#import <mach/mach_time.h>
+
+/*!
+ @typedef       MTTraceTimestamp
+ @abstract      The start time of a tracing span in mach absolute time units. A value of 0 means that
+                tracing was disabled when the span has been started.
+*/
+typedef uint64_t MTTraceTimestamp;
+
+/*!
+ @var           gMTTraceEnabled
+ @abstract      Specifies whether tracing is enabled. Do not modify this variable directly, use
+                MTTrace's setEnabled: method instead.
+*/
+extern volatile BOOL gMTTraceEnabled;
+
+/*!
+ @function      MTTraceRecordSpan
+ @abstract      Records a span with the given name that started at the given time and ends now.
+ @param         name A static C string with the name of the span (e.g. a string literal). The string is not copied.
+ @param         begin The timestamp returned by MTTraceBegin().
+ @discussion    Use MTTraceEnd() instead of calling this function directly.
+*/
+void MTTraceRecordSpan(const char *name, MTTraceTimestamp begin);
+
+/*!
+ @function      MTTraceBegin
+ @abstract      Starts a tracing span.
+ @discussion    Returns the current timestamp or 0, if tracing is disabled.
+*/
+static inline MTTraceTimestamp MTTraceBegin(void)
+{
+    return (gMTTraceEnabled) ? mach_absolute_time() : 0;
+}
+
+/*!
+ @function      MTTraceEnd
+ @abstract      Ends a tracing span that has been started with MTTraceBegin().
+ @param         name A static C string with the name of the span (e.g. a string literal).
+ @param         begin The timestamp returned by MTTraceBegin().
+*/
+static inline void MTTraceEnd(const char *name, MTTraceTimestamp begin)
+{
+    if (begin > 0) { MTTraceRecordSpan(name, begin); }
+}
+
+/*!
+ @class         MTTrace
+ @abstract      A class that collects timing information about the individual stages of the icon pipeline.
+ @discussion    Spans are recorded using the MTTraceBegin() and MTTraceEnd() functions. If tracing is disabled,
+                starting and ending a span costs no more than reading a global variable.
+*/
+
+@interface MTTrace : NSObject
+
+/*!
+ @method        setEnabled:
+ @abstract      Enable or disable tracing.
+ @param         enabled A boolean specifying if spans should be recorded.
+ */
++ (void)setEnabled:(BOOL)enabled;
+
+/*!
+ @method        isEnabled
+ @abstract      Get whether tracing is enabled.
+ @discussion    Returns YES if tracing is enabled, otherwise returns NO.
+ */
++ (BOOL)isEnabled;
+
+/*!
+ @method        reset
+ @abstract      Removes all recorded spans.
+ */
++ (void)reset;
+
+/*!
+ @method        writeTraceToFile:error:
+ @abstract      Write all recorded spans to the given file using the Chrome trace event format.
+ @param         path The path of the file to write to.
+ @param         error A pointer to a NSError object that contains the underlying error if the request failed.
+ @discussion    Returns YES if the file has been successfully written, otherwise returns NO. The file can be
+                opened with chrome://tracing or https://ui.perfetto.dev.
+ */
++ (BOOL)writeTraceToFile:(NSString*)path error:(NSError**)error;
+
+/*!
+ @method        statisticsSummary
+ @abstract      Get a per-stage summary of all recorded spans.
+ @discussion    Returns a NSString object containing a table with the number of calls and the total, mean,
+                minimum and maximum duration of every stage, sorted by total duration.
+ */
++ (NSString*)statisticsSummary;
+
+@end
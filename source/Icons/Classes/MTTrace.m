@@ -0,0 +1,211 @@
+/*
+    MTTrace.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTTrace.h"
+#import <os/lock.h>
+#import <pthread.h>
+
+typedef struct {
+    const char *name;
+    uint64_t threadID;
+    MTTraceTimestamp begin;
+    MTTraceTimestamp end;
+} MTTraceSpan;
+
+volatile BOOL gMTTraceEnabled = NO;
+
+static os_unfair_lock spanLock = OS_UNFAIR_LOCK_INIT;
+static MTTraceSpan *spans = NULL;
+static size_t spanCount = 0;
+static size_t spanCapacity = 0;
+static MTTraceTimestamp traceStart = 0;
+
+void MTTraceRecordSpan(const char *name, MTTraceTimestamp begin)
+{
+    MTTraceTimestamp end = mach_absolute_time();
+
+    uint64_t threadID = 0;
+    pthread_threadid_np(NULL, &threadID);
+
+    os_unfair_lock_lock(&spanLock);
+
+    if (spanCount == spanCapacity) {
+
+        size_t newCapacity = (spanCapacity > 0) ? spanCapacity * 2 : 1024;
+        MTTraceSpan *newSpans = realloc(spans, newCapacity * sizeof(MTTraceSpan));
+
+        if (newSpans) {
+            spans = newSpans;
+            spanCapacity = newCapacity;
+        }
+    }
+
+    if (spanCount < spanCapacity) {
+        spans[spanCount++] = (MTTraceSpan){ name, threadID, begin, end };
+    }
+
+    os_unfair_lock_unlock(&spanLock);
+}
+
+static double microsecondsWithTimestamp(MTTraceTimestamp timestamp)
+{
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) { mach_timebase_info(&timebase); }
+
+    return (double)timestamp * timebase.numer / timebase.denom / 1000.0;
+}
+
+@implementation MTTrace
+
++ (void)setEnabled:(BOOL)enabled
+{
+    if (enabled && traceStart == 0) { traceStart = mach_absolute_time(); }
+    gMTTraceEnabled = enabled;
+}
+
++ (BOOL)isEnabled
+{
+    return gMTTraceEnabled;
+}
+
++ (void)reset
+{
+    os_unfair_lock_lock(&spanLock);
+    spanCount = 0;
+    traceStart = mach_absolute_time();
+    os_unfair_lock_unlock(&spanLock);
+}
+
++ (NSData*)copySpans
+{
+    os_unfair_lock_lock(&spanLock);
+    NSData *spanData = [NSData dataWithBytes:spans length:spanCount * sizeof(MTTraceSpan)];
+    os_unfair_lock_unlock(&spanLock);
+
+    return spanData;
+}
+
++ (BOOL)writeTraceToFile:(NSString*)path error:(NSError**)error
+{
+    NSData *spanData = [self copySpans];
+    const MTTraceSpan *allSpans = [spanData bytes];
+    NSUInteger count = [spanData length] / sizeof(MTTraceSpan);
+
+    NSNumber *processID = [NSNumber numberWithInt:[[NSProcessInfo processInfo] processIdentifier]];
+    NSMutableArray *traceEvents = [NSMutableArray arrayWithCapacity:count];
+
+    for (NSUInteger i = 0; i < count; i++) {
+
+        MTTraceSpan span = allSpans[i];
+        MTTraceTimestamp begin = (span.begin > traceStart) ? span.begin - traceStart : 0;
+
+        NSDictionary *event = [NSDictionary dictionaryWithObjectsAndKeys:
+                               [NSString stringWithUTF8String:span.name], @"name",
+                               @"icons", @"cat",
+                               @"X", @"ph",
+                               [NSNumber numberWithDouble:microsecondsWithTimestamp(begin)], @"ts",
+                               [NSNumber numberWithDouble:microsecondsWithTimestamp(span.end - span.begin)], @"dur",
+                               processID, @"pid",
+                               [NSNumber numberWithUnsignedLongLong:span.threadID], @"tid",
+                               nil
+        ];
+
+        [traceEvents addObject:event];
+    }
+
+    NSDictionary *trace = [NSDictionary dictionaryWithObjectsAndKeys:
+                           traceEvents, @"traceEvents",
+                           @"ms", @"displayTimeUnit",
+                           nil
+    ];
+
+    BOOL success = NO;
+    NSData *jsonData = [NSJSONSerialization dataWithJSONObject:trace options:0 error:error];
+
+    if (jsonData) {
+
+        success = [jsonData writeToURL:[NSURL fileURLWithPath:path]
+                               options:NSDataWritingAtomic
+                                 error:error
+        ];
+    }
+
+    return success;
+}
+
++ (NSString*)statisticsSummary
+{
+    NSData *spanData = [self copySpans];
+    const MTTraceSpan *allSpans = [spanData bytes];
+    NSUInteger count = [spanData length] / sizeof(MTTraceSpan);
+
+    // aggregate the spans by name
+    NSMutableDictionary *stages = [NSMutableDictionary dictionary];
+
+    for (NSUInteger i = 0; i < count; i++) {
+
+        MTTraceSpan span = allSpans[i];
+        NSString *name = [NSString stringWithUTF8String:span.name];
+        double duration = microsecondsWithTimestamp(span.end - span.begin) / 1000.0;
+
+        NSMutableDictionary *stage = [stages objectForKey:name];
+
+        if (stage) {
+
+            [stage setObject:[NSNumber numberWithInteger:[[stage objectForKey:@"count"] integerValue] + 1] forKey:@"count"];
+            [stage setObject:[NSNumber numberWithDouble:[[stage objectForKey:@"total"] doubleValue] + duration] forKey:@"total"];
+            [stage setObject:[NSNumber numberWithDouble:fmin([[stage objectForKey:@"min"] doubleValue], duration)] forKey:@"min"];
+            [stage setObject:[NSNumber numberWithDouble:fmax([[stage objectForKey:@"max"] doubleValue], duration)] forKey:@"max"];
+
+        } else {
+
+            stage = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+                     name, @"name",
+                     [NSNumber numberWithInteger:1], @"count",
+                     [NSNumber numberWithDouble:duration], @"total",
+                     [NSNumber numberWithDouble:duration], @"min",
+                     [NSNumber numberWithDouble:duration], @"max",
+                     nil
+            ];
+            [stages setObject:stage forKey:name];
+        }
+    }
+
+    NSSortDescriptor *sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@"total" ascending:NO];
+    NSArray *sortedStages = [[stages allValues] sortedArrayUsingDescriptors:[NSArray arrayWithObject:sortDescriptor]];
+
+    NSMutableString *summary = [NSMutableString stringWithFormat:@"%-32s %8s %12s %12s %12s %12s\n", "Stage", "Calls", "Total (ms)", "Mean (ms)", "Min (ms)", "Max (ms)"];
+
+    for (NSDictionary *stage in sortedStages) {
+
+        NSInteger calls = [[stage objectForKey:@"count"] integerValue];
+        double total = [[stage objectForKey:@"total"] doubleValue];
+
+        [summary appendFormat:@"%-32s %8ld %12.3f %12.3f %12.3f %12.3f\n",
+         [[stage objectForKey:@"name"] UTF8String],
+         (long)calls,
+         total,
+         total / calls,
+         [[stage objectForKey:@"min"] doubleValue],
+         [[stage objectForKey:@"max"] doubleValue]
+        ];
+    }
+
+    return summary;
+}
+
+@end
@@ -106,10 +106,23 @@ typedef enum {
 /*!
  @method        autoInset
  @abstract      Calculate the smallest inset needed to ensure the image is not cropped during animation.
- @discussion    Returns the number of pixels the image needs to be inset.
+ @discussion    Returns the inset as a fraction of the icon's size. See autoInsetWithImage: for details.
  */
 - (CGFloat)autoInset;
 
+/*!
+ @method        autoInsetWithImage:
+ @abstract      Calculate the smallest inset needed to ensure the given image is not cropped during animation.
+ @param         image The image to calculate the inset for.
+ @discussion    Returns the inset as a fraction of the icon's size, between 0 and kMTImageInsetMax, or
+                kMTImageInsetDefault if the image has no opaque pixels. Use this method to calculate the
+                inset from the full resolution source image if the view only gets a downscaled copy of it.
+                The inset is calculated from the convex hull of the image's opaque pixels, so it is exactly as
+                large as needed to keep the image within the icon while it is rotated by up to
+                kMTAnimationRotationAngle degrees in either direction.
+ */
++ (CGFloat)autoInsetWithImage:(NSImage*)image;
+
 /*!
  @method        animateWithDuration:repeatCount:
  @abstract      Animates the view's uninstall image for the given duration.
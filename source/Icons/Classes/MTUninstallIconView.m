@@ -17,6 +17,7 @@
 
 #import "MTUninstallIconView.h"
 #import "MTColorValueTransformer.h"
+#import "MTTrace.h"
 
 @interface MTUninstallIconView ()
 @property (nonatomic, strong, readwrite) NSView *containerView;
@@ -80,10 +81,10 @@
     [self addSubview:_containerView];
     
     // add constraints
-    NSLayoutConstraint *containerLeft = [[_containerView leadingAnchor] constraintEqualToAnchor:[self leadingAnchor] constant:7];
-    NSLayoutConstraint *containerRight = [[_containerView trailingAnchor] constraintEqualToAnchor:[self trailingAnchor] constant:-7];
-    NSLayoutConstraint *containerTop = [[_containerView topAnchor] constraintEqualToAnchor:[self topAnchor] constant:7];
-    NSLayoutConstraint *containerBottom = [[_containerView bottomAnchor] constraintEqualToAnchor:[self bottomAnchor] constant:-7];
+    NSLayoutConstraint *containerLeft = [[_containerView leadingAnchor] constraintEqualToAnchor:[self leadingAnchor] constant:kMTDropViewContentInset];
+    NSLayoutConstraint *containerRight = [[_containerView trailingAnchor] constraintEqualToAnchor:[self trailingAnchor] constant:-kMTDropViewContentInset];
+    NSLayoutConstraint *containerTop = [[_containerView topAnchor] constraintEqualToAnchor:[self topAnchor] constant:kMTDropViewContentInset];
+    NSLayoutConstraint *containerBottom = [[_containerView bottomAnchor] constraintEqualToAnchor:[self bottomAnchor] constant:-kMTDropViewContentInset];
     [self addConstraints:[NSArray arrayWithObjects:containerLeft, containerRight, containerTop, containerBottom, nil]];
     
     // create the icon image
@@ -141,81 +142,193 @@
 
 - (CGFloat)autoInset
 {
+    return [MTUninstallIconView autoInsetWithImage:[self image]];
+}
+
+static int compareHullPoints(const void *a, const void *b)
+{
+    const CGPoint *p = a, *q = b;
+    
+    if (p->x != q->x) { return (p->x < q->x) ? -1 : 1; }
+    if (p->y != q->y) { return (p->y < q->y) ? -1 : 1; }
+    
+    return 0;
+}
+
+static CGFloat crossProduct(CGPoint o, CGPoint a, CGPoint b)
+{
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+// computes the convex hull of the given points (Andrew's monotone chain).
+// hull must have room for twice the number of points. returns the number
+// of points of the hull.
+static size_t convexHull(CGPoint *points, size_t count, CGPoint *hull)
+{
+    size_t hullCount = 0;
+    qsort(points, count, sizeof(CGPoint), compareHullPoints);
+    
+    // lower hull
+    for (size_t i = 0; i < count; i++) {
+        while (hullCount >= 2 && crossProduct(hull[hullCount - 2], hull[hullCount - 1], points[i]) <= 0) { hullCount--; }
+        hull[hullCount++] = points[i];
+    }
+    
+    // upper hull
+    size_t lowerCount = hullCount + 1;
+    
+    for (size_t i = count - 1; i > 0; i--) {
+        while (hullCount >= lowerCount && crossProduct(hull[hullCount - 2], hull[hullCount - 1], points[i - 1]) <= 0) { hullCount--; }
+        hull[hullCount++] = points[i - 1];
+    }
+    
+    // the last point is the first one again
+    return (hullCount > 1) ? hullCount - 1 : hullCount;
+}
+
+// returns how far the given point (relative to the center of
+// rotation) gets from the center in x or y direction while it
+// is rotated by up to ±maxAngle radians
+static CGFloat rotatedExtent(CGPoint point, CGFloat maxAngle)
+{
+    CGFloat extent = 0;
+    
+    for (int direction = -1; direction <= 1; direction += 2) {
+        
+        CGFloat sine = sin(direction * maxAngle);
+        CGFloat cosine = cos(direction * maxAngle);
+        extent = fmax(extent, fmax(fabs(point.x * cosine - point.y * sine), fabs(point.x * sine + point.y * cosine)));
+    }
+    
+    // if the point crosses one of the axes while rotating, it reaches
+    // its full distance from the center in the direction of that axis
+    if (fabs(remainder(atan2(point.y, point.x), M_PI_2)) <= maxAngle) { extent = fmax(extent, hypot(point.x, point.y)); }
+    
+    return extent;
+}
+
+// returns the inset that keeps the given hull (relative to the center of
+// an image with the given size) within the image while it is rotated
+static CGFloat insetWithHull(const CGPoint *hull, size_t hullCount, NSSize imageSize)
+{
+    CGFloat maxAngle = kMTAnimationRotationAngle * M_PI / 180.0;
+    CGFloat maxExtent = 0;
+    
+    for (size_t i = 0; i < hullCount; i++) {
+        maxExtent = fmax(maxExtent, rotatedExtent(hull[i], maxAngle));
+    }
+    
+    // the image is scaled to fit the icon
+    CGFloat halfSize = fmax(imageSize.width, imageSize.height) / 2.0;
+    
+    return (maxExtent > halfSize) ? 1.0 - (halfSize / maxExtent) : 0;
+}
+
++ (CGFloat)autoInsetWithImage:(NSImage*)image
+{
+    MTTraceTimestamp traceBegin = MTTraceBegin();
     CGFloat imageInset = kMTImageInsetDefault;
-    NSImage *sourceImage = [self image];
+    NSImage *sourceImage = image;
+    const char *traceName = "autoInset";
     
-    if ([sourceImage isValid]) {
+    if ([sourceImage isValid] && ![sourceImage hasAlphaChannel]) {
+        
+        // opaque images get their own stage, so --stats shows both paths
+        traceName = "autoInset (opaque)";
+        
+        // an image without alpha channel is opaque up to its edges,
+        // so its corners are the hull and we don't need its pixels
+        NSSize pixelSize = [sourceImage pixelSize];
+        CGFloat halfWidth = pixelSize.width / 2.0;
+        CGFloat halfHeight = pixelSize.height / 2.0;
+        
+        CGPoint hull[4] = {
+            CGPointMake(-halfWidth, -halfHeight),
+            CGPointMake(halfWidth, -halfHeight),
+            CGPointMake(halfWidth, halfHeight),
+            CGPointMake(-halfWidth, halfHeight)
+        };
+        
+        imageInset = insetWithHull(hull, 4, pixelSize);
+        
+    } else if ([sourceImage isValid]) {
+        
+        // we draw the image's alpha channel into scratch memory of the render arena,
+        // instead of decoding TIFF representations of the original and the scaled image
+        MTRenderArenaRef arena = MTRenderArenaGetCurrent();
+        MTRenderArenaMark arenaMark = MTRenderArenaGetMark(arena);
+        
+        // we scale large images down to speed up processing
+        CGFloat maxImageSize = 512;
+        NSSize pixelSize = [sourceImage pixelSize];
         
-        NSBitmapImageRep *sourceImageRep = [[NSBitmapImageRep alloc] initWithData:[sourceImage TIFFRepresentation]];
+        if (pixelSize.width > maxImageSize || pixelSize.height > maxImageSize) {
+            sourceImage = [sourceImage imageScaledToSize:NSMakeSize(maxImageSize, maxImageSize) maintainAspectRatio:YES];
+            pixelSize = NSMakeSize(maxImageSize, maxImageSize);
+        }
+        
+        CGContextRef context = [sourceImage createBitmapContextWithPixelSize:pixelSize
+                                                                      format:MTRenderArenaBitmapFormatAlphaOnly
+                                                            rotatedByDegrees:0
+        ];
         
-        // check if the image has an alpha channel, otherwise
-        // there's no transparency and we return kMTImageInsetDefault
-        if ([sourceImageRep hasAlpha]) {
+        if (context) {
             
-            // we scale large images down to speed up processing
-            CGFloat maxImageSize = 512;
-            if ([sourceImageRep pixelsWide] > maxImageSize || [sourceImageRep pixelsHigh] > maxImageSize) {
-                sourceImage = [sourceImage imageScaledToSize:NSMakeSize(maxImageSize, maxImageSize) maintainAspectRatio:YES];
-            }
+            size_t imageWidth = CGBitmapContextGetWidth(context);
+            size_t imageHeight = CGBitmapContextGetHeight(context);
+            size_t bytesPerRow = CGBitmapContextGetBytesPerRow(context);
+            const UInt8 *alpha = CGBitmapContextGetData(context);
             
-            CGImageSourceRef imageSource = CGImageSourceCreateWithData((CFDataRef)[sourceImage TIFFRepresentation], NULL);
+            // only the outermost opaque pixels of a row can be vertices of the
+            // convex hull, so we scan every row from both ends and stop at the
+            // first opaque pixel. we use the corners of these pixels, so the
+            // hull covers the pixels completely.
+            CGPoint *points = MTRenderArenaAllocate(arena, 4 * imageHeight * sizeof(CGPoint));
+            CGPoint *hull = MTRenderArenaAllocate(arena, 8 * imageHeight * sizeof(CGPoint));
+            size_t pointCount = 0;
             
-            if (imageSource) {
-                                
-                CGImageRef imageRef =  CGImageSourceCreateImageAtIndex(imageSource, 0, NULL);
-
-                if (imageRef) {
+            if (points && hull) {
+                
+                CGFloat centerX = imageWidth / 2.0;
+                CGFloat centerY = imageHeight / 2.0;
+                
+                for (size_t y = 0; y < imageHeight; y++) {
                     
-                    size_t imageWidth = CGImageGetWidth(imageRef);
-                    size_t imageHeight = CGImageGetHeight(imageRef);
-
-                    CFDataRef imageData = CGDataProviderCopyData(CGImageGetDataProvider(imageRef));
+                    const UInt8 *row = alpha + (y * bytesPerRow);
+                    size_t left = 0;
+                    while (left < imageWidth && !row[left]) { left++; }
                     
-                    if (imageData) {
+                    if (left < imageWidth) {
                         
-                        const UInt32 *pixels = (const UInt32*)CFDataGetBytePtr(imageData);
-                        CGFloat minX = imageWidth;
-                        CGFloat minY = imageHeight;
-                        CGFloat maxX = 0;
-                        CGFloat maxY = 0;
-
-                        // loop through the image's pixels and check if
-                        // they are transparent or not
-                        for (int y = 0; y < imageHeight; y++) {
-                            for (int x = 0; x < imageWidth; x++) {
-
-                                // the pixel is not transparent
-                                if (pixels[(y * imageWidth) + x] & 0xFF000000) {
-                                    if (x < minX) { minX = x; }
-                                    if (x > maxX) { maxX = x; }
-                                    if (y < minY) { minY = y; }
-                                    if (y > maxY) { maxY = y; }
-                                }
-                            }
-                        }
-
-                        CFRelease(imageData);
-
-                        // calculate how many percent smaller the actual image is
-                        CGFloat croppedWidth = imageWidth - (maxX + 1) + minX;
-                        CGFloat croppedHeigth = imageHeight - (maxY + 1) + minY;
-                        CGFloat insetInPercent = (croppedWidth < croppedHeigth) ? (1.0 / imageWidth) * croppedWidth : (1.0 / imageHeight) * croppedHeigth;
+                        size_t right = imageWidth - 1;
+                        while (!row[right]) { right--; }
                         
-                        // if the actual image is more than kMTImageInsetDefault percent
-                        // smaller than the image size, we return 0. Otherwise we return
-                        // how many percent additional inset is needed, to reach
-                        // kMTImageInsetDefault percent.
-                        imageInset = (insetInPercent > kMTImageInsetDefault) ? 0 : kMTImageInsetDefault - insetInPercent;
+                        points[pointCount++] = CGPointMake(left - centerX, y - centerY);
+                        points[pointCount++] = CGPointMake(left - centerX, y + 1 - centerY);
+                        points[pointCount++] = CGPointMake(right + 1 - centerX, y - centerY);
+                        points[pointCount++] = CGPointMake(right + 1 - centerX, y + 1 - centerY);
                     }
-                    
-                    CGImageRelease(imageRef);
                 }
+            }
+            
+            // if the image is completely transparent we return kMTImageInsetDefault
+            if (pointCount > 0) {
                 
-                CFRelease(imageSource);
+                // the uninstall icon is rotated around its center, so the image (scaled
+                // down by the inset) stays within the icon, as long as none of the hull's
+                // vertices gets further away from the center than half of the icon's size
+                size_t hullCount = convexHull(points, pointCount, hull);
+                imageInset = insetWithHull(hull, hullCount, NSMakeSize(imageWidth, imageHeight));
             }
+            
+            CGContextRelease(context);
         }
+        
+        MTRenderArenaRestoreMark(arena, arenaMark);
     }
     
+    MTTraceEnd(traceName, traceBegin);
+    
     return imageInset;
 }
 
@@ -399,7 +512,7 @@
         [shakeAnimation setRepeatCount:repeatCount];
 
         // define the rotation
-        CGFloat rotationAngle = 2.0;
+        CGFloat rotationAngle = kMTAnimationRotationAngle;
         NSArray *animationValues = [NSArray arrayWithObjects:
                                     [NSNumber numberWithFloat:0.0],
                                     [NSNumber numberWithFloat:(-rotationAngle / 180.0) * M_PI],
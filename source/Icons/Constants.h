@@ -18,6 +18,7 @@
 #define kMTAnimationDurationMin         0
 #define kMTAnimationDurationMax         .9
 #define kMTAnimationDurationDefault     .5
+#define kMTAnimationRotationAngle       2.0
 
 #define kMTImageInsetMin                0
 #define kMTImageInsetMax                .2
@@ -28,6 +29,25 @@
 #define kMTOutputSizeDefault            512
 #define kMTOutputSizes                  @[@64, @128, @256, @512, @1024]
 
+#define kMTSupersamplingMin             1
+#define kMTSupersamplingMax             4
+#define kMTSupersamplingDefault         1
+
+#define kMTScanJobsMin                  1
+#define kMTScanJobsMax                  64
+#define kMTScanJobsDefault              8
+#define kMTScanDecodeAhead              4
+
+#define kMTWatchLatency                 .1
+#define kMTWatchDebounceInterval        .25
+
+#define kMTWriteBatchSize               64
+
+#define kMTExtensionRenderMemory        (256ULL * 1024 * 1024)
+#define kMTExtensionRenderBuffers       12
+#define kMTExtensionMemoryBudget        (1024ULL * 1024 * 1024)
+#define kMTExtensionMemoryFraction      .25
+
 #define kMTBannerTextMarginMin          0
 #define kMTBannerTextMarginMax          .4
 #define kMTBannerTextMarginDefault      .2      // ***
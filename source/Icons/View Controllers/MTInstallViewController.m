@@ -18,6 +18,8 @@
 #import "MTInstallViewController.h"
 #import "MTAttributedString.h"
 #import "MTGroupDefaults.h"
+#import "MTRenderPreset.h"
+#import <UniformTypeIdentifiers/UniformTypeIdentifiers.h>
 
 @interface MTInstallViewController ()
 @property (weak) IBOutlet MTInstallIconView *installIconView;
@@ -650,6 +652,70 @@
     [_savedBannersController rearrangeObjects];
 }
 
+- (IBAction)exportBannerPreset:(id)sender
+{
+    NSInteger clickedRow = [_savedBannersTable clickedRow];
+    
+    if (clickedRow >= 0 && clickedRow < [[_savedBannersController arrangedObjects] count]) {
+        
+        NSDictionary *bannerDict = [[_savedBannersController arrangedObjects] objectAtIndex:clickedRow];
+        MTRenderPreset *preset = [MTRenderPreset presetWithUserDefaults:_userDefaults savedBanner:bannerDict];
+        NSString *bannerName = ([[preset bannerName] length] > 0) ? [preset bannerName] : [[preset bannerAttributes] string];
+        
+        NSSavePanel *panel = [NSSavePanel savePanel];
+        [panel setAllowedContentTypes:[NSArray arrayWithObject:[UTType typeWithFilenameExtension:kMTRenderPresetFileExtension]]];
+        [panel setNameFieldStringValue:[[bannerName stringByReplacingOccurrencesOfString:@"/" withString:@"-"] stringByAppendingPathExtension:kMTRenderPresetFileExtension]];
+        [panel beginSheetModalForWindow:[[self view] window] completionHandler:^(NSInteger result) {
+            
+            NSError *error = nil;
+            
+            if (result == NSModalResponseOK && ![preset writeToURL:[panel URL] error:&error]) {
+                
+                NSAlert *alert = [NSAlert alertWithError:error];
+                [alert beginSheetModalForWindow:[[self view] window] completionHandler:nil];
+            }
+        }];
+    }
+}
+
+- (IBAction)importBannerPreset:(id)sender
+{
+    NSOpenPanel *panel = [NSOpenPanel openPanel];
+    [panel setCanChooseFiles:YES];
+    [panel setCanChooseDirectories:NO];
+    [panel setAllowsMultipleSelection:YES];
+    [panel setCanCreateDirectories:NO];
+    [panel setAllowedContentTypes:[NSArray arrayWithObject:[UTType typeWithFilenameExtension:kMTRenderPresetFileExtension]]];
+    [panel setPrompt:NSLocalizedString(@"openButton", nil)];
+    [panel beginSheetModalForWindow:[[self view] window] completionHandler:^(NSInteger result) {
+        
+        if (result == NSModalResponseOK) {
+            
+            NSError *error = nil;
+            
+            for (NSURL *presetURL in [panel URLs]) {
+                
+                MTRenderPreset *preset = [MTRenderPreset presetWithContentsOfURL:presetURL error:&error];
+                NSDictionary *bannerDict = [preset savedBannerDictionary];
+                
+                // only the banner is imported, the other settings
+                // of the preset are left untouched
+                if (bannerDict && ![[self->_savedBannersController content] containsObject:bannerDict]) {
+                    [self->_savedBannersController addObject:bannerDict];
+                }
+            }
+            
+            [self->_savedBannersController rearrangeObjects];
+            
+            if (error) {
+                
+                NSAlert *alert = [NSAlert alertWithError:error];
+                [alert beginSheetModalForWindow:[[self view] window] completionHandler:nil];
+            }
+        }
+    }];
+}
+
 - (IBAction)updateBannerPosition:(id)sender
 {
     NSInteger position = [sender tag];
@@ -1015,6 +1081,14 @@
             
             enableItem = YES;
             [menuItem setAlternate:(hideAll || [_savedBannersTable clickedRow] >= 0)];
+            
+        } else if ([menuItem tag] == 4000) {
+            
+            [menuItem setHidden:(hideAll || [_savedBannersTable clickedRow] < 0)];
+            
+        } else if ([menuItem tag] == 5000) {
+            
+            enableItem = YES;
         }
     }
     
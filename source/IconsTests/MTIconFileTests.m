@@ -0,0 +1,307 @@
+/*
+    MTIconFileTests.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <XCTest/XCTest.h>
+#import <ImageIO/ImageIO.h>
+#import "MTIconFile.h"
+
+// the .icns fixtures are built in code, so every byte of them is known.
+// it32 entries contain 128 x 128 pixels with RLE compressed R, G and B
+// channels and a separate uncompressed 8-bit mask (t8mk)
+#define kMTTestPixelSize    128
+
+static UInt8 testRed(NSUInteger x, NSUInteger y) { return (y < 64) ? 0x10 : 0xf0; }
+static UInt8 testGreen(NSUInteger x, NSUInteger y) { return (UInt8)x; }
+static UInt8 testBlue(NSUInteger x, NSUInteger y) { return 0x80; }
+static UInt8 testAlpha(NSUInteger x, NSUInteger y) { return (x < 32) ? 0x00 : 0xff; }
+
+@interface MTIconFileTests : XCTestCase
+@end
+
+@implementation MTIconFileTests
+
++ (void)appendUInt32:(uint32_t)value toData:(NSMutableData*)data
+{
+    uint32_t bigEndianValue = OSSwapHostToBigInt32(value);
+    [data appendBytes:&bigEndianValue length:sizeof(bigEndianValue)];
+}
+
++ (void)appendChannel:(UInt8 (*)(NSUInteger, NSUInteger))channel toData:(NSMutableData*)data
+{
+    // runs of three or more equal bytes are stored as a repeat,
+    // everything else as literals, so both kinds are used
+    NSUInteger pixelCount = kMTTestPixelSize * kMTTestPixelSize;
+    NSUInteger pixel = 0;
+
+    while (pixel < pixelCount) {
+
+        UInt8 value = channel(pixel % kMTTestPixelSize, pixel / kMTTestPixelSize);
+        NSUInteger count = 1;
+
+        while (pixel + count < pixelCount && count < 130 &&
+               channel((pixel + count) % kMTTestPixelSize, (pixel + count) / kMTTestPixelSize) == value) {
+            count++;
+        }
+
+        if (count >= 3) {
+
+            UInt8 run[2] = { (UInt8)(count - 3 + 0x80), value };
+            [data appendBytes:run length:sizeof(run)];
+
+        } else {
+
+            count = 1;
+            UInt8 literal[2] = { 0x00, value };
+            [data appendBytes:literal length:sizeof(literal)];
+        }
+
+        pixel += count;
+    }
+}
+
++ (NSData*)it32Data
+{
+    NSMutableData *data = [NSMutableData dataWithLength:4];
+    [self appendChannel:testRed toData:data];
+    [self appendChannel:testGreen toData:data];
+    [self appendChannel:testBlue toData:data];
+
+    return data;
+}
+
++ (NSData*)t8mkData
+{
+    NSMutableData *data = [NSMutableData data];
+
+    for (NSUInteger y = 0; y < kMTTestPixelSize; y++) {
+        for (NSUInteger x = 0; x < kMTTestPixelSize; x++) {
+            UInt8 alpha = testAlpha(x, y);
+            [data appendBytes:&alpha length:1];
+        }
+    }
+
+    return data;
+}
+
++ (NSData*)pngDataWithRed:(CGFloat)red green:(CGFloat)green blue:(CGFloat)blue
+{
+    NSMutableData *pngData = [NSMutableData data];
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+    CGContextRef context = CGBitmapContextCreate(NULL, kMTTestPixelSize, kMTTestPixelSize, 8, 0, colorSpace, (CGBitmapInfo)kCGImageAlphaPremultipliedLast);
+    CGColorSpaceRelease(colorSpace);
+
+    CGContextSetRGBFillColor(context, red, green, blue, 1);
+    CGContextFillRect(context, CGRectMake(0, 0, kMTTestPixelSize, kMTTestPixelSize));
+    CGImageRef imageRef = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+
+    CGImageDestinationRef destination = CGImageDestinationCreateWithData((__bridge CFMutableDataRef)pngData, CFSTR("public.png"), 1, NULL);
+    CGImageDestinationAddImage(destination, imageRef, NULL);
+    CGImageDestinationFinalize(destination);
+    CFRelease(destination);
+    CGImageRelease(imageRef);
+
+    return pngData;
+}
+
++ (NSData*)icnsDataWithEntries:(NSArray*)entries types:(NSArray*)types includeTOC:(BOOL)includeTOC
+{
+    NSMutableData *body = [NSMutableData data];
+
+    if (includeTOC) {
+
+        [self appendUInt32:'TOC ' toData:body];
+        [self appendUInt32:(uint32_t)(8 + 8 * [entries count]) toData:body];
+
+        for (NSUInteger i = 0; i < [entries count]; i++) {
+            [self appendUInt32:[[types objectAtIndex:i] unsignedIntValue] toData:body];
+            [self appendUInt32:(uint32_t)([[entries objectAtIndex:i] length] + 8) toData:body];
+        }
+    }
+
+    for (NSUInteger i = 0; i < [entries count]; i++) {
+        [self appendUInt32:[[types objectAtIndex:i] unsignedIntValue] toData:body];
+        [self appendUInt32:(uint32_t)([[entries objectAtIndex:i] length] + 8) toData:body];
+        [body appendData:[entries objectAtIndex:i]];
+    }
+
+    NSMutableData *data = [NSMutableData data];
+    [self appendUInt32:'icns' toData:data];
+    [self appendUInt32:(uint32_t)([body length] + 8) toData:data];
+    [data appendData:body];
+
+    return data;
+}
+
++ (NSData*)it32IconDataWithTOC:(BOOL)includeTOC
+{
+    return [self icnsDataWithEntries:[NSArray arrayWithObjects:[self t8mkData], [self it32Data], nil]
+                               types:[NSArray arrayWithObjects:[NSNumber numberWithUnsignedInt:'t8mk'], [NSNumber numberWithUnsignedInt:'it32'], nil]
+                          includeTOC:includeTOC
+    ];
+}
+
+- (void)assertIt32Image:(CGImageRef)imageRef
+{
+    XCTAssertTrue(imageRef != NULL);
+    if (!imageRef) { return; }
+
+    XCTAssertEqual(CGImageGetWidth(imageRef), kMTTestPixelSize);
+    XCTAssertEqual(CGImageGetHeight(imageRef), kMTTestPixelSize);
+    XCTAssertEqual(CGImageGetBitsPerPixel(imageRef), 32);
+    XCTAssertEqual(CGImageGetAlphaInfo(imageRef), kCGImageAlphaLast);
+
+    // the image is created from the decoded (non-premultiplied) RGBA pixels
+    CFDataRef pixelData = CGDataProviderCopyData(CGImageGetDataProvider(imageRef));
+    const UInt8 *pixels = CFDataGetBytePtr(pixelData);
+    size_t bytesPerRow = CGImageGetBytesPerRow(imageRef);
+    NSUInteger mismatchCount = 0;
+
+    for (NSUInteger y = 0; y < kMTTestPixelSize; y++) {
+
+        for (NSUInteger x = 0; x < kMTTestPixelSize; x++) {
+
+            const UInt8 *pixel = pixels + y * bytesPerRow + x * 4;
+
+            if (pixel[0] != testRed(x, y) || pixel[1] != testGreen(x, y) || pixel[2] != testBlue(x, y) || pixel[3] != testAlpha(x, y)) {
+                mismatchCount++;
+            }
+        }
+    }
+
+    XCTAssertEqual(mismatchCount, 0);
+    CFRelease(pixelData);
+}
+
+- (void)testIt32WithTOC
+{
+    CGImageRef imageRef = [MTIconFile createImageWithICNSData:[[self class] it32IconDataWithTOC:YES]];
+    [self assertIt32Image:imageRef];
+    if (imageRef) { CGImageRelease(imageRef); }
+}
+
+- (void)testIt32WithoutTOC
+{
+    CGImageRef imageRef = [MTIconFile createImageWithICNSData:[[self class] it32IconDataWithTOC:NO]];
+    [self assertIt32Image:imageRef];
+    if (imageRef) { CGImageRelease(imageRef); }
+}
+
+- (void)testIt32FromFile
+{
+    NSURL *fileURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    fileURL = [fileURL URLByAppendingPathExtension:@"icns"];
+    XCTAssertTrue([[[self class] it32IconDataWithTOC:YES] writeToURL:fileURL atomically:YES]);
+
+    CGImageRef imageRef = [MTIconFile createImageWithICNSFileAtURL:fileURL];
+    [self assertIt32Image:imageRef];
+    if (imageRef) { CGImageRelease(imageRef); }
+
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+}
+
+- (void)testLargestEntryIsPreferred
+{
+    // ic07 comes before it32 in the order of preference, ic11 after
+    // it, no matter in which order the entries are stored in the file
+    NSData *icnsData = [[self class] icnsDataWithEntries:[NSArray arrayWithObjects:
+                                                          [[self class] pngDataWithRed:0 green:0 blue:1],
+                                                          [[self class] it32Data],
+                                                          [[self class] t8mkData],
+                                                          [[self class] pngDataWithRed:1 green:0 blue:0],
+                                                          nil]
+                                                   types:[NSArray arrayWithObjects:
+                                                          [NSNumber numberWithUnsignedInt:'ic11'],
+                                                          [NSNumber numberWithUnsignedInt:'it32'],
+                                                          [NSNumber numberWithUnsignedInt:'t8mk'],
+                                                          [NSNumber numberWithUnsignedInt:'ic07'],
+                                                          nil]
+                                              includeTOC:YES
+    ];
+
+    CGImageRef imageRef = [MTIconFile createImageWithICNSData:icnsData];
+    XCTAssertTrue(imageRef != NULL);
+
+    if (imageRef) {
+
+        UInt8 pixel[4] = { 0 };
+        CGColorSpaceRef colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+        CGContextRef context = CGBitmapContextCreate(pixel, 1, 1, 8, 4, colorSpace, (CGBitmapInfo)kCGImageAlphaPremultipliedLast);
+        CGColorSpaceRelease(colorSpace);
+
+        CGContextDrawImage(context, CGRectMake(0, 0, 1, 1), imageRef);
+        CGContextRelease(context);
+
+        XCTAssertEqual(CGImageGetWidth(imageRef), kMTTestPixelSize);
+        XCTAssertEqual(pixel[0], 0xff);
+        XCTAssertEqual(pixel[2], 0x00);
+
+        CGImageRelease(imageRef);
+    }
+}
+
+- (void)testMissingMaskIsOpaque
+{
+    NSData *icnsData = [[self class] icnsDataWithEntries:[NSArray arrayWithObject:[[self class] it32Data]]
+                                                   types:[NSArray arrayWithObject:[NSNumber numberWithUnsignedInt:'it32']]
+                                              includeTOC:NO
+    ];
+
+    CGImageRef imageRef = [MTIconFile createImageWithICNSData:icnsData];
+    XCTAssertTrue(imageRef != NULL);
+
+    if (imageRef) {
+
+        CFDataRef pixelData = CGDataProviderCopyData(CGImageGetDataProvider(imageRef));
+        XCTAssertEqual(CFDataGetBytePtr(pixelData)[3], 0xff);
+        CFRelease(pixelData);
+        CGImageRelease(imageRef);
+    }
+}
+
+- (void)testTruncatedData
+{
+    NSData *icnsData = [[self class] it32IconDataWithTOC:YES];
+
+    // cut off the end of the RLE data, so the last channel is incomplete
+    CGImageRef imageRef = [MTIconFile createImageWithICNSData:[icnsData subdataWithRange:NSMakeRange(0, [icnsData length] - 16)]];
+    XCTAssertTrue(imageRef == NULL);
+    if (imageRef) { CGImageRelease(imageRef); }
+
+    imageRef = [MTIconFile createImageWithICNSData:[icnsData subdataWithRange:NSMakeRange(0, 4)]];
+    XCTAssertTrue(imageRef == NULL);
+    if (imageRef) { CGImageRelease(imageRef); }
+}
+
+- (void)testCorruptRunLength
+{
+    // the runs add up to more pixels than the channel has
+    NSMutableData *corruptData = [NSMutableData dataWithLength:4];
+    UInt8 overflow[2] = { 0xff, 0x00 };
+    for (NSUInteger i = 0; i < 200; i++) { [corruptData appendBytes:overflow length:sizeof(overflow)]; }
+
+    NSData *icnsData = [[self class] icnsDataWithEntries:[NSArray arrayWithObjects:[[self class] t8mkData], corruptData, nil]
+                                                   types:[NSArray arrayWithObjects:[NSNumber numberWithUnsignedInt:'t8mk'], [NSNumber numberWithUnsignedInt:'it32'], nil]
+                                              includeTOC:YES
+    ];
+
+    CGImageRef imageRef = [MTIconFile createImageWithICNSData:icnsData];
+    XCTAssertTrue(imageRef == NULL);
+    if (imageRef) { CGImageRelease(imageRef); }
+}
+
+@end
@@ -0,0 +1,214 @@
+/*
+    MTRenderPresetTests.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <XCTest/XCTest.h>
+#import "MTRenderPreset.h"
+#import "Constants.h"
+
+// offsets of some of the header fields of a preset file
+#define kMTTestMajorVersionOffset       4
+#define kMTTestMinorVersionOffset       5
+#define kMTTestHeaderLengthOffset       6
+#define kMTTestBannerPositionOffset     16
+#define kMTTestBadgePositionOffset      20
+#define kMTTestBannerHeightOffset       64
+
+@interface MTRenderPresetTests : XCTestCase
+@property (nonatomic, strong, readwrite) MTRenderPreset *preset;
+@end
+
+@implementation MTRenderPresetTests
+
+- (void)setUp
+{
+    NSAttributedString *banner = [[NSAttributedString alloc] initWithString:@"Beta"];
+    NSData *bannerData = [banner RTFFromRange:NSMakeRange(0, [banner length]) documentAttributes:[NSDictionary dictionary]];
+
+    NSDictionary *bannerDict = [NSDictionary dictionaryWithObjectsAndKeys:
+                                [NSNumber numberWithBool:YES], kMTDefaultsBannerIsDefaultKey,
+                                @"Beta Banner", kMTDefaultsBannerNameKey,
+                                bannerData, kMTDefaultsBannerDataKey,
+                                [NSNumber numberWithInteger:MTBannerPositionBottomRight], kMTDefaultsBannerPositionKey,
+                                [NSNumber numberWithDouble:.25], kMTDefaultsBannerHeightKey,
+                                [NSNumber numberWithDouble:45], kMTDefaultsBannerAngleKey,
+                                nil
+    ];
+
+    NSDictionary *settings = [NSDictionary dictionaryWithObjectsAndKeys:
+                              [NSNumber numberWithBool:NO], kMTDefaultsAutoOutputSizeKey,
+                              [NSNumber numberWithInteger:512], kMTDefaultsOutputSizeKey,
+                              [NSNumber numberWithBool:NO], kMTDefaultsSaveAnimatedUninstallIconKey,
+                              [NSNumber numberWithBool:YES], kMTDefaultsRenderImagesInIconShapeKey,
+                              [NSArray arrayWithObject:bannerDict], kMTDefaultsSavedBannersKey,
+                              [NSNumber numberWithInteger:MTBadgePositionBottomLeft], kMTDefaultsBadgePositionDefaultKey,
+                              [NSNumber numberWithBool:YES], kMTDefaultsUsePrefixKey,
+                              @"Prefix", kMTDefaultsUserDefinedPrefixKey,
+                              nil
+    ];
+
+    _preset = [[MTRenderPreset alloc] initWithSettings:settings];
+}
+
+- (void)assertPreset:(MTRenderPreset*)preset equalToPreset:(MTRenderPreset*)otherPreset
+{
+    XCTAssertNotNil(preset);
+    XCTAssertEqual([preset outputSize], [otherPreset outputSize]);
+    XCTAssertEqual([preset createsInstallIcon], [otherPreset createsInstallIcon]);
+    XCTAssertEqual([preset createsAnimatedUninstallIcon], [otherPreset createsAnimatedUninstallIcon]);
+    XCTAssertEqual([preset appliesIconShape], [otherPreset appliesIconShape]);
+    XCTAssertEqual([preset bannerPosition], [otherPreset bannerPosition]);
+    XCTAssertEqual([preset bannerHeight], [otherPreset bannerHeight]);
+    XCTAssertEqual([preset bannerAngle], [otherPreset bannerAngle]);
+    XCTAssertEqual([preset badgePosition], [otherPreset badgePosition]);
+    XCTAssertEqual([preset badgeShadowRadius], [otherPreset badgeShadowRadius]);
+    XCTAssertEqual([preset usesFileNamePrefix], [otherPreset usesFileNamePrefix]);
+    XCTAssertEqualObjects([preset bannerName], [otherPreset bannerName]);
+    XCTAssertEqualObjects([preset fileNamePrefix], [otherPreset fileNamePrefix]);
+    XCTAssertEqualObjects([[preset bannerAttributes] string], [[otherPreset bannerAttributes] string]);
+}
+
+- (void)testRoundTrip
+{
+    NSData *presetData = [_preset presetData];
+    NSError *error = nil;
+    MTRenderPreset *loadedPreset = [MTRenderPreset presetWithData:presetData error:&error];
+
+    XCTAssertNil(error);
+    [self assertPreset:loadedPreset equalToPreset:_preset];
+    XCTAssertEqual([loadedPreset outputSize], 512);
+    XCTAssertEqual([loadedPreset bannerPosition], MTBannerPositionBottomRight);
+    XCTAssertEqual([loadedPreset badgePosition], MTBadgePositionBottomLeft);
+    XCTAssertEqualObjects([loadedPreset bannerName], @"Beta Banner");
+
+    // writing a loaded preset must not change the file
+    XCTAssertEqualObjects([loadedPreset presetData], presetData);
+}
+
+- (void)testSecureCodingRoundTrip
+{
+    NSError *error = nil;
+    NSData *archiveData = [NSKeyedArchiver archivedDataWithRootObject:_preset requiringSecureCoding:YES error:&error];
+    XCTAssertNotNil(archiveData);
+
+    MTRenderPreset *loadedPreset = [NSKeyedUnarchiver unarchivedObjectOfClass:[MTRenderPreset class] fromData:archiveData error:&error];
+    [self assertPreset:loadedPreset equalToPreset:_preset];
+}
+
+- (void)testTruncatedData
+{
+    NSData *presetData = [_preset presetData];
+
+    for (NSUInteger length = 0; length < [presetData length]; length++) {
+
+        NSError *error = nil;
+        MTRenderPreset *loadedPreset = [MTRenderPreset presetWithData:[presetData subdataWithRange:NSMakeRange(0, length)] error:&error];
+
+        XCTAssertNil(loadedPreset, @"preset truncated to %lu bytes has been accepted", (unsigned long)length);
+        XCTAssertNotNil(error);
+    }
+}
+
+- (void)testInvalidMagic
+{
+    NSMutableData *presetData = [[_preset presetData] mutableCopy];
+    uint8_t *bytes = [presetData mutableBytes];
+    bytes[0] ^= 0xff;
+
+    XCTAssertNil([MTRenderPreset presetWithData:presetData error:nil]);
+}
+
+- (void)testNewerMajorVersion
+{
+    NSMutableData *presetData = [[_preset presetData] mutableCopy];
+    uint8_t *bytes = [presetData mutableBytes];
+    bytes[kMTTestMajorVersionOffset]++;
+
+    XCTAssertNil([MTRenderPreset presetWithData:presetData error:nil]);
+}
+
+- (void)testNewerMinorVersionWithLongerHeader
+{
+    NSData *presetData = [_preset presetData];
+    uint16_t headerLength = 0;
+    [presetData getBytes:&headerLength range:NSMakeRange(kMTTestHeaderLengthOffset, sizeof(headerLength))];
+    headerLength = OSSwapLittleToHostInt16(headerLength);
+
+    // a newer minor version appends a field to the header
+    uint64_t newField = UINT64_MAX;
+    NSMutableData *newerData = [[presetData subdataWithRange:NSMakeRange(0, headerLength)] mutableCopy];
+    [newerData appendBytes:&newField length:sizeof(newField)];
+    [newerData appendData:[presetData subdataWithRange:NSMakeRange(headerLength, [presetData length] - headerLength)]];
+
+    uint8_t *bytes = [newerData mutableBytes];
+    bytes[kMTTestMinorVersionOffset]++;
+    uint16_t newHeaderLength = OSSwapHostToLittleInt16(headerLength + sizeof(newField));
+    memcpy(bytes + kMTTestHeaderLengthOffset, &newHeaderLength, sizeof(newHeaderLength));
+
+    [self assertPreset:[MTRenderPreset presetWithData:newerData error:nil] equalToPreset:_preset];
+}
+
+- (void)testHeaderLengthOutOfRange
+{
+    NSMutableData *presetData = [[_preset presetData] mutableCopy];
+    uint8_t *bytes = [presetData mutableBytes];
+
+    uint16_t headerLength = OSSwapHostToLittleInt16(8);
+    memcpy(bytes + kMTTestHeaderLengthOffset, &headerLength, sizeof(headerLength));
+    XCTAssertNil([MTRenderPreset presetWithData:presetData error:nil]);
+
+    headerLength = OSSwapHostToLittleInt16(UINT16_MAX);
+    memcpy(bytes + kMTTestHeaderLengthOffset, &headerLength, sizeof(headerLength));
+    XCTAssertNil([MTRenderPreset presetWithData:presetData error:nil]);
+}
+
+- (void)testCorruptBlobLength
+{
+    NSMutableData *presetData = [[_preset presetData] mutableCopy];
+    uint16_t headerLength = 0;
+    [presetData getBytes:&headerLength range:NSMakeRange(kMTTestHeaderLengthOffset, sizeof(headerLength))];
+
+    // the banner name is longer than the file
+    uint32_t blobLength = OSSwapHostToLittleInt32(UINT32_MAX - 1);
+    [presetData replaceBytesInRange:NSMakeRange(OSSwapLittleToHostInt16(headerLength), sizeof(blobLength)) withBytes:&blobLength];
+
+    XCTAssertNil([MTRenderPreset presetWithData:presetData error:nil]);
+}
+
+- (void)testInvalidValues
+{
+    NSMutableData *presetData = [[_preset presetData] mutableCopy];
+    uint8_t *bytes = [presetData mutableBytes];
+
+    int32_t bannerPosition = (int32_t)OSSwapHostToLittleInt32(99);
+    int32_t badgePosition = (int32_t)OSSwapHostToLittleInt32(-1);
+    memcpy(bytes + kMTTestBannerPositionOffset, &bannerPosition, sizeof(bannerPosition));
+    memcpy(bytes + kMTTestBadgePositionOffset, &badgePosition, sizeof(badgePosition));
+
+    double bannerHeight = 1000;
+    uint64_t bannerHeightBits = 0;
+    memcpy(&bannerHeightBits, &bannerHeight, sizeof(bannerHeightBits));
+    bannerHeightBits = OSSwapHostToLittleInt64(bannerHeightBits);
+    memcpy(bytes + kMTTestBannerHeightOffset, &bannerHeightBits, sizeof(bannerHeightBits));
+
+    MTRenderPreset *loadedPreset = [MTRenderPreset presetWithData:presetData error:nil];
+    XCTAssertNotNil(loadedPreset);
+    XCTAssertEqual([loadedPreset bannerPosition], MTBannerPositionTopLeft);
+    XCTAssertEqual([loadedPreset badgePosition], MTBadgePositionTopLeft);
+    XCTAssertEqual([loadedPreset bannerHeight], kMTBannerHeightMax);
+}
+
+@end
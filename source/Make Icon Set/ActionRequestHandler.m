@@ -20,15 +20,21 @@
 #import "MTUninstallIconView.h"
 #import "MTIconSet.h"
 #import "Constants.h"
-#import "MTColorValueTransformer.h"
+#import "MTRenderPreset.h"
+#import "MTRenderArena.h"
 #import <UniformTypeIdentifiers/UTCoreTypes.h>
-#import <os/log.h>
 
 @interface ActionRequestHandler ()
 @property (nonatomic, strong, readwrite) dispatch_group_t attachmentsGroup;
+@property (nonatomic, strong, readwrite) NSOperationQueue *renderQueue;
 @end
 
 @implementation ActionRequestHandler
+{
+    NSCondition *_memoryCondition;
+    unsigned long long _memoryBudget;
+    unsigned long long _memoryInUse;
+}
 
 - (void)beginRequestWithExtensionContext:(NSExtensionContext *)context
 {
@@ -38,6 +44,27 @@
         NSArray *inputAttachments = [inputItem attachments];
         
         _attachmentsGroup = dispatch_group_create();
+        _memoryCondition = [[NSCondition alloc] init];
+        _memoryBudget = [self renderMemoryBudget];
+        _memoryInUse = 0;
+        
+        // the settings are compiled into a preset once, which is then
+        // shared by all renders instead of parsing the settings again
+        // for every attachment
+        NSUserDefaults *userDefaults = [[NSUserDefaults alloc] initWithSuiteName:@"7R5ZEU67FQ.corp.sap.Icons"];
+        MTRenderPreset *preset = [MTRenderPreset presetWithUserDefaults:userDefaults];
+        
+        // the icon sets are created in parallel, but only as many
+        // at a time as the cores and the memory of the Mac allow
+        _renderQueue = [[NSOperationQueue alloc] init];
+        [_renderQueue setMaxConcurrentOperationCount:[self maximumConcurrentRenders]];
+        [_renderQueue setQualityOfService:NSQualityOfServiceUserInitiated];
+        
+        // the attachments are loaded one after another. Before an attachment
+        // is loaded, memory for its render is reserved. So if the budget has
+        // been used up, no further attachments are loaded until one of the
+        // icon sets has been written and its memory has been released
+        dispatch_queue_t loadQueue = dispatch_queue_create("corp.sap.Icons.extension.load", DISPATCH_QUEUE_SERIAL);
         
         // the outputAttachments array must contain our input
         // attachments otherwise the input item would be deleted
@@ -47,52 +74,75 @@
         for (NSItemProvider *attachment in inputAttachments) {
             
             dispatch_group_enter(_attachmentsGroup);
-        
-            [attachment loadItemForTypeIdentifier:[UTTypeItem identifier]
-                                          options:nil
-                                completionHandler:^(NSURL *inputFileURL, NSError *error) {
-
-                if (inputFileURL) {
-                    
-                    // get a path to write our files to
-                    NSURL *itemReplacementDirectory = [[NSFileManager defaultManager] URLForDirectory:NSItemReplacementDirectory
-                                                                                             inDomain:NSUserDomainMask
-                                                                                    appropriateForURL:[NSURL fileURLWithPath:NSHomeDirectory()]
-                                                                                               create:YES
-                                                                                                error:nil
-                    ];
+            
+            dispatch_async(loadQueue, ^{
+                
+                [self reserveRenderMemory:kMTExtensionRenderMemory waitUntilAvailable:YES];
+                
+                [attachment loadItemForTypeIdentifier:[UTTypeItem identifier]
+                                              options:nil
+                                    completionHandler:^(NSURL *inputFileURL, NSError *error) {
                     
-                    dispatch_group_enter(self->_attachmentsGroup);
+                    if (inputFileURL) {
                         
-                    [self createIconSetFromImageAtURL:inputFileURL
-                                           outputPath:[itemReplacementDirectory path]
-                                    completionHandler:^(BOOL success, NSString *path, NSError *error) {
-                            
-                        if (success) {
+                        // get a path to write our files to
+                        NSURL *itemReplacementDirectory = [[NSFileManager defaultManager] URLForDirectory:NSItemReplacementDirectory
+                                                                                                 inDomain:NSUserDomainMask
+                                                                                        appropriateForURL:[NSURL fileURLWithPath:NSHomeDirectory()]
+                                                                                                   create:YES
+                                                                                                    error:nil
+                        ];
+                        
+                        dispatch_group_enter(self->_attachmentsGroup);
+                        
+                        [self->_renderQueue addOperationWithBlock:^{
                             
-                            NSItemProvider *itemProvider = [[NSItemProvider alloc] init];
-                            [itemProvider registerFileRepresentationForTypeIdentifier:[UTTypeFolder identifier]
-                                                                          fileOptions:NSItemProviderFileOptionOpenInPlace
-                                                                           visibility:NSItemProviderRepresentationVisibilityAll
-                                                                          loadHandler:^NSProgress *(void (^ completionHandler)(NSURL *, BOOL, NSError *)) {
-                                completionHandler([NSURL fileURLWithPath:path], NO, nil);
-                                return nil;
+                            [self createIconSetFromImageAtURL:inputFileURL
+                                                   outputPath:[itemReplacementDirectory path]
+                                                       preset:preset
+                                               reservedMemory:kMTExtensionRenderMemory
+                                            completionHandler:^(BOOL success, NSString *path, NSError *error) {
+                                
+                                // every icon set is published as soon as it has been written. The
+                                // attachments are only modified on the main queue, because the
+                                // icon sets are finished on different threads
+                                dispatch_async(dispatch_get_main_queue(), ^{
+                                    
+                                    if (success) {
+                                        
+                                        NSItemProvider *itemProvider = [[NSItemProvider alloc] init];
+                                        [itemProvider registerFileRepresentationForTypeIdentifier:[UTTypeFolder identifier]
+                                                                                      fileOptions:NSItemProviderFileOptionOpenInPlace
+                                                                                       visibility:NSItemProviderRepresentationVisibilityAll
+                                                                                      loadHandler:^NSProgress *(void (^ completionHandler)(NSURL *, BOOL, NSError *)) {
+                                            completionHandler([NSURL fileURLWithPath:path], NO, nil);
+                                            return nil;
+                                        }];
+                                        
+                                        [outputAttachments addObject:itemProvider];
+                                    }
+                                    
+                                    dispatch_group_leave(self->_attachmentsGroup);
+                                });
                             }];
-                            
-                            [outputAttachments addObject:itemProvider];
-                        }
+                        }];
                         
-                        dispatch_group_leave(self->_attachmentsGroup);
+                    } else {
                         
-                    }];
-                }
-                
-                dispatch_group_leave(self->_attachmentsGroup);
-            }];
+                        [self releaseRenderMemory:kMTExtensionRenderMemory];
+                    }
+                    
+                    dispatch_group_leave(self->_attachmentsGroup);
+                }];
+            });
         }
         
         dispatch_group_notify(_attachmentsGroup, dispatch_get_main_queue(), ^{
             
+            // the views have been drawn on the main thread, so its arena
+            // holds memory that is not part of the render memory budget
+            MTRenderArenaTrim(MTRenderArenaGetCurrent());
+            
             NSExtensionItem *outputItem = [[NSExtensionItem alloc] init];
             [outputItem setAttachments:outputAttachments];
             [context completeRequestReturningItems:[NSArray arrayWithObject:outputItem] completionHandler:nil];
@@ -106,278 +156,247 @@
     }
 }
 
+- (unsigned long long)renderMemoryBudget
+{
+    // extensions are terminated if they use too much memory, so
+    // we only use a part of the memory and never more than the budget
+    unsigned long long memoryLimit = [[NSProcessInfo processInfo] physicalMemory] * kMTExtensionMemoryFraction;
+    
+    return MIN(memoryLimit, kMTExtensionMemoryBudget);
+}
+
+- (NSInteger)maximumConcurrentRenders
+{
+    // every render needs the decoded source image, the scaled image and
+    // the frames of the animation, so only as many renders run at a time
+    // as fit into the memory budget
+    NSInteger memoryRenders = (NSInteger)(_memoryBudget / kMTExtensionRenderMemory);
+    NSInteger maximumRenders = MIN((NSInteger)[[NSProcessInfo processInfo] activeProcessorCount], memoryRenders);
+    
+    return MAX(maximumRenders, 1);
+}
+
+- (unsigned long long)renderMemoryForImage:(NSImage*)image outputSize:(NSSize)outputSize
+{
+    // the decoded source image plus the views, their cached images
+    // and the frames of the animation at the output size
+    NSSize pixelSize = [image pixelSize];
+    unsigned long long imageMemory = (unsigned long long)(pixelSize.width * pixelSize.height * 4);
+    unsigned long long outputMemory = (unsigned long long)(outputSize.width * outputSize.height * 4);
+    
+    return imageMemory + outputMemory * kMTExtensionRenderBuffers;
+}
+
+- (void)reserveRenderMemory:(unsigned long long)size waitUntilAvailable:(BOOL)wait
+{
+    [_memoryCondition lock];
+    
+    // if nothing has been reserved, the render may exceed the
+    // budget, otherwise we would wait forever for large images
+    while (wait && _memoryInUse > 0 && _memoryInUse + size > _memoryBudget) {
+        [_memoryCondition wait];
+    }
+    
+    _memoryInUse += size;
+    [_memoryCondition unlock];
+}
+
+- (void)releaseRenderMemory:(unsigned long long)size
+{
+    [_memoryCondition lock];
+    _memoryInUse -= MIN(size, _memoryInUse);
+    [_memoryCondition broadcast];
+    [_memoryCondition unlock];
+}
+
 - (void)createIconSetFromImageAtURL:(NSURL*)url
                          outputPath:(NSString*)outputFolderPath
+                             preset:(MTRenderPreset*)preset
+                     reservedMemory:(unsigned long long)reservedMemory
                   completionHandler:(void (^) (BOOL success, NSString *path, NSError *error))completionHandler
 {
+    // the reserved memory is released as soon as the files have been
+    // written, so the next attachment can be loaded while the icon set
+    // is being published
+    __block unsigned long long renderMemory = reservedMemory;
+    
+    void (^finishHandler)(BOOL, NSString*, NSError*) = ^(BOOL success, NSString *path, NSError *error) {
+        
+        // the arena of this thread would otherwise keep its memory for the next
+        // render, which is not accounted for once the reservation has been released
+        MTRenderArenaTrim(MTRenderArenaGetCurrent());
+        [self releaseRenderMemory:renderMemory];
+        if (completionHandler) { completionHandler(success, path, error); }
+    };
+    
     if (url && [url isFileURL]) {
         
         NSImage *image = [NSImage imageWithFileAtURL:url];
            
         if ([image isValid]) {
-                                    
-            NSUserDefaults *userDefaults = [[NSUserDefaults alloc] initWithSuiteName:@"7R5ZEU67FQ.corp.sap.Icons"];
-            BOOL useDefaultSettings = [userDefaults boolForKey:kMTDefaultsExtensionDefaultSettingsKey];
             
-            NSDictionary *defaultSettings = [NSDictionary dictionaryWithObjectsAndKeys:
-                                             [NSNumber numberWithInteger:kMTOutputSizeDefault], kMTDefaultsOutputSizeKey,
-                                             [NSNumber numberWithDouble:kMTAnimationDurationDefault], kMTDefaultsAnimationDurationKey,
-                                             [NSNumber numberWithBool:YES], kMTDefaultsAutoImageSizeKey,
-                                             [NSNumber numberWithBool:YES], kMTDefaultsAutoOutputSizeKey,
-                                             [NSNumber numberWithInteger:kMTBannerColorDefault], kMTDefaultsBannerColorKey,
-                                             [NSNumber numberWithInteger:kMTBannerTextColorDefault], kMTDefaultsBannerTextColorKey,
-                                             [NSNumber numberWithBool:YES], kMTDefaultsSaveInstallIconKey,
-                                             [NSNumber numberWithBool:YES], kMTDefaultsSaveUninstallIconKey,
-                                             [NSNumber numberWithBool:YES], kMTDefaultsSaveAnimatedUninstallIconKey,
-                                             [NSNumber numberWithInt:0], kMTDefaultsPositionDefaultKey,
-                                             [NSNumber numberWithBool:NO], kMTDefaultsUsePrefixKey,
-                                             [NSNumber numberWithBool:NO], kMTDefaultsRememberOverlayPositionKey,
-                                             [NSNumber numberWithFloat:kMTBannerTextMarginDefault], kMTDefaultsTextMarginDefaultKey,
-                                             [NSNumber numberWithFloat:kMTBannerAngleDefault], kMTDefaultsBannerAngleDefaultKey,
-                                             [NSNumber numberWithFloat:kMTBannerHeightDefault], kMTDefaultsBannerHeightDefaultKey,
-                                             [NSNumber numberWithFloat:kMTBannerMarginDefault], kMTDefaultsBannerMarginDefaultKey,
-                                             [NSNumber numberWithInteger:kMTBadgeShadowColorDefault], kMTDefaultsBadgeIconShadowColorKey,
-                                             [NSNumber numberWithDouble:kMTBadgeShadowAngleDefault], kMTDefaultsBadgeIconShadowAngleKey,
-                                             [NSNumber numberWithDouble:kMTBadgeShadowOffsetDefault], kMTDefaultsBadgeIconShadowOffsetKey,
-                                             [NSNumber numberWithDouble:kMTBadgeShadowRadiusDefault], kMTDefaultsBadgeIconShadowRadiusKey,
-                                             [NSNumber numberWithDouble:kMTBadgeIconSizeDefault], kMTDefaultsBadgeIconSizeKey,
-                                             [NSNumber numberWithDouble:kMTBadgeIconMarginDefault], kMTDefaultsBadgeIconMarginKey,
-                                             [NSNumber numberWithBool:YES], kMTDefaultsBadgeIconAddShadowKey,
-                                             nil
-                                             ];
-            [userDefaults registerDefaults:defaultSettings];
-
-            dispatch_async(dispatch_get_main_queue(), ^{
-                
-                BOOL isApplicationBundle = YES;
-
-                if (!useDefaultSettings && [userDefaults boolForKey:kMTDefaultsRenderImagesInIconShapeKey]) {
-                    
-                    id utiValue = nil;
-                    [url getResourceValue:&utiValue forKey:NSURLTypeIdentifierKey error:nil];
-                    isApplicationBundle = [utiValue isEqualTo:[UTTypeApplicationBundle identifier]];
-                }
+            BOOL isApplicationBundle = YES;
+            
+            if ([preset appliesIconShape]) {
                 
-                // create the install icon
-                MTInstallIconView *installIconView = nil;
+                id utiValue = nil;
+                [url getResourceValue:&utiValue forKey:NSURLTypeIdentifierKey error:nil];
+                isApplicationBundle = [utiValue isEqualTo:[UTTypeApplicationBundle identifier]];
+            }
+            
+            // calculate output size
+            NSSize outputSize = NSMakeSize([preset outputSize], [preset outputSize]);
+            
+            if ([preset outputSize] == 0) {
                 
-                if (useDefaultSettings || [userDefaults boolForKey:kMTDefaultsSaveInstallIconKey]) {
-                    
-                    installIconView = [[MTInstallIconView alloc] initWithFrame:NSMakeRect(0, 0, kMTOutputSizeMax, kMTOutputSizeMax)];
-                    [installIconView setApplyIconShape:(isApplicationBundle) ? NO : [userDefaults boolForKey:kMTDefaultsRenderImagesInIconShapeKey]];
-                    [installIconView setUsesOldIconShape:[userDefaults boolForKey:kMTDefaultsUseOldIconShapeKey]];
-                    [installIconView setDrawBannerInIconShape:(!isApplicationBundle && [userDefaults boolForKey:kMTDefaultsDrawBannerInIconShapeKey])];
-                    [installIconView setImage:image];
-                    
-                    NSArray *savedBanners = [userDefaults objectForKey:kMTDefaultsSavedBannersKey];
-
-                    if (!useDefaultSettings && savedBanners) {
-                        
-                        NSPredicate *predicate = [NSPredicate predicateWithFormat:@"IsDefault == %@", [NSNumber numberWithBool:YES]];
-                        NSArray *filteredBanners = [savedBanners filteredArrayUsingPredicate:predicate];
+                // auto size
+                for (NSNumber *anOutputSize in [kMTOutputSizes reverseObjectEnumerator]) {
+                    NSSize tempOutputSize = NSMakeSize([anOutputSize floatValue], [anOutputSize floatValue]);
+                    BOOL canBeScaled = [image canBeScaledToSize:tempOutputSize];
                         
-                        if ([filteredBanners count] > 0) {
-                            
-                            NSDictionary *bannerDict = [filteredBanners firstObject];
-                            NSData *bannerData = [bannerDict objectForKey:kMTDefaultsBannerDataKey];
-                            
-                            if (bannerData) {
-                                
-                                NSAttributedString *bannerText = [[NSAttributedString alloc] initWithRTF:bannerData
-                                                                                      documentAttributes:nil
-                                ];
-                                [installIconView setBannerAttributes:bannerText];
-                                [installIconView setBannerPosition:(MTBannerPosition)[[bannerDict valueForKey:kMTDefaultsBannerPositionKey] integerValue]];
-                                
-                                // If the banner was saved with an older version of the application that does
-                                // not support one or more of the following attributes, we will use the default
-                                // values to make sure the banner looks the same as in the old version.
-                                CGFloat textMargin = kMTBannerTextMarginDefault;
-                                CGFloat bannerAngle = kMTBannerAngleDefault;
-                                CGFloat bannerHeight = kMTBannerHeightDefault;
-                                CGFloat bannerMargin = kMTBannerMarginDefault;
-                                
-                                if ([bannerDict objectForKey:kMTDefaultsBannerTextMarginKey]) { textMargin = [[bannerDict valueForKey:kMTDefaultsBannerTextMarginKey] floatValue]; }
-                                if ([bannerDict objectForKey:kMTDefaultsBannerAngleKey]) { bannerAngle = [[bannerDict valueForKey:kMTDefaultsBannerAngleKey] floatValue]; }
-                                if ([bannerDict objectForKey:kMTDefaultsBannerHeightKey]) { bannerHeight = [[bannerDict valueForKey:kMTDefaultsBannerHeightKey] floatValue]; }
-                                if ([bannerDict objectForKey:kMTDefaultsBannerMarginKey]) { bannerMargin = [[bannerDict valueForKey:kMTDefaultsBannerMarginKey] floatValue]; }
-                                    
-                                [installIconView setBannerTextMargin:textMargin];
-                                [installIconView setBannerAngle:bannerAngle];
-                                [installIconView setBannerHeight:bannerHeight];
-                                [installIconView setBannerMargin:bannerMargin];
-                            }
-                        }
+                    if (canBeScaled) {
+                        outputSize = tempOutputSize;
+                        break;
                     }
                 }
+            }
+            
+            // render the views directly at the output size and scale the
+            // source image down once instead of for every view and frame
+            NSRect viewFrame = [MTDropView frameWithContentSize:outputSize];
+            NSImage *renderImage = [image imageByScalingToFitPixelSize:outputSize];
+            if (!renderImage) { renderImage = image; }
+            
+            // now that we know the size of the image, we account for the memory the
+            // render actually needs. We don't wait here, because the render already
+            // holds a reservation, but further attachments are not loaded until
+            // enough memory has been released again
+            unsigned long long estimatedMemory = [self renderMemoryForImage:image outputSize:outputSize];
+            
+            if (estimatedMemory > renderMemory) {
+                [self reserveRenderMemory:estimatedMemory - renderMemory waitUntilAvailable:NO];
+                renderMemory = estimatedMemory;
+            }
+            
+            BOOL createInstallIcon = [preset createsInstallIcon];
+            BOOL createUninstallIcon = ([preset createsUninstallIcon] || [preset createsAnimatedUninstallIcon]);
+            BOOL applyIconShape = (!isApplicationBundle && [preset appliesIconShape]);
+            CGFloat imageInset = [preset imageInset];
+            
+            // calculate inset (if enabled)
+            if (createUninstallIcon && [preset autoImageInset]) { imageInset = [MTUninstallIconView autoInsetWithImage:image]; }
+            
+            NSString *fileNamePrefix = nil;
+            
+            if ([preset usesFileNamePrefix]) {
                 
-                // create the uninstall icon
-                CGFloat animationDuration = 0;
-                MTUninstallIconView *uninstallIconView = nil;
+                // get the prefix
+                fileNamePrefix = [preset fileNamePrefix];
+                if (!fileNamePrefix) { fileNamePrefix = [[url lastPathComponent] stringByDeletingPathExtension]; }
+            }
+            
+            // AppKit views must be drawn on the main thread, so only the views are rendered
+            // there. Decoding, scaling and encoding happen on this (background) thread.
+            // This is a deliberate limitation: the icons are composed by the same NSView
+            // subclasses the app shows (banner text, icon shape, badge), and there is no
+            // CoreGraphics-only renderer for them. So the drawing of concurrent renders is
+            // serialized, just like the render nodes of icons_cli that draw the views
+            __block NSImage *installIcon = nil;
+            __block NSImage *uninstallIcon = nil;
+            
+            dispatch_sync(dispatch_get_main_queue(), ^{
                 
-                if (useDefaultSettings || [userDefaults boolForKey:kMTDefaultsSaveUninstallIconKey] || [userDefaults boolForKey:kMTDefaultsSaveAnimatedUninstallIconKey]) {
-                    
-                    uninstallIconView = [[MTUninstallIconView alloc] initWithFrame:NSMakeRect(0, 0, kMTOutputSizeMax, kMTOutputSizeMax)];
-                    [uninstallIconView setApplyIconShape:(isApplicationBundle) ? NO : [userDefaults boolForKey:kMTDefaultsRenderImagesInIconShapeKey]];
-                    [uninstallIconView setUsesOldIconShape:[userDefaults boolForKey:kMTDefaultsUseOldIconShapeKey]];
-                    [uninstallIconView setImage:image];
-                    
-                    // calculate inset (if enabled)
-                    if (useDefaultSettings || [userDefaults boolForKey:kMTDefaultsAutoImageSizeKey]) {
-                        [uninstallIconView setImageInset:[uninstallIconView autoInset]];
-                    } else {
-                        [uninstallIconView setImageInset:[userDefaults floatForKey:kMTDefaultsImageSizeAdjustmentKey]];
-                    }
+                // the views and their intermediate images are released as soon as
+                // they have been drawn instead of at the end of the run loop cycle
+                @autoreleasepool {
                     
-                    // badge
-                    NSImage *deleteBadgeImage = nil;
+                    // create the install icon
+                    MTInstallIconView *installIconView = nil;
                     
-                    if (!useDefaultSettings) {
+                    if (createInstallIcon) {
                         
-                        NSData *sfSymbol = [userDefaults objectForKey:kMTDefaultsDeleteBadgeSFSymbolKey];
+                        installIconView = [[MTInstallIconView alloc] initWithFrame:viewFrame];
+                        [installIconView setApplyIconShape:applyIconShape];
+                        [installIconView setUsesOldIconShape:[preset usesOldIconShape]];
+                        [installIconView setDrawBannerInIconShape:(applyIconShape && [preset drawsBannerInIconShape])];
+                        [installIconView setImage:renderImage];
                         
-                        if (sfSymbol) {
+                        if ([preset bannerAttributes]) {
                             
-                            deleteBadgeImage = [[NSImage alloc] initWithData:sfSymbol];
-                            
-                        } else {
-                            
-                            NSData *bookmarkData = [userDefaults objectForKey:kMTDefaultsDeleteBadgeIconBookmarkKey];
-                            
-                            BOOL stale = NO;
-                            NSError *error = nil;
-                            
-                            NSURL *deleteBadgeURL = [NSURL URLByResolvingBookmarkData:bookmarkData
-                                                                              options:0
-                                                                        relativeToURL:nil
-                                                                  bookmarkDataIsStale:&stale
-                                                                                error:&error
-                            ];
-                            
-                            if (deleteBadgeURL) {
-                                
-                                if ([deleteBadgeURL startAccessingSecurityScopedResource]) {
-                                    
-                                    deleteBadgeImage = [[NSImage alloc] initWithContentsOfURL:deleteBadgeURL];
-                                    [deleteBadgeURL stopAccessingSecurityScopedResource];
-                                    
-                                } else {
-                                    os_log_error(OS_LOG_DEFAULT, "SAPCorp: Failed to access delete badge url %{public}@", deleteBadgeURL);
-                                }
-                                
-                            } else {
-                                os_log_error(OS_LOG_DEFAULT, "SAPCorp: Failed to get delete badge url: %{public}@", error);
-                            }
+                            [installIconView setBannerAttributes:[preset bannerAttributes]];
+                            [installIconView setBannerPosition:[preset bannerPosition]];
+                            [installIconView setBannerTextMargin:[preset bannerTextMargin]];
+                            [installIconView setBannerAngle:[preset bannerAngle]];
+                            [installIconView setBannerHeight:[preset bannerHeight]];
+                            [installIconView setBannerMargin:[preset bannerMargin]];
                         }
                     }
                     
-                    MTDeleteBadgeView *deleteBadge = [[MTDeleteBadgeView alloc] initWithFrame:[uninstallIconView bounds]];
+                    // create the uninstall icon
+                    MTUninstallIconView *uninstallIconView = nil;
                     
-                    if ([deleteBadgeImage isValid]) {
-                        
-                        // get the badge shadow color
-                        MTColorValueTransformer *valueTransformer = [[MTColorValueTransformer alloc] init];
-                        NSNumber *transformedBannerColor = [userDefaults objectForKey:kMTDefaultsBadgeIconShadowColorKey];
-                        NSColor *badgeShadowColor = [valueTransformer transformedValue:transformedBannerColor];
-                        
-                        CGFloat badgeSize = [userDefaults floatForKey:kMTDefaultsBadgeIconSizeKey];
-                        CGFloat clampedBadgeSize = fminf(fmaxf(badgeSize, kMTBadgeIconSizeMin), kMTBadgeIconSizeMax);
-                        if (fabs(badgeSize - clampedBadgeSize) > FLT_EPSILON) { [userDefaults setFloat:clampedBadgeSize forKey:kMTDefaultsBadgeIconSizeKey]; }
-                        [uninstallIconView setBadgeSize:clampedBadgeSize];
-                        
-                        CGFloat badgeMargin = [userDefaults floatForKey:kMTDefaultsBadgeIconMarginKey];
-                        CGFloat clampedBadgeMargin = fminf(fmaxf(badgeMargin, kMTBadgeIconMarginMin), kMTBadgeIconMarginMax);
-                        if (fabs(badgeMargin - clampedBadgeMargin) > FLT_EPSILON) { [userDefaults setFloat:clampedBadgeMargin forKey:kMTDefaultsBadgeIconMarginKey]; }
-                        [uninstallIconView setBadgeMargin:clampedBadgeMargin];
-                        
-                        CGFloat badgeShadowRadius = [userDefaults floatForKey:kMTDefaultsBadgeIconShadowRadiusKey];
-                        CGFloat clampedRadius = fminf(fmaxf(badgeShadowRadius, kMTBadgeShadowRadiusMin), kMTBadgeShadowRadiusMax);
-                        if (fabs(badgeShadowRadius - clampedRadius) > FLT_EPSILON) { [userDefaults setFloat:clampedRadius forKey:kMTDefaultsBadgeIconShadowRadiusKey]; }
-                        
-                        CGFloat badgeShadowOffset = [userDefaults floatForKey:kMTDefaultsBadgeIconShadowOffsetKey];
-                        CGFloat clampedOffset = fminf(fmaxf(badgeShadowOffset, kMTBadgeShadowOffsetMin), kMTBadgeShadowOffsetMax);
-                        if (fabs(badgeShadowOffset - clampedOffset) > FLT_EPSILON) { [userDefaults setFloat:clampedOffset forKey:kMTDefaultsBadgeIconShadowOffsetKey]; }
+                    if (createUninstallIcon) {
                         
-                        CGFloat badgeShadowAngle = [userDefaults floatForKey:kMTDefaultsBadgeIconShadowAngleKey];
-                        CGFloat clampedAngle = fminf(fmaxf(badgeShadowAngle, kMTBadgeShadowAngleMin), kMTBadgeShadowAngleMax);
-                        if (fabs(badgeShadowAngle - clampedAngle) > FLT_EPSILON) { [userDefaults setFloat:clampedAngle forKey:kMTDefaultsBadgeIconShadowAngleKey]; }
+                        uninstallIconView = [[MTUninstallIconView alloc] initWithFrame:viewFrame];
+                        [uninstallIconView setApplyIconShape:applyIconShape];
+                        [uninstallIconView setUsesOldIconShape:[preset usesOldIconShape]];
+                        [uninstallIconView setImage:renderImage];
+                        [uninstallIconView setImageInset:imageInset];
                         
-                        [deleteBadge setImage:deleteBadgeImage];
-                        [deleteBadge setShowsShadow:[userDefaults boolForKey:kMTDefaultsBadgeIconAddShadowKey]];
-                        [deleteBadge setShadowRadius:clampedRadius];
-                        [deleteBadge setShadowOffset:clampedOffset];
-                        [deleteBadge setShadowAngle:clampedAngle];
-                        [deleteBadge setShadowColor:badgeShadowColor];
+                        MTDeleteBadgeView *deleteBadge = [[MTDeleteBadgeView alloc] initWithFrame:[uninstallIconView bounds]];
                         
-                        [uninstallIconView setBadgePosition:(MTBadgePosition)[userDefaults integerForKey:kMTDefaultsBadgePositionDefaultKey]];
-                    }
-                        
-                    [uninstallIconView setDeleteBadge:deleteBadge];
-                                        
-                    // get the animation duration
-                    animationDuration = (useDefaultSettings) ? kMTAnimationDurationDefault : [userDefaults floatForKey:kMTDefaultsAnimationDurationKey];
-                    animationDuration = fminf(fmaxf(animationDuration, kMTAnimationDurationMin), kMTAnimationDurationMax);
-                }
-                
-                // calculate output size
-                NSSize outputSize = NSZeroSize;
-                
-                if (useDefaultSettings || [userDefaults boolForKey:kMTDefaultsAutoOutputSizeKey]) {
-                    
-                    // auto size
-                    for (NSNumber *anOutputSize in [kMTOutputSizes reverseObjectEnumerator]) {
-                        NSSize tempOutputSize = NSMakeSize([anOutputSize floatValue], [anOutputSize floatValue]);
-                        BOOL canBeScaled = [image canBeScaledToSize:tempOutputSize];
+                        if ([preset deleteBadgeImage]) {
                             
-                        if (canBeScaled) {
-                            outputSize = tempOutputSize;
-                            break;
+                            [uninstallIconView setBadgeSize:[preset badgeSize]];
+                            [uninstallIconView setBadgeMargin:[preset badgeMargin]];
+                            [uninstallIconView setBadgePosition:[preset badgePosition]];
+                            
+                            [deleteBadge setImage:[preset deleteBadgeImage]];
+                            [deleteBadge setShowsShadow:[preset badgeShowsShadow]];
+                            [deleteBadge setShadowRadius:[preset badgeShadowRadius]];
+                            [deleteBadge setShadowOffset:[preset badgeShadowOffset]];
+                            [deleteBadge setShadowAngle:[preset badgeShadowAngle]];
+                            [deleteBadge setShadowColor:[preset badgeShadowColor]];
                         }
+                            
+                        [uninstallIconView setDeleteBadge:deleteBadge];
                     }
                     
-                } else {
-                    
-                    NSInteger imageOutputSize = [userDefaults integerForKey:kMTDefaultsOutputSizeKey];
-                    if (![kMTOutputSizes containsObject:[NSNumber numberWithInteger:imageOutputSize]]) { imageOutputSize = kMTOutputSizeDefault; }
-                    imageOutputSize = fminf(fmaxf(imageOutputSize, kMTOutputSizeMin), kMTOutputSizeMax);
-                    outputSize = NSMakeSize(imageOutputSize, imageOutputSize);
+                    installIcon = [NSImage imageWithView:[installIconView icon] size:outputSize];
+                    uninstallIcon = [NSImage imageWithView:[uninstallIconView icon] size:outputSize];
                 }
+            });
+            
+            // the source image is not needed anymore, so
+            // we release it before the frames are encoded
+            image = nil;
+            renderImage = nil;
+            
+            // create the icon files
+            MTIconSet *iconSet = [[MTIconSet alloc] init];
+            [iconSet setInstallIcon:installIcon];
+            [iconSet setUninstallIcon:uninstallIcon];
+            [iconSet setAnimationDuration:([preset createsAnimatedUninstallIcon]) ? [preset animationDuration] : 0];
+            [iconSet setFileNamePrefix:fileNamePrefix];
+            
+            [iconSet writeToFolder:outputFolderPath
+                      createFolder:YES
+                      animatedOnly:![preset createsUninstallIcon]
+                 completionHandler:^(BOOL success, NSString *path, NSError *error) {
                 
-                NSString *fileNamePrefix = nil;
-                
-                if (!useDefaultSettings && [userDefaults boolForKey:kMTDefaultsUsePrefixKey]) {
-                    
-                    // get the prefix
-                    fileNamePrefix = [userDefaults stringForKey:kMTDefaultsUserDefinedPrefixKey];
-                    if (!fileNamePrefix) { fileNamePrefix = [[url lastPathComponent] stringByDeletingPathExtension]; }
-                }
-                        
-                // create the icon files
-                MTIconSet *iconSet = [[MTIconSet alloc] init];
-                [iconSet setInstallIcon:[NSImage imageWithView:[installIconView icon] size:outputSize]];
-                [iconSet setUninstallIcon:[NSImage imageWithView:[uninstallIconView icon] size:outputSize]];
-                [iconSet setAnimationDuration:(useDefaultSettings || [userDefaults boolForKey:kMTDefaultsSaveAnimatedUninstallIconKey]) ? animationDuration : 0];
-                [iconSet setFileNamePrefix:fileNamePrefix];
-
-                [iconSet writeToFolder:outputFolderPath
-                          createFolder:YES
-                          animatedOnly:!(useDefaultSettings || [userDefaults boolForKey:kMTDefaultsSaveUninstallIconKey])
-                     completionHandler:^(BOOL success, NSString *path, NSError *error) {
-                    
-                    if (completionHandler) { completionHandler(success, path, error); }
-                }];
-           });
+                finishHandler(success, path, error);
+            }];
             
         } else {
             
             NSError *error = [NSError errorWithDomain:NSOSStatusErrorDomain code:paramErr userInfo:nil];
-            if (completionHandler) { completionHandler(NO, nil, error); }
+            finishHandler(NO, nil, error);
         }
         
     } else {
         
         NSError *error = [NSError errorWithDomain:NSOSStatusErrorDomain code:paramErr userInfo:nil];
-        if (completionHandler) { completionHandler(NO, nil, error); }
+        finishHandler(NO, nil, error);
     }
 }
 
@@ -0,0 +1,62 @@
+/*
+    MTAppScanner.h
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @class         MTAppScanner
+ @abstract      A class that finds application bundles in a number of folders.
+ @discussion    The folders are read by a fixed number of worker threads that share a single queue of pending
+                folders, so all root folders are traversed at the same time and slow folders (e.g. on network
+                volumes) do not block the others. Application bundles are identified by their file extension,
+                without descending into them. Symbolic links are not followed. The bundles are reported in the
+                order of their paths, no matter in which order the folders have been read. A bundle is reported
+                as soon as all folders that may contain a bundle with a smaller path have been read. The pending
+                folders are read in the order of their paths, so this happens while the scan is still running.
+*/
+
+@interface MTAppScanner : NSObject
+
+/*!
+ @method        init:
+ @discussion    The init method is not available. Please use initWithFolderURLs:maxConcurrentFolders: instead.
+*/
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        initWithFolderURLs:maxConcurrentFolders:
+ @abstract      Initialize a MTAppScanner object with the given root folders.
+ @param         folderURLs An array of urls of the folders that should be scanned.
+ @param         maxConcurrentFolders The maximum number of folders that are read at the same time.
+ @discussion    Returns an initialized MTAppScanner object.
+*/
+- (instancetype)initWithFolderURLs:(NSArray*)folderURLs maxConcurrentFolders:(NSUInteger)maxConcurrentFolders NS_DESIGNATED_INITIALIZER;
+
+/*!
+ @method        scanWithBundleHandler:completionHandler:
+ @abstract      Scan the folders for application bundles.
+ @param         bundleHandler The handler that is called for every application bundle that has been found. It is
+                called on one of the worker threads, one bundle at a time and in the order of the bundles' paths. A
+                handler that blocks (e.g. because the consumer of the bundles is busy) also slows down the scan.
+ @param         completionHandler The handler that is called on a global dispatch queue after all folders have been
+                scanned. It gets the number of folders that have been read and the number of bundles that have been found.
+ @discussion    This method returns immediately.
+*/
+- (void)scanWithBundleHandler:(void (^)(NSURL *bundleURL))bundleHandler
+            completionHandler:(void (^)(NSUInteger folderCount, NSUInteger bundleCount))completionHandler;
+
+@end
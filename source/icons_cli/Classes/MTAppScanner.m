@@ -0,0 +1,222 @@
+/*
+    MTAppScanner.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTAppScanner.h"
+#import "MTTrace.h"
+
+@interface MTAppScanner ()
+@property (nonatomic, strong, readwrite) NSArray *folderURLs;
+@property (nonatomic, assign) NSUInteger maxConcurrentFolders;
+@end
+
+@implementation MTAppScanner
+{
+    NSCondition *_condition;
+    NSMutableArray *_pendingFolders;
+    NSMutableArray *_activeFolders;
+    NSMutableArray *_foundBundles;
+    NSUInteger _activeWorkers;
+    NSUInteger _folderCount;
+    NSUInteger _bundleCount;
+}
+
+- (instancetype)initWithFolderURLs:(NSArray*)folderURLs maxConcurrentFolders:(NSUInteger)maxConcurrentFolders
+{
+    self = [super init];
+
+    if (self) {
+
+        _folderURLs = folderURLs;
+        _maxConcurrentFolders = MAX(maxConcurrentFolders, 1);
+        _condition = [[NSCondition alloc] init];
+        _pendingFolders = [[NSMutableArray alloc] init];
+        _activeFolders = [[NSMutableArray alloc] init];
+        _foundBundles = [[NSMutableArray alloc] init];
+    }
+
+    return self;
+}
+
+- (void)scanWithBundleHandler:(void (^)(NSURL *bundleURL))bundleHandler
+            completionHandler:(void (^)(NSUInteger folderCount, NSUInteger bundleCount))completionHandler
+{
+    MTTraceTimestamp traceBegin = MTTraceBegin();
+
+    [_condition lock];
+    [_pendingFolders setArray:_folderURLs];
+    [_pendingFolders sortUsingComparator:[self pendingFolderComparator]];
+    [_activeFolders removeAllObjects];
+    [_foundBundles removeAllObjects];
+    _activeWorkers = 0;
+    _folderCount = 0;
+    _bundleCount = 0;
+    [_condition unlock];
+
+    // the workers block while they wait for more folders, so they run on threads
+    // of their own instead of occupying the limited number of threads of the
+    // global dispatch queues other work (e.g. decoding the apps) depends on
+    dispatch_group_t workerGroup = dispatch_group_create();
+
+    for (NSUInteger i = 0; i < _maxConcurrentFolders; i++) {
+
+        dispatch_group_enter(workerGroup);
+
+        NSThread *workerThread = [[NSThread alloc] initWithBlock:^{
+            [self runWorkerWithBundleHandler:bundleHandler];
+            dispatch_group_leave(workerGroup);
+        }];
+
+        [workerThread setName:@"corp.sap.Icons.AppScanner"];
+        [workerThread setQualityOfService:NSQualityOfServiceUtility];
+        [workerThread start];
+    }
+
+    dispatch_group_notify(workerGroup, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+
+        MTTraceEnd("scan folders", traceBegin);
+        if (completionHandler) { completionHandler(self->_folderCount, self->_bundleCount); }
+    });
+}
+
+- (NSComparator)pendingFolderComparator
+{
+    // the pending folders are sorted in descending order, so the
+    // folder with the smallest path can be removed from the end
+    return ^NSComparisonResult(NSURL *url1, NSURL *url2) {
+        return [[url2 path] compare:[url1 path]];
+    };
+}
+
+- (void)reportBundlesWithHandler:(void (^)(NSURL *bundleURL))bundleHandler
+{
+    // a folder that has not been read completely may still contain bundles whose
+    // paths start with the folder's path, so all bundles with a smaller path than
+    // the smallest of these prefixes are final and can be reported
+    NSString *reportLimit = nil;
+    NSMutableArray *unreadFolders = [NSMutableArray arrayWithArray:_activeFolders];
+    if ([_pendingFolders count] > 0) { [unreadFolders addObject:[_pendingFolders lastObject]]; }
+
+    for (NSURL *folderURL in unreadFolders) {
+
+        NSString *folderPrefix = [folderURL path];
+        if (![folderPrefix hasSuffix:@"/"]) { folderPrefix = [folderPrefix stringByAppendingString:@"/"]; }
+        if (!reportLimit || [folderPrefix compare:reportLimit] == NSOrderedAscending) { reportLimit = folderPrefix; }
+    }
+
+    NSUInteger reportCount = 0;
+
+    for (NSURL *bundleURL in _foundBundles) {
+
+        if (reportLimit && [[bundleURL path] compare:reportLimit] != NSOrderedAscending) { break; }
+        if (bundleHandler) { bundleHandler(bundleURL); }
+        reportCount++;
+    }
+
+    [_foundBundles removeObjectsInRange:NSMakeRange(0, reportCount)];
+}
+
+- (void)runWorkerWithBundleHandler:(void (^)(NSURL *bundleURL))bundleHandler
+{
+    NSArray *resourceKeys = [NSArray arrayWithObjects:NSURLIsDirectoryKey, NSURLIsSymbolicLinkKey, nil];
+
+    while (YES) {
+
+        NSURL *folderURL = nil;
+
+        [_condition lock];
+
+        // wait for more folders as long as other workers may still find some
+        while ([_pendingFolders count] == 0 && _activeWorkers > 0) { [_condition wait]; }
+
+        if ([_pendingFolders count] > 0) {
+
+            folderURL = [_pendingFolders lastObject];
+            [_pendingFolders removeLastObject];
+            [_activeFolders addObject:folderURL];
+            _activeWorkers++;
+            _folderCount++;
+        }
+
+        [_condition unlock];
+
+        // no pending folders and no active workers, so we are done
+        if (!folderURL) {
+
+            [_condition lock];
+            [_condition broadcast];
+            [_condition unlock];
+
+            break;
+        }
+
+        NSMutableArray *subfolderURLs = [NSMutableArray array];
+        NSMutableArray *bundleURLs = [NSMutableArray array];
+
+        @autoreleasepool {
+
+            // the resource values are fetched together with the folder
+            // contents, so we don't need an additional stat per entry
+            NSArray *contents = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:folderURL
+                                                              includingPropertiesForKeys:resourceKeys
+                                                                                 options:NSDirectoryEnumerationSkipsHiddenFiles
+                                                                                   error:nil
+            ];
+
+            for (NSURL *itemURL in contents) {
+
+                NSNumber *isDirectory = nil;
+                NSNumber *isSymbolicLink = nil;
+                [itemURL getResourceValue:&isDirectory forKey:NSURLIsDirectoryKey error:nil];
+                [itemURL getResourceValue:&isSymbolicLink forKey:NSURLIsSymbolicLinkKey error:nil];
+
+                if ([isDirectory boolValue] && ![isSymbolicLink boolValue]) {
+
+                    if ([[[itemURL pathExtension] lowercaseString] isEqualToString:@"app"]) {
+
+                        [bundleURLs addObject:itemURL];
+
+                    } else {
+
+                        [subfolderURLs addObject:itemURL];
+                    }
+                }
+            }
+        }
+
+        [_condition lock];
+
+        [_pendingFolders addObjectsFromArray:subfolderURLs];
+        [_pendingFolders sortUsingComparator:[self pendingFolderComparator]];
+        [_activeFolders removeObjectIdenticalTo:folderURL];
+
+        [_foundBundles addObjectsFromArray:bundleURLs];
+        [_foundBundles sortUsingComparator:^NSComparisonResult(NSURL *url1, NSURL *url2) {
+            return [[url1 path] compare:[url2 path]];
+        }];
+
+        // the handler is called while we hold the lock, so
+        // the bundles are reported one at a time and in order
+        [self reportBundlesWithHandler:bundleHandler];
+
+        _bundleCount += [bundleURLs count];
+        _activeWorkers--;
+        [_condition broadcast];
+        [_condition unlock];
+    }
+}
+
+@end
@@ -0,0 +1,85 @@
+/*
+    MTArchiveWriter.h
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+#import "MTBatchWriter.h"
+
+/*!
+ @enum          MTArchiveFormat
+ @abstract      Specifies the format of an archive.
+ @constant      MTArchiveFormatTar A POSIX (ustar) tar archive. Long file names are stored in pax headers.
+ @constant      MTArchiveFormatZip A zip archive with deflated entries. Entries that do not get smaller are stored.
+ @constant      MTArchiveFormatZipStored A zip archive with uncompressed entries.
+ @constant      MTArchiveFormatStream A framed multi-part stream for pipelines. Every entry consists of the length
+                of the file name (32 bit), the UTF-8 encoded file name, the length of the file's contents (64 bit) and
+                the contents themselves. All lengths are big-endian. The stream ends with a file name length of 0.
+*/
+typedef NS_ENUM(NSUInteger, MTArchiveFormat) {
+    MTArchiveFormatTar       = 0,
+    MTArchiveFormatZip       = 1,
+    MTArchiveFormatZipStored = 2,
+    MTArchiveFormatStream    = 3
+};
+
+/*!
+ @class         MTArchiveWriter
+ @abstract      A class that streams groups of files into a single tar or zip archive or a framed stream.
+ @discussion    The entries of a group are written (sorted by file name) as soon as the group is added, so nothing
+                has to be seeked back to and the archive can be written to a pipe. All entries get the same
+                timestamp (the value of the SOURCE_DATE_EPOCH environment variable or the earliest timestamp the
+                format supports), so the same files always result in the same archive.
+*/
+
+@interface MTArchiveWriter : NSObject <MTFileGroupWriter>
+
+/*!
+ @method        init:
+ @discussion    The init method is not available. Please use initWithFileDescriptor:format: instead.
+*/
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        initWithFileDescriptor:format:
+ @abstract      Initialize a MTArchiveWriter object that writes to the given file descriptor.
+ @param         fileDescriptor The file descriptor the archive should be written to. The archive writer takes
+                ownership of the file descriptor and closes it when the archive is closed.
+ @param         format The format of the archive.
+ @discussion    Returns an initialized MTArchiveWriter object.
+*/
+- (instancetype)initWithFileDescriptor:(int)fileDescriptor format:(MTArchiveFormat)format NS_DESIGNATED_INITIALIZER;
+
+/*!
+ @method        addFiles:completionHandler:
+ @abstract      Write a group of files to the archive.
+ @param         files A dictionary containing the contents (NSData) of the files, keyed by their file names.
+ @param         completionHandler The handler that is called after the entries have been written or if an error
+                occurred. May be nil.
+ @discussion    The entries are written before this method returns. Once an error occurred, no further entries are
+                written.
+*/
+- (void)addFiles:(NSDictionary*)files completionHandler:(void (^) (BOOL success, NSError *error))completionHandler;
+
+/*!
+ @method        close
+ @abstract      Finish the archive.
+ @discussion    Writes the end of the archive (the central directory of a zip archive or the end-of-archive blocks
+                of a tar archive or the end marker of a stream) and closes the file descriptor. No further files can be added afterwards. Returns
+                YES if the archive has been written successfully, otherwise returns NO.
+*/
+- (BOOL)close;
+
+@end
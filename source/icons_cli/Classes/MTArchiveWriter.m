@@ -0,0 +1,452 @@
+/*
+    MTArchiveWriter.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTArchiveWriter.h"
+#import "MTTrace.h"
+#import <compression.h>
+#import <sys/uio.h>
+#import <unistd.h>
+#import <time.h>
+
+#define kMTTarBlockSize             512
+#define kMTZipVersion               20
+#define kMTZipVersionZip64          45
+#define kMTZipFlagUTF8              0x0800
+#define kMTZipMethodStored          0
+#define kMTZipMethodDeflated        8
+
+@interface MTArchiveWriter ()
+@property (nonatomic, assign) int fileDescriptor;
+@property (nonatomic, assign) MTArchiveFormat format;
+@end
+
+@implementation MTArchiveWriter
+{
+    uint64_t _offset;
+    uint64_t _entryCount;
+    NSMutableData *_centralDirectory;
+    NSMutableData *_scratchBuffer;
+    NSError *_error;
+    time_t _timestamp;
+    BOOL _groupFailed;
+    BOOL _closed;
+}
+
+static void appendUInt16(NSMutableData *data, uint16_t value)
+{
+    value = OSSwapHostToLittleInt16(value);
+    [data appendBytes:&value length:sizeof(value)];
+}
+
+static void appendUInt32(NSMutableData *data, uint32_t value)
+{
+    value = OSSwapHostToLittleInt32(value);
+    [data appendBytes:&value length:sizeof(value)];
+}
+
+static void appendUInt64(NSMutableData *data, uint64_t value)
+{
+    value = OSSwapHostToLittleInt64(value);
+    [data appendBytes:&value length:sizeof(value)];
+}
+
+static uint32_t crc32WithData(NSData *data)
+{
+    static uint32_t table[256];
+    static dispatch_once_t onceToken;
+
+    dispatch_once(&onceToken, ^{
+
+        for (uint32_t i = 0; i < 256; i++) {
+
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; bit++) { value = (value & 1) ? (0xedb88320 ^ (value >> 1)) : (value >> 1); }
+            table[i] = value;
+        }
+    });
+
+    const UInt8 *bytes = [data bytes];
+    uint32_t crc = 0xffffffff;
+
+    for (NSUInteger i = 0; i < [data length]; i++) { crc = table[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8); }
+
+    return crc ^ 0xffffffff;
+}
+
+- (instancetype)initWithFileDescriptor:(int)fileDescriptor format:(MTArchiveFormat)format
+{
+    self = [super init];
+
+    if (self) {
+
+        _fileDescriptor = fileDescriptor;
+        _format = format;
+        _centralDirectory = [[NSMutableData alloc] init];
+
+        // all entries get the same timestamp, so the archive only depends on the contents of the files
+        const char *sourceDateEpoch = getenv("SOURCE_DATE_EPOCH");
+        _timestamp = (sourceDateEpoch) ? (time_t)MAX(strtoll(sourceDateEpoch, NULL, 10), 0) : 0;
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [self close];
+}
+
+- (BOOL)writeData:(NSArray*)dataArray
+{
+    struct iovec vectors[[dataArray count]];
+    int vectorCount = 0;
+
+    for (NSData *data in dataArray) {
+
+        if ([data length] > 0) {
+
+            vectors[vectorCount].iov_base = (void*)[data bytes];
+            vectors[vectorCount].iov_len = [data length];
+            vectorCount++;
+        }
+    }
+
+    // write the header, the data and the padding of an entry with a single call
+    struct iovec *currentVector = vectors;
+
+    while (vectorCount > 0) {
+
+        ssize_t writtenLength = writev(_fileDescriptor, currentVector, vectorCount);
+
+        if (writtenLength < 0) {
+
+            if (errno == EINTR) { continue; }
+            _error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+            return NO;
+        }
+
+        _offset += writtenLength;
+
+        while (vectorCount > 0 && (size_t)writtenLength >= currentVector->iov_len) {
+
+            writtenLength -= currentVector->iov_len;
+            currentVector++;
+            vectorCount--;
+        }
+
+        if (vectorCount > 0) {
+
+            currentVector->iov_base = (UInt8*)currentVector->iov_base + writtenLength;
+            currentVector->iov_len -= writtenLength;
+        }
+    }
+
+    return YES;
+}
+
+#pragma mark tar
+
+static void setOctalField(char *field, size_t fieldSize, uint64_t value)
+{
+    snprintf(field, fieldSize, "%0*llo", (int)fieldSize - 1, (unsigned long long)value);
+}
+
+- (NSData*)tarHeaderWithName:(NSData*)name size:(uint64_t)size type:(char)type
+{
+    NSMutableData *header = [NSMutableData dataWithLength:kMTTarBlockSize];
+    char *fields = [header mutableBytes];
+
+    memcpy(fields, [name bytes], MIN([name length], 100));
+    setOctalField(fields + 100, 8, 0644);
+    setOctalField(fields + 108, 8, 0);
+    setOctalField(fields + 116, 8, 0);
+    setOctalField(fields + 124, 12, size);
+    setOctalField(fields + 136, 12, _timestamp);
+    fields[156] = type;
+    memcpy(fields + 257, "ustar", 6);
+    memcpy(fields + 263, "00", 2);
+
+    // the checksum is calculated with the checksum field set to spaces
+    memset(fields + 148, ' ', 8);
+    uint32_t checksum = 0;
+    for (NSUInteger i = 0; i < kMTTarBlockSize; i++) { checksum += (UInt8)fields[i]; }
+    snprintf(fields + 148, 8, "%06o", checksum);
+    fields[155] = ' ';
+
+    return header;
+}
+
+- (NSData*)tarPaddingWithSize:(uint64_t)size
+{
+    NSUInteger remainder = size % kMTTarBlockSize;
+    return [NSMutableData dataWithLength:(remainder > 0) ? kMTTarBlockSize - remainder : 0];
+}
+
+- (BOOL)writeTarEntryWithName:(NSData*)name data:(NSData*)data
+{
+    BOOL success = YES;
+
+    if ([name length] > 100) {
+
+        // names that don't fit into the header are stored in a pax
+        // header. The length of a record includes its own length
+        NSString *path = [[NSString alloc] initWithData:name encoding:NSUTF8StringEncoding];
+        NSUInteger recordLength = [name length] + 7;
+        NSUInteger lengthDigits = 1;
+        while ([[NSString stringWithFormat:@"%lu", (unsigned long)(recordLength + lengthDigits)] length] > lengthDigits) { lengthDigits++; }
+
+        NSData *record = [[NSString stringWithFormat:@"%lu path=%@\n", (unsigned long)(recordLength + lengthDigits), path] dataUsingEncoding:NSUTF8StringEncoding];
+        NSData *paxName = [@"././@PaxHeader" dataUsingEncoding:NSUTF8StringEncoding];
+
+        success = [self writeData:[NSArray arrayWithObjects:
+                                   [self tarHeaderWithName:paxName size:[record length] type:'x'],
+                                   record,
+                                   [self tarPaddingWithSize:[record length]],
+                                   nil
+                                  ]
+        ];
+    }
+
+    if (success) {
+
+        success = [self writeData:[NSArray arrayWithObjects:
+                                   [self tarHeaderWithName:name size:[data length] type:'0'],
+                                   data,
+                                   [self tarPaddingWithSize:[data length]],
+                                   nil
+                                  ]
+        ];
+    }
+
+    return success;
+}
+
+#pragma mark zip
+
+- (BOOL)writeZipEntryWithName:(NSData*)name data:(NSData*)data
+{
+    if ([data length] >= UINT32_MAX || [name length] > UINT16_MAX) {
+
+        _error = [NSError errorWithDomain:NSPOSIXErrorDomain code:EFBIG userInfo:nil];
+        return NO;
+    }
+
+    uint32_t crc = crc32WithData(data);
+    uint16_t method = kMTZipMethodStored;
+    NSData *entryData = data;
+
+    if (_format == MTArchiveFormatZip && [data length] > 0) {
+
+        // COMPRESSION_ZLIB produces a raw deflate stream. If the
+        // result would not be smaller, the entry is stored instead
+        if (!_scratchBuffer) { _scratchBuffer = [NSMutableData dataWithLength:compression_encode_scratch_buffer_size(COMPRESSION_ZLIB)]; }
+        NSMutableData *compressedData = [NSMutableData dataWithLength:[data length]];
+
+        size_t compressedLength = compression_encode_buffer([compressedData mutableBytes], [compressedData length],
+                                                            [data bytes], [data length],
+                                                            [_scratchBuffer mutableBytes], COMPRESSION_ZLIB
+                                                            );
+
+        if (compressedLength > 0 && compressedLength < [data length]) {
+
+            [compressedData setLength:compressedLength];
+            entryData = compressedData;
+            method = kMTZipMethodDeflated;
+        }
+    }
+
+    // dos timestamps start in 1980
+    struct tm time;
+    gmtime_r(&_timestamp, &time);
+    uint16_t dosTime = 0;
+    uint16_t dosDate = (1 << 5) | 1;
+
+    if (time.tm_year >= 80) {
+
+        dosTime = (uint16_t)((time.tm_hour << 11) | (time.tm_min << 5) | (time.tm_sec / 2));
+        dosDate = (uint16_t)((MIN(time.tm_year - 80, 127) << 9) | ((time.tm_mon + 1) << 5) | time.tm_mday);
+    }
+
+    uint64_t headerOffset = _offset;
+    BOOL needsZip64 = (headerOffset >= UINT32_MAX);
+
+    NSMutableData *localHeader = [NSMutableData data];
+    appendUInt32(localHeader, 0x04034b50);
+    appendUInt16(localHeader, kMTZipVersion);
+    appendUInt16(localHeader, kMTZipFlagUTF8);
+    appendUInt16(localHeader, method);
+    appendUInt16(localHeader, dosTime);
+    appendUInt16(localHeader, dosDate);
+    appendUInt32(localHeader, crc);
+    appendUInt32(localHeader, (uint32_t)[entryData length]);
+    appendUInt32(localHeader, (uint32_t)[data length]);
+    appendUInt16(localHeader, (uint16_t)[name length]);
+    appendUInt16(localHeader, 0);
+    [localHeader appendData:name];
+
+    BOOL success = [self writeData:[NSArray arrayWithObjects:localHeader, entryData, nil]];
+
+    if (success) {
+
+        // the central directory is written when the archive is closed
+        appendUInt32(_centralDirectory, 0x02014b50);
+        appendUInt16(_centralDirectory, (3 << 8) | kMTZipVersionZip64);
+        appendUInt16(_centralDirectory, (needsZip64) ? kMTZipVersionZip64 : kMTZipVersion);
+        appendUInt16(_centralDirectory, kMTZipFlagUTF8);
+        appendUInt16(_centralDirectory, method);
+        appendUInt16(_centralDirectory, dosTime);
+        appendUInt16(_centralDirectory, dosDate);
+        appendUInt32(_centralDirectory, crc);
+        appendUInt32(_centralDirectory, (uint32_t)[entryData length]);
+        appendUInt32(_centralDirectory, (uint32_t)[data length]);
+        appendUInt16(_centralDirectory, (uint16_t)[name length]);
+        appendUInt16(_centralDirectory, (needsZip64) ? 12 : 0);
+        appendUInt16(_centralDirectory, 0);
+        appendUInt16(_centralDirectory, 0);
+        appendUInt16(_centralDirectory, 0);
+        appendUInt32(_centralDirectory, (uint32_t)(0100644 << 16));
+        appendUInt32(_centralDirectory, (needsZip64) ? UINT32_MAX : (uint32_t)headerOffset);
+        [_centralDirectory appendData:name];
+
+        if (needsZip64) {
+
+            appendUInt16(_centralDirectory, 0x0001);
+            appendUInt16(_centralDirectory, 8);
+            appendUInt64(_centralDirectory, headerOffset);
+        }
+    }
+
+    return success;
+}
+
+- (BOOL)writeZipEnd
+{
+    uint64_t directoryOffset = _offset;
+    uint64_t directorySize = [_centralDirectory length];
+    NSMutableData *end = [NSMutableData data];
+
+    if (_entryCount >= UINT16_MAX || directoryOffset >= UINT32_MAX || directorySize >= UINT32_MAX) {
+
+        // zip64 end of central directory record and locator
+        uint64_t recordOffset = directoryOffset + directorySize;
+
+        appendUInt32(end, 0x06064b50);
+        appendUInt64(end, 44);
+        appendUInt16(end, (3 << 8) | kMTZipVersionZip64);
+        appendUInt16(end, kMTZipVersionZip64);
+        appendUInt32(end, 0);
+        appendUInt32(end, 0);
+        appendUInt64(end, _entryCount);
+        appendUInt64(end, _entryCount);
+        appendUInt64(end, directorySize);
+        appendUInt64(end, directoryOffset);
+
+        appendUInt32(end, 0x07064b50);
+        appendUInt32(end, 0);
+        appendUInt64(end, recordOffset);
+        appendUInt32(end, 1);
+    }
+
+    appendUInt32(end, 0x06054b50);
+    appendUInt16(end, 0);
+    appendUInt16(end, 0);
+    appendUInt16(end, (uint16_t)MIN(_entryCount, UINT16_MAX));
+    appendUInt16(end, (uint16_t)MIN(_entryCount, UINT16_MAX));
+    appendUInt32(end, (uint32_t)MIN(directorySize, UINT32_MAX));
+    appendUInt32(end, (uint32_t)MIN(directoryOffset, UINT32_MAX));
+    appendUInt16(end, 0);
+
+    return [self writeData:[NSArray arrayWithObjects:_centralDirectory, end, nil]];
+}
+
+#pragma mark stream
+
+- (BOOL)writeStreamEntryWithName:(NSData*)name data:(NSData*)data
+{
+    NSMutableData *header = [NSMutableData data];
+    uint32_t nameLength = OSSwapHostToBigInt32((uint32_t)[name length]);
+    uint64_t dataLength = OSSwapHostToBigInt64((uint64_t)[data length]);
+
+    [header appendBytes:&nameLength length:sizeof(nameLength)];
+    [header appendData:name];
+    [header appendBytes:&dataLength length:sizeof(dataLength)];
+
+    return [self writeData:[NSArray arrayWithObjects:header, data, nil]];
+}
+
+#pragma mark MTFileGroupWriter
+
+- (void)addFiles:(NSDictionary*)files completionHandler:(void (^) (BOOL success, NSError *error))completionHandler
+{
+    MTTraceTimestamp traceBegin = MTTraceBegin();
+    BOOL success = (!_error && !_closed);
+
+    for (NSString *fileName in [[files allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+
+        if (!success) { break; }
+
+        NSData *name = [fileName dataUsingEncoding:NSUTF8StringEncoding];
+        NSData *data = [files objectForKey:fileName];
+
+        if (_format == MTArchiveFormatTar) {
+            success = [self writeTarEntryWithName:name data:data];
+        } else if (_format == MTArchiveFormatStream) {
+            success = [self writeStreamEntryWithName:name data:data];
+        } else {
+            success = [self writeZipEntryWithName:name data:data];
+        }
+
+        if (success) { _entryCount++; }
+    }
+
+    MTTraceEnd("write archive entries", traceBegin);
+
+    if (!success) { _groupFailed = YES; }
+    if (completionHandler) { completionHandler(success, (success) ? nil : _error); }
+}
+
+- (BOOL)flush
+{
+    BOOL success = !_groupFailed;
+    _groupFailed = NO;
+
+    return success;
+}
+
+- (BOOL)close
+{
+    if (!_closed && !_error) {
+
+        if (_format == MTArchiveFormatTar) {
+            [self writeData:[NSArray arrayWithObject:[NSMutableData dataWithLength:2 * kMTTarBlockSize]]];
+        } else if (_format == MTArchiveFormatStream) {
+            [self writeData:[NSArray arrayWithObject:[NSMutableData dataWithLength:sizeof(uint32_t)]]];
+        } else {
+            [self writeZipEnd];
+        }
+    }
+
+    if (!_closed) {
+
+        if (close(_fileDescriptor) != 0 && !_error) { _error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil]; }
+        _closed = YES;
+    }
+
+    return (_error == nil);
+}
+
+@end
@@ -0,0 +1,65 @@
+/*
+    MTDependencyTracker.h
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @class         MTDependencyTracker
+ @abstract      A class that keeps track of the files a target (e.g. an icon set) has been created from.
+ @discussion    For every dependency, the modification date, size and file number are recorded when the dependencies
+                of a target are set. A target is only considered to be affected by a change if one of its dependencies
+                has actually been modified, so events that do not change the contents of a file (e.g. metadata
+                changes) do not cause the target to be created again. Folders (e.g. application bundles) are
+                considered to be modified whenever a file inside of them changes.
+*/
+
+@interface MTDependencyTracker : NSObject
+
+/*!
+ @method        setDependencies:forTarget:
+ @abstract      Set the files the given target depends on.
+ @param         dependencies An array of file paths.
+ @param         target A string identifying the target.
+ @discussion    Replaces the dependencies that have previously been set for the target.
+*/
+- (void)setDependencies:(NSArray*)dependencies forTarget:(NSString*)target;
+
+/*!
+ @method        removeTarget:
+ @abstract      Stop tracking the given target.
+ @param         target A string identifying the target.
+*/
+- (void)removeTarget:(NSString*)target;
+
+/*!
+ @method        containsTarget:
+ @abstract      Returns if the given target is tracked.
+ @param         target A string identifying the target.
+ @discussion    Returns YES if dependencies have been set for the target, otherwise returns NO.
+*/
+- (BOOL)containsTarget:(NSString*)target;
+
+/*!
+ @method        targetsAffectedByPaths:
+ @abstract      Get the targets that depend on any of the given changed paths.
+ @param         changedPaths A set of paths of changed files or folders.
+ @discussion    Returns a set of targets. A changed folder affects all dependencies inside of it and a changed file
+                inside of a folder dependency affects the folder.
+*/
+- (NSSet*)targetsAffectedByPaths:(NSSet*)changedPaths;
+
+@end
@@ -0,0 +1,139 @@
+/*
+    MTDependencyTracker.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTDependencyTracker.h"
+
+@interface MTDependencyTracker ()
+@property (nonatomic, strong, readwrite) NSMutableDictionary *targetDependencies;
+@property (nonatomic, strong, readwrite) NSMutableDictionary *fingerprints;
+@end
+
+@implementation MTDependencyTracker
+
+- (instancetype)init
+{
+    self = [super init];
+
+    if (self) {
+
+        _targetDependencies = [[NSMutableDictionary alloc] init];
+        _fingerprints = [[NSMutableDictionary alloc] init];
+    }
+
+    return self;
+}
+
+- (id)fingerprintOfFileAtPath:(NSString*)path
+{
+    id fingerprint = [NSNull null];
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil];
+
+    if (attributes) {
+
+        if ([[attributes fileType] isEqualToString:NSFileTypeDirectory]) {
+
+            // the modification date of a folder does not change if a file
+            // inside of it is modified, so folders always count as modified
+            fingerprint = nil;
+
+        } else {
+
+            fingerprint = [NSArray arrayWithObjects:
+                           [attributes fileModificationDate],
+                           [NSNumber numberWithUnsignedLongLong:[attributes fileSize]],
+                           [NSNumber numberWithUnsignedInteger:[attributes fileSystemFileNumber]],
+                           nil
+            ];
+        }
+    }
+
+    return fingerprint;
+}
+
+- (void)setDependencies:(NSArray*)dependencies forTarget:(NSString*)target
+{
+    if (target) {
+
+        NSMutableDictionary *fingerprints = [NSMutableDictionary dictionary];
+
+        for (NSString *dependency in dependencies) {
+
+            id fingerprint = [self fingerprintOfFileAtPath:dependency];
+            [fingerprints setObject:(fingerprint) ? fingerprint : [NSNull null] forKey:dependency];
+        }
+
+        [_targetDependencies setObject:[fingerprints allKeys] forKey:target];
+        [_fingerprints setObject:fingerprints forKey:target];
+    }
+}
+
+- (void)removeTarget:(NSString*)target
+{
+    if (target) {
+
+        [_targetDependencies removeObjectForKey:target];
+        [_fingerprints removeObjectForKey:target];
+    }
+}
+
+- (BOOL)containsTarget:(NSString*)target
+{
+    return (target && [_targetDependencies objectForKey:target] != nil);
+}
+
+- (NSSet*)targetsAffectedByPaths:(NSSet*)changedPaths
+{
+    NSMutableSet *affectedTargets = [NSMutableSet set];
+
+    for (NSString *target in _targetDependencies) {
+
+        NSDictionary *fingerprints = [_fingerprints objectForKey:target];
+
+        for (NSString *dependency in [_targetDependencies objectForKey:target]) {
+
+            BOOL isAffected = NO;
+
+            for (NSString *changedPath in changedPaths) {
+
+                if ([changedPath isEqualToString:dependency] ||
+                    [dependency hasPrefix:[changedPath stringByAppendingString:@"/"]] ||
+                    [changedPath hasPrefix:[dependency stringByAppendingString:@"/"]]) {
+
+                    isAffected = YES;
+                    break;
+                }
+            }
+
+            if (isAffected) {
+
+                // only count the dependency as changed if it has actually been modified
+                id fingerprint = [self fingerprintOfFileAtPath:dependency];
+                id previousFingerprint = [fingerprints objectForKey:dependency];
+
+                if (!fingerprint || ![fingerprint isEqual:previousFingerprint]) {
+
+                    [affectedTargets addObject:target];
+                    break;
+                }
+            }
+        }
+    }
+
+    return affectedTargets;
+}
+
+@end
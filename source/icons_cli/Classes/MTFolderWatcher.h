@@ -0,0 +1,69 @@
+/*
+    MTFolderWatcher.h
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @class         MTFolderWatcher
+ @abstract      A class that watches a number of folders for changes, using FSEvents.
+ @discussion    Changes are collected on a background queue and are debounced, so a burst of changes (e.g. an
+                application saving a file in several steps) is reported as a single set of paths once no further
+                changes occurred for the debounce interval.
+*/
+
+@interface MTFolderWatcher : NSObject
+
+/*!
+ @method        init:
+ @discussion    The init method is not available. Please use initWithPaths:debounceInterval: instead.
+*/
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        initWithPaths:debounceInterval:
+ @abstract      Initialize a MTFolderWatcher object with the given folders.
+ @param         paths An array of paths of the folders that should be watched (including their subfolders).
+ @param         debounceInterval The time in seconds without changes, before changes are reported.
+ @discussion    Returns an initialized MTFolderWatcher object.
+*/
+- (instancetype)initWithPaths:(NSArray*)paths debounceInterval:(NSTimeInterval)debounceInterval NS_DESIGNATED_INITIALIZER;
+
+/*!
+ @method        start
+ @abstract      Start watching the folders.
+ @discussion    Returns YES if the folders are watched, otherwise returns NO.
+*/
+- (BOOL)start;
+
+/*!
+ @method        stop
+ @abstract      Stop watching the folders.
+ @discussion    A thread that is waiting in waitForChanges returns nil. This method may be called from any thread.
+*/
+- (void)stop;
+
+/*!
+ @method        waitForChanges
+ @abstract      Wait until files in the watched folders have been changed.
+ @discussion    Blocks the calling thread until changes have been detected and the debounce interval has passed
+                since the last change. Returns a set containing the paths of the changed files and folders (with
+                symbolic links resolved) or nil if the watcher has been stopped. A folder is reported instead of
+                its contents if the changes inside of it could not be tracked individually.
+*/
+- (NSSet*)waitForChanges;
+
+@end
@@ -0,0 +1,181 @@
+/*
+    MTFolderWatcher.m
+    Copyright 2016-2026 SAP SE
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTFolderWatcher.h"
+#import "Constants.h"
+#import <CoreServices/CoreServices.h>
+
+@interface MTFolderWatcher ()
+@property (nonatomic, strong, readwrite) NSArray *paths;
+@property (nonatomic, assign) NSTimeInterval debounceInterval;
+- (void)addChangedPaths:(NSSet*)changedPaths;
+@end
+
+@implementation MTFolderWatcher
+{
+    FSEventStreamRef _eventStream;
+    dispatch_queue_t _eventQueue;
+    NSCondition *_condition;
+    NSMutableSet *_changedPaths;
+    NSDate *_lastChangeDate;
+    BOOL _stopped;
+}
+
+static void eventStreamCallback(ConstFSEventStreamRef streamRef, void *info, size_t numEvents, void *eventPaths, const FSEventStreamEventFlags eventFlags[], const FSEventStreamEventId eventIds[])
+{
+#pragma unused(streamRef)
+#pragma unused(eventIds)
+
+    MTFolderWatcher *watcher = (__bridge MTFolderWatcher*)info;
+    NSArray *paths = (__bridge NSArray*)eventPaths;
+    NSMutableSet *changedPaths = [NSMutableSet set];
+
+    for (size_t i = 0; i < numEvents && i < [paths count]; i++) {
+
+        NSString *path = [paths objectAtIndex:i];
+
+        // if events have been dropped or coalesced, we get the folder that must be rescanned
+        if (eventFlags[i] & (kFSEventStreamEventFlagMustScanSubDirs | kFSEventStreamEventFlagRootChanged)) {
+            path = ([[NSFileManager defaultManager] fileExistsAtPath:path]) ? path : [path stringByDeletingLastPathComponent];
+        }
+
+        [changedPaths addObject:[path stringByStandardizingPath]];
+    }
+
+    [watcher addChangedPaths:changedPaths];
+}
+
+- (instancetype)initWithPaths:(NSArray*)paths debounceInterval:(NSTimeInterval)debounceInterval
+{
+    self = [super init];
+
+    if (self) {
+
+        _paths = paths;
+        _debounceInterval = debounceInterval;
+        _condition = [[NSCondition alloc] init];
+        _changedPaths = [[NSMutableSet alloc] init];
+        _eventQueue = dispatch_queue_create("corp.sap.Icons.cli.watcher", DISPATCH_QUEUE_SERIAL);
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [self stop];
+}
+
+- (BOOL)start
+{
+    BOOL success = NO;
+
+    if (!_eventStream && [_paths count] > 0) {
+
+        FSEventStreamContext context = { 0, (__bridge void*)self, NULL, NULL, NULL };
+
+        _eventStream = FSEventStreamCreate(
+                                           kCFAllocatorDefault,
+                                           eventStreamCallback,
+                                           &context,
+                                           (__bridge CFArrayRef)_paths,
+                                           kFSEventStreamEventIdSinceNow,
+                                           kMTWatchLatency,
+                                           kFSEventStreamCreateFlagFileEvents | kFSEventStreamCreateFlagUseCFTypes | kFSEventStreamCreateFlagWatchRoot
+                                           );
+
+        if (_eventStream) {
+
+            FSEventStreamSetDispatchQueue(_eventStream, _eventQueue);
+            success = FSEventStreamStart(_eventStream);
+
+            if (!success) {
+
+                FSEventStreamInvalidate(_eventStream);
+                FSEventStreamRelease(_eventStream);
+                _eventStream = NULL;
+            }
+        }
+    }
+
+    return success;
+}
+
+- (void)stop
+{
+    [_condition lock];
+    FSEventStreamRef eventStream = _eventStream;
+    _eventStream = NULL;
+    _stopped = YES;
+    [_condition broadcast];
+    [_condition unlock];
+
+    // the stream is invalidated outside of the lock, because
+    // a running callback may be waiting for the lock
+    if (eventStream) {
+
+        FSEventStreamStop(eventStream);
+        FSEventStreamInvalidate(eventStream);
+        FSEventStreamRelease(eventStream);
+    }
+}
+
+- (void)addChangedPaths:(NSSet*)changedPaths
+{
+    [_condition lock];
+    [_changedPaths unionSet:changedPaths];
+    _lastChangeDate = [NSDate date];
+    [_condition broadcast];
+    [_condition unlock];
+}
+
+- (NSSet*)waitForChanges
+{
+    NSSet *changedPaths = nil;
+
+    [_condition lock];
+
+    while (!_stopped) {
+
+        if ([_changedPaths count] == 0) {
+
+            [_condition wait];
+
+        } else {
+
+            // wait until there were no further changes for the debounce interval
+            NSDate *reportDate = [_lastChangeDate dateByAddingTimeInterval:_debounceInterval];
+
+            if ([reportDate timeIntervalSinceNow] > 0) {
+
+                [_condition waitUntilDate:reportDate];
+
+            } else {
+
+                changedPaths = [_changedPaths copy];
+                [_changedPaths removeAllObjects];
+                break;
+            }
+        }
+    }
+
+    [_condition unlock];
+
+    return changedPaths;
+}
+
+@end
@@ -16,6 +16,13 @@
 */
 
 #import <Cocoa/Cocoa.h>
+#import "MTRenderPreset.h"
+
+#define kMTVariantNameKey               @"Name"
+#define kMTVariantBannerTextKey         @"BannerText"
+#define kMTVariantBannerColorKey        @"BannerColor"
+#define kMTVariantBannerPositionKey     @"BannerPosition"
+#define kMTVariantBannerAttributesKey   @"BannerAttributes"
 
 /*!
  @class         MTProcessInfo
@@ -24,6 +31,37 @@
 
 @interface MTProcessInfo : NSProcessInfo
 
+/*!
+ @method        presetFilePath
+ @abstract      Get the path of the render preset file.
+ @discussion    Returns a NSString or nil, if no preset has been specified.
+ */
+- (NSString*)presetFilePath;
+
+/*!
+ @method        presetExportFolderPath
+ @abstract      Get the path of the folder the app's saved banners should be exported to as render presets.
+ @discussion    Returns a NSString or nil, if the presets should not be exported.
+ */
+- (NSString*)presetExportFolderPath;
+
+/*!
+ @method        renderPreset
+ @abstract      Get the render preset.
+ @discussion    Returns a MTRenderPreset object or nil, if no preset has been specified or the preset could not be
+                loaded. The settings of the preset are used for all options that have not been specified on the
+                command line.
+ */
+- (MTRenderPreset*)renderPreset;
+
+/*!
+ @method        reloadRenderPreset
+ @abstract      Discard the loaded render preset.
+ @discussion    The preset file is read again the next time the render preset is requested, e.g. because
+                the file has been modified while watching a folder.
+ */
+- (void)reloadRenderPreset;
+
 /*!
  @method        animationDuration
  @abstract      Get the animation duration.
@@ -38,6 +76,14 @@
  */
 - (NSUInteger)outputSize;
 
+/*!
+ @method        supersamplingFactor
+ @abstract      Get the factor the output size is multiplied by for rendering.
+ @discussion    Returns an unsigned integer. The icons are rendered at the output size multiplied by
+                this factor and then downsampled to the output size.
+ */
+- (NSUInteger)supersamplingFactor;
+
 /*!
  @method        imageInset
  @abstract      Get the image inset of the uninstall icon.
@@ -73,6 +119,17 @@
  */
 - (NSString*)bannerPosition;
 
+/*!
+ @method        variants
+ @abstract      Get the banner variants that should be created.
+ @discussion    Returns an array of dictionaries, one for every --variant argument, or an empty array if no variants
+                have been specified. Variants must be provided as name[:text[:color[:position]]]. The dictionaries
+                contain the name of the variant (kMTVariantNameKey), the banner text (kMTVariantBannerTextKey), the
+                banner color (kMTVariantBannerColorKey) and the banner position (kMTVariantBannerPositionKey). Missing
+                colors and positions are taken from the -c and -p arguments. An empty text means "no banner".
+ */
+- (NSArray*)variants;
+
 /*!
  @method        inputFilePath
  @abstract      Get the path to the input file.
@@ -80,6 +137,28 @@
  */
 - (NSString*)inputFilePath;
 
+/*!
+ @method        scanFolderPaths
+ @abstract      Get the paths to the folders that should be scanned for applications.
+ @discussion    Returns an array of strings, one for every --scan argument, or an empty array if no folders have
+                been specified. Paths that do not exist or are not folders are ignored.
+ */
+- (NSArray*)scanFolderPaths;
+
+/*!
+ @method        scanJobs
+ @abstract      Get the number of folders that are read concurrently when scanning for applications.
+ @discussion    Returns an unsigned integer.
+ */
+- (NSUInteger)scanJobs;
+
+/*!
+ @method        watchFolderPath
+ @abstract      Get the path to the folder that should be watched for changed source files.
+ @discussion    Returns a string or nil, if watching has not been requested or the path is not a folder.
+ */
+- (NSString*)watchFolderPath;
+
 /*!
  @method        outputFolderPath
  @abstract      Get the path to the output folder.
@@ -87,6 +166,22 @@
  */
 - (NSString*)outputFolderPath;
 
+/*!
+ @method        archiveFilePath
+ @abstract      Get the path to the archive the generated images should be written to.
+ @discussion    Returns a string or nil, if no archive has been specified. A path of "-" means standard output.
+                An output folder of "-" (-o -) is treated as an archive written to standard output.
+ */
+- (NSString*)archiveFilePath;
+
+/*!
+ @method        archiveFormat
+ @abstract      Get the format of the archive.
+ @discussion    Returns a lowercase string ("tar", "zip", "zip-stored" or "stream") or nil, if no format has been
+                specified. If the output folder is "-" and no archive has been specified, "stream" is returned.
+ */
+- (NSString*)archiveFormat;
+
 /*!
  @method        textMargin
  @abstract      Get the minimum margin between the text and the edge of the banner.
@@ -156,6 +251,21 @@
  @discussion    Returns a string.
  */
 - (NSString*)deleteBadgePosition;
+
+/*!
+ @method        traceFilePath
+ @abstract      Get the path to the file the trace events should be written to.
+ @discussion    Returns a string or nil, if tracing has not been requested.
+ */
+- (NSString*)traceFilePath;
+
+/*!
+ @method        showStatistics
+ @abstract      Get whether a per-stage timing summary should be displayed.
+ @discussion    Returns YES if the summary should be displayed, otherwise returns NO.
+ */
+- (BOOL)showStatistics;
+
 /*!
  @method        showVersion
  @abstract      Get whether the version should be displayed.
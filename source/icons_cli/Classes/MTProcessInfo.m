@@ -19,6 +19,10 @@
 #import "Constants.h"
 
 @implementation MTProcessInfo
+{
+    MTRenderPreset *_renderPreset;
+    BOOL _renderPresetLoaded;
+}
 
 - (BOOL)floatWithArgument:(NSString*)argument outValue:(CGFloat*)outValue
 {
@@ -58,9 +62,70 @@
     return success;
 }
 
+- (NSString*)presetFilePath
+{
+    NSString *path = nil;
+    
+    NSInteger index = [[self arguments] indexOfObject:@"--preset"];
+    
+    if (index != NSNotFound && index + 1 < [[self arguments] count]) {
+        
+        path = [[self arguments] objectAtIndex:index + 1];
+    }
+    
+    return path;
+}
+
+- (NSString*)presetExportFolderPath
+{
+    NSString *path = nil;
+    
+    NSInteger index = [[self arguments] indexOfObject:@"--export-presets"];
+    
+    if (index != NSNotFound && index + 1 < [[self arguments] count]) {
+        
+        path = [[self arguments] objectAtIndex:index + 1];
+    }
+    
+    return path;
+}
+
+- (MTRenderPreset*)renderPreset
+{
+    // the preset is loaded only once, because it
+    // provides the defaults for most of the options
+    if (!_renderPresetLoaded) {
+        
+        NSString *presetPath = [self presetFilePath];
+        if (presetPath) { _renderPreset = [MTRenderPreset presetWithContentsOfURL:[NSURL fileURLWithPath:presetPath] error:nil]; }
+        _renderPresetLoaded = YES;
+    }
+    
+    return _renderPreset;
+}
+
+- (void)reloadRenderPreset
+{
+    _renderPreset = nil;
+    _renderPresetLoaded = NO;
+}
+
+- (NSString*)positionStringWithTop:(BOOL)top left:(BOOL)left right:(BOOL)right
+{
+    NSString *position = (top) ? @"t" : @"b";
+    
+    if (left) {
+        position = [position stringByAppendingString:@"l"];
+    } else if (right) {
+        position = [position stringByAppendingString:@"r"];
+    }
+    
+    return position;
+}
+
 - (CGFloat)animationDuration
 {
-    CGFloat duration = kMTAnimationDurationDefault;
+    CGFloat duration = ([self renderPreset]) ? [[self renderPreset] animationDuration] : kMTAnimationDurationDefault;
     
     NSInteger index = [[self arguments] indexOfObject:@"-d"];
     if (index == NSNotFound) { index = [[self arguments] indexOfObject:@"--duration"]; }
@@ -81,7 +146,7 @@
 
 - (NSUInteger)outputSize
 {
-    NSUInteger size = 0;
+    NSUInteger size = [[self renderPreset] outputSize];
     
     NSInteger index = [[self arguments] indexOfObject:@"-s"];
     if (index == NSNotFound) { index = [[self arguments] indexOfObject:@"--size"]; }
@@ -95,9 +160,28 @@
     return size;
 }
 
+- (NSUInteger)supersamplingFactor
+{
+    NSUInteger factor = kMTSupersamplingDefault;
+    
+    NSInteger index = [[self arguments] indexOfObject:@"--supersample"];
+    
+    if (index != NSNotFound && index + 1 < [[self arguments] count]) {
+        
+        NSInteger value = 0;
+        if ([self integerWithArgument:[[self arguments] objectAtIndex:index + 1] outValue:&value]) {
+            
+            factor = MIN(MAX(value, kMTSupersamplingMin), kMTSupersamplingMax);
+        }
+    }
+    
+    return factor;
+}
+
 - (CGFloat)imageInset
 {
-    CGFloat inset = -1.0;
+    MTRenderPreset *preset = [self renderPreset];
+    CGFloat inset = (preset && ![preset autoImageInset]) ? [preset imageInset] * 100 : -1.0;
     
     NSInteger index = [[self arguments] indexOfObject:@"-r"];
     if (index == NSNotFound) { index = [[self arguments] indexOfObject:@"--reduce"]; }
@@ -164,6 +248,21 @@
 - (NSString*)bannerPosition
 {
     NSString *position = nil;
+    MTRenderPreset *preset = [self renderPreset];
+    
+    if (preset) {
+        
+        MTBannerPosition bannerPosition = [preset bannerPosition];
+        
+        if (bannerPosition == MTBannerPositionTop || bannerPosition == MTBannerPositionBottom) {
+            position = (bannerPosition == MTBannerPositionTop) ? @"t" : @"b";
+        } else {
+            position = [self positionStringWithTop:(bannerPosition == MTBannerPositionTopLeft || bannerPosition == MTBannerPositionTopRight)
+                                              left:(bannerPosition == MTBannerPositionTopLeft || bannerPosition == MTBannerPositionBottomLeft)
+                                             right:(bannerPosition == MTBannerPositionTopRight || bannerPosition == MTBannerPositionBottomRight)
+            ];
+        }
+    }
     
     NSInteger index = [[self arguments] indexOfObject:@"-p"];
     if (index == NSNotFound) { index = [[self arguments] indexOfObject:@"--position"]; }
@@ -176,6 +275,60 @@
     return position;
 }
 
+- (NSArray*)variants
+{
+    NSMutableArray *variants = [[NSMutableArray alloc] init];
+    NSArray *arguments = [self arguments];
+    
+    for (NSInteger index = 0; index + 1 < [arguments count]; index++) {
+        
+        if ([[arguments objectAtIndex:index] isEqualToString:@"--variant"]) {
+            
+            NSArray *components = [[arguments objectAtIndex:index + 1] componentsSeparatedByString:@":"];
+            NSString *name = [components firstObject];
+            
+            if ([name length] > 0) {
+                
+                NSString *text = @"";
+                NSUInteger color = [self bannerColor];
+                NSString *position = [self bannerPosition];
+                NSUInteger count = [components count];
+                
+                if (count >= 4) {
+                    
+                    // the text itself may contain colons
+                    text = [[components subarrayWithRange:NSMakeRange(1, count - 3)] componentsJoinedByString:@":"];
+                    if ([[components objectAtIndex:count - 2] length] > 0) { color = (UInt64)strtoull([[components objectAtIndex:count - 2] UTF8String], NULL, 16); }
+                    if ([[components lastObject] length] > 0) { position = [[components lastObject] lowercaseString]; }
+                    
+                } else if (count == 3) {
+                    
+                    text = [components objectAtIndex:1];
+                    if ([[components lastObject] length] > 0) { color = (UInt64)strtoull([[components lastObject] UTF8String], NULL, 16); }
+                    
+                } else if (count == 2) {
+                    
+                    text = [components lastObject];
+                }
+                
+                NSMutableDictionary *variant = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+                                                name, kMTVariantNameKey,
+                                                text, kMTVariantBannerTextKey,
+                                                [NSNumber numberWithUnsignedInteger:color], kMTVariantBannerColorKey,
+                                                nil
+                ];
+                
+                if (position) { [variant setObject:position forKey:kMTVariantBannerPositionKey]; }
+                [variants addObject:variant];
+            }
+            
+            index++;
+        }
+    }
+    
+    return variants;
+}
+
 - (NSString*)inputFilePath
 {
     NSString *path = nil;
@@ -191,6 +344,69 @@
     return path;
 }
 
+- (NSArray*)scanFolderPaths
+{
+    NSMutableArray *paths = [[NSMutableArray alloc] init];
+    NSArray *arguments = [self arguments];
+    
+    for (NSInteger index = 0; index + 1 < [arguments count]; index++) {
+        
+        if ([[arguments objectAtIndex:index] isEqualToString:@"--scan"]) {
+            
+            NSString *tempPath = [arguments objectAtIndex:index + 1];
+            BOOL isDirectory = NO;
+            
+            if ([[NSFileManager defaultManager] fileExistsAtPath:tempPath
+                                                     isDirectory:&isDirectory] && isDirectory) {
+                [paths addObject:tempPath];
+            }
+            
+            index++;
+        }
+    }
+    
+    return paths;
+}
+
+- (NSUInteger)scanJobs
+{
+    NSUInteger jobs = kMTScanJobsDefault;
+    
+    NSInteger index = [[self arguments] indexOfObject:@"--jobs"];
+    
+    if (index != NSNotFound && index + 1 < [[self arguments] count]) {
+        
+        NSInteger value = 0;
+        if ([self integerWithArgument:[[self arguments] objectAtIndex:index + 1] outValue:&value]) {
+            
+            jobs = MIN(MAX(value, kMTScanJobsMin), kMTScanJobsMax);
+        }
+    }
+    
+    return jobs;
+}
+
+- (NSString*)watchFolderPath
+{
+    NSString *path = nil;
+    
+    NSInteger index = [[self arguments] indexOfObject:@"--watch"];
+    
+    if (index != NSNotFound && index + 1 < [[self arguments] count]) {
+        
+        NSString *tempPath = [[self arguments] objectAtIndex:index + 1];
+        
+        BOOL isDirectory = NO;
+        
+        if ([[NSFileManager defaultManager] fileExistsAtPath:tempPath
+                                                 isDirectory:&isDirectory] && isDirectory) {
+            path = tempPath;
+        }
+    }
+    
+    return path;
+}
+
 - (NSString*)outputFolderPath
 {
     NSString *path = nil;
@@ -213,9 +429,61 @@
     return path;
 }
 
+- (BOOL)writesToStandardOutput
+{
+    BOOL standardOutput = NO;
+    
+    NSInteger index = [[self arguments] indexOfObject:@"-o"];
+    if (index == NSNotFound) { index = [[self arguments] indexOfObject:@"--output"]; }
+    
+    if (index != NSNotFound && index + 1 < [[self arguments] count]) {
+        
+        standardOutput = [[[self arguments] objectAtIndex:index + 1] isEqualToString:@"-"];
+    }
+    
+    return standardOutput;
+}
+
+- (NSString*)archiveFilePath
+{
+    NSString *path = nil;
+    
+    NSInteger index = [[self arguments] indexOfObject:@"--archive"];
+    
+    if (index != NSNotFound && index + 1 < [[self arguments] count]) {
+        
+        path = [[self arguments] objectAtIndex:index + 1];
+        
+    } else if ([self writesToStandardOutput]) {
+        
+        // "-o -" writes a framed stream to standard output
+        path = @"-";
+    }
+    
+    return path;
+}
+
+- (NSString*)archiveFormat
+{
+    NSString *format = nil;
+    
+    NSInteger index = [[self arguments] indexOfObject:@"--archive-format"];
+    
+    if (index != NSNotFound && index + 1 < [[self arguments] count]) {
+        
+        format = [[[self arguments] objectAtIndex:index + 1] lowercaseString];
+        
+    } else if ([self writesToStandardOutput] && [[self arguments] indexOfObject:@"--archive"] == NSNotFound) {
+        
+        format = @"stream";
+    }
+    
+    return format;
+}
+
 - (CGFloat)textMargin
 {
-    CGFloat margin = kMTBannerTextMarginDefault;
+    CGFloat margin = ([self renderPreset]) ? [[self renderPreset] bannerTextMargin] : kMTBannerTextMarginDefault;
     
     NSInteger index = [[self arguments] indexOfObject:@"-m"];
     if (index == NSNotFound) { index = [[self arguments] indexOfObject:@"--textmargin"]; }
@@ -236,7 +504,7 @@
 
 - (CGFloat)bannerAngle
 {
-    CGFloat angle = kMTBannerAngleDefault;
+    CGFloat angle = ([self renderPreset]) ? [[self renderPreset] bannerAngle] : kMTBannerAngleDefault;
     
     NSInteger index = [[self arguments] indexOfObject:@"-a"];
     if (index == NSNotFound) { index = [[self arguments] indexOfObject:@"--bannerangle"]; }
@@ -257,7 +525,7 @@
 
 - (CGFloat)bannerHeight
 {
-    CGFloat height = kMTBannerHeightDefault;
+    CGFloat height = ([self renderPreset]) ? [[self renderPreset] bannerHeight] : kMTBannerHeightDefault;
     
     NSInteger index = [[self arguments] indexOfObject:@"-h"];
     if (index == NSNotFound) { index = [[self arguments] indexOfObject:@"--bannerheight"]; }
@@ -278,7 +546,7 @@
 
 - (CGFloat)bannerMargin
 {
-    CGFloat margin = kMTBannerMarginDefault;
+    CGFloat margin = ([self renderPreset]) ? [[self renderPreset] bannerMargin] : kMTBannerMarginDefault;
     
     NSInteger index = [[self arguments] indexOfObject:@"-n"];
     if (index == NSNotFound) { index = [[self arguments] indexOfObject:@"--bannermargin"]; }
@@ -300,6 +568,10 @@
 - (NSString*)fileNamePrefix
 {
     NSString *prefix = nil;
+    MTRenderPreset *preset = [self renderPreset];
+    
+    // an empty prefix means the name of the source file is used
+    if ([preset usesFileNamePrefix]) { prefix = ([preset fileNamePrefix]) ? [preset fileNamePrefix] : @""; }
     
     NSInteger index = [[self arguments] indexOfObject:@"-n"];
     if (index == NSNotFound) { index = [[self arguments] indexOfObject:@"--nameprefix"]; }
@@ -318,6 +590,16 @@
 - (NSString*)excludeFromCreation
 {
     NSString *exclude = nil;
+    MTRenderPreset *preset = [self renderPreset];
+    
+    if (preset) {
+        
+        exclude = [NSString stringWithFormat:@"%@%@%@",
+                   ([preset createsInstallIcon]) ? @"" : @"i",
+                   ([preset createsUninstallIcon]) ? @"" : @"u",
+                   ([preset createsAnimatedUninstallIcon]) ? @"" : @"a"
+        ];
+    }
     
     NSInteger index = [[self arguments] indexOfObject:@"-x"];
     if (index == NSNotFound) { index = [[self arguments] indexOfObject:@"--exclude"]; }
@@ -350,7 +632,7 @@
 
 - (CGFloat)deleteBadgeSize
 {
-    CGFloat size = kMTBadgeIconSizeDefault;
+    CGFloat size = ([self renderPreset]) ? [[self renderPreset] badgeSize] : kMTBadgeIconSizeDefault;
     
     NSInteger index = [[self arguments] indexOfObject:@"-l"];
     if (index == NSNotFound) { index = [[self arguments] indexOfObject:@"--badgesize"]; }
@@ -371,7 +653,7 @@
 
 - (CGFloat)deleteBadgeMargin
 {
-    CGFloat margin = kMTBadgeIconMarginDefault;
+    CGFloat margin = ([self renderPreset]) ? [[self renderPreset] badgeMargin] : kMTBadgeIconMarginDefault;
     
     NSInteger index = [[self arguments] indexOfObject:@"-k"];
     if (index == NSNotFound) { index = [[self arguments] indexOfObject:@"--badgemargin"]; }
@@ -393,6 +675,16 @@
 - (NSString*)deleteBadgePosition
 {
     NSString *position = nil;
+    MTRenderPreset *preset = [self renderPreset];
+    
+    if (preset) {
+        
+        MTBadgePosition badgePosition = [preset badgePosition];
+        position = [self positionStringWithTop:(badgePosition == MTBadgePositionTopLeft || badgePosition == MTBadgePositionTopRight)
+                                          left:(badgePosition == MTBadgePositionTopLeft || badgePosition == MTBadgePositionBottomLeft)
+                                         right:(badgePosition == MTBadgePositionTopRight || badgePosition == MTBadgePositionBottomRight)
+        ];
+    }
     
     NSInteger index = [[self arguments] indexOfObject:@"-t"];
     if (index == NSNotFound) { index = [[self arguments] indexOfObject:@"--badgeposition"]; }
@@ -405,6 +697,26 @@
     return position;
 }
 
+- (NSString*)traceFilePath
+{
+    NSString *path = nil;
+    
+    NSInteger index = [[self arguments] indexOfObject:@"--trace"];
+    
+    if (index != NSNotFound && index + 1 < [[self arguments] count]) {
+        
+        path = [[self arguments] objectAtIndex:index + 1];
+    }
+    
+    return path;
+}
+
+- (BOOL)showStatistics
+{
+    BOOL show = [[self arguments] containsObject:@"--stats"];
+    return show;
+}
+
 - (BOOL)showVersion
 {
     BOOL show = [[self arguments] containsObject:@"-v"] || [[self arguments] containsObject:@"--version"];
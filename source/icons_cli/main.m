@@ -17,16 +17,29 @@
 
 #import <Foundation/Foundation.h>
 #import "MTInstallIconView.h"
+#import "MTBannerLayout.h"
 #import "MTUninstallIconView.h"
 #import "MTIconSet.h"
 #import "MTColor.h"
 #import "MTAttributedString.h"
 #import "Constants.h"
 #import "MTProcessInfo.h"
+#import "MTTrace.h"
+#import "MTRenderArena.h"
+#import "MTRenderGraph.h"
+#import "MTAppScanner.h"
+#import "MTFolderWatcher.h"
+#import "MTDependencyTracker.h"
+#import "MTPackage.h"
+#import "MTBatchWriter.h"
+#import "MTArchiveWriter.h"
+#import <UniformTypeIdentifiers/UniformTypeIdentifiers.h>
+#import <fcntl.h>
+#import <CommonCrypto/CommonDigest.h>
 #import "DeleteBadge.svg.h"
 
 @interface Main : NSObject
-
+@property (nonatomic, strong, readwrite) id<MTFileGroupWriter> fileWriter;
 @end
 
 @implementation Main
@@ -36,6 +49,11 @@
     __block int exitCode = 0;
     
     MTProcessInfo *appArguments = [[MTProcessInfo alloc] init];
+    NSString *argTraceFilePath = [appArguments traceFilePath];
+    BOOL argShowStatistics = [appArguments showStatistics];
+    
+    if (argTraceFilePath || argShowStatistics) { [MTTrace setEnabled:YES]; }
+    MTTraceTimestamp runBegin = MTTraceBegin();
     
     if ([appArguments showVersion]) {
         
@@ -56,272 +74,1091 @@
         
         [self writeConsole:[NSString stringWithFormat:@"icons_cli %@", versionString]];
         
+    } else if ([appArguments presetExportFolderPath]) {
+        
+        exitCode = [self exportPresetsToFolder:[appArguments presetExportFolderPath]];
+        
     } else {
                 
         NSString *argInputFilePath = [appArguments inputFilePath];
         NSString *argOutputFolderPath = [appArguments outputFolderPath];
+        NSArray *argScanFolderPaths = [appArguments scanFolderPaths];
+        NSString *argWatchFolderPath = [appArguments watchFolderPath];
+        NSString *argArchiveFilePath = [appArguments archiveFilePath];
         
-        if (!argInputFilePath || !argOutputFolderPath) {
+        if ((!argInputFilePath && [argScanFolderPaths count] == 0 && !argWatchFolderPath) || (!argOutputFolderPath && !argArchiveFilePath)) {
             
-            [self writeConsole:@"ERROR! Please specify at least an input file and an output folder"];
+            [self writeConsole:@"ERROR! Please specify at least an input file (or a folder to scan or watch) and an output folder (or an archive)"];
             [self printUsage];
             
             exitCode = 255;
             
+        } else if (argWatchFolderPath && argArchiveFilePath) {
+            
+            [self writeConsole:@"ERROR! Watching a folder can not be combined with writing an archive"];
+            exitCode = 255;
+            
+        } else if ([appArguments presetFilePath] && ![appArguments renderPreset]) {
+            
+            [self writeConsole:@"ERROR! Unable to load preset"];
+            exitCode = 255;
+            
+        } else if (![self variantNamesAreUniqueWithArguments:appArguments]) {
+            
+            [self writeConsole:@"ERROR! Every variant needs a unique name"];
+            exitCode = 255;
+            
         } else {
             
-            NSImage *sourceImage = [NSImage imageWithFileAtURL:[NSURL fileURLWithPath:argInputFilePath]];
+            _fileWriter = [self fileWriterWithArguments:appArguments];
             
-            if ([sourceImage isValid]) {
+            if (!_fileWriter) {
                 
-                // get the source image's shortest side and calculate
-                // the maximum output image size
-                NSBitmapImageRep *sourceImageRep = [[NSBitmapImageRep alloc] initWithData:[sourceImage TIFFRepresentation]];
-                NSInteger imageSize = ([sourceImageRep pixelsWide] >= [sourceImageRep pixelsHigh]) ? [sourceImageRep pixelsWide] : [sourceImageRep pixelsHigh];
+                [self writeConsole:@"ERROR! Unable to create archive"];
+                exitCode = 3;
                 
-                NSString *argExcludeFromCreation = [appArguments excludeFromCreation];
+            } else if (argWatchFolderPath) {
                 
-#pragma mark Install icon
+                exitCode = [self watchFolder:argWatchFolderPath arguments:appArguments];
                 
-                MTInstallIconView *installIconView = nil;
+            } else if ([argScanFolderPaths count] > 0) {
                 
-                if (![argExcludeFromCreation containsString:@"i"]) {
+                exitCode = [self createIconsForAppsInFolders:argScanFolderPaths arguments:appArguments];
+                
+            } else {
+                
+                MTTraceTimestamp decodeBegin = MTTraceBegin();
+                BOOL readFromStandardInput = [argInputFilePath isEqualToString:@"-"];
+                NSImage *sourceImage = nil;
+                
+                if (readFromStandardInput) {
                     
-                    installIconView = [[MTInstallIconView alloc] initWithFrame:NSMakeRect(0, 0, imageSize, imageSize)];
-                    [installIconView setImage:sourceImage];
+                    // the source is piped in, so the format is determined by its contents
+                    NSData *inputData = [[NSFileHandle fileHandleWithStandardInput] readDataToEndOfFileAndReturnError:nil];
+                    sourceImage = [NSImage imageWithFileData:inputData];
                     
-                    // banner
-                    NSString *argBannerText = [appArguments bannerText];
-
-                    if ([argBannerText length] > 0) {
-                        
-                        NSAttributedString *bannerText = [[NSAttributedString alloc] initWithString:argBannerText
-                                                                                               font:[NSFont systemFontOfSize:0.0]
-                                                                                    foregroundColor:[NSColor colorFromInteger:[appArguments textColor]]
-                                                                                    backgroundColor:[NSColor colorFromInteger:[appArguments bannerColor]]];
-                        [installIconView setBannerAttributes:bannerText];
-                        [installIconView setBannerTextMargin:[appArguments textMargin]];
-                        [installIconView setBannerAngle:[appArguments bannerAngle]];
-                        [installIconView setBannerHeight:[appArguments bannerHeight]];
-                        [installIconView setBannerMargin:[appArguments bannerMargin]];
-                        
-                        // banner position
-                        MTBannerPosition position = MTBannerPositionTopLeft;
-                        NSString *bannerPosition = [appArguments bannerPosition];
-                        
-                        if ([bannerPosition length] > 0) {
-                            
-                            if ([bannerPosition containsString:@"t"]) {
-                                
-                                position = MTBannerPositionTop;
-                                
-                                if ([bannerPosition containsString:@"l"]) {
-                                    position = MTBannerPositionTopLeft;
-                                } else if ([bannerPosition containsString:@"r"]) {
-                                    position = MTBannerPositionTopRight;
-                                }
-                                
-                            } else if ([bannerPosition containsString:@"b"]) {
-                                
-                                position = MTBannerPositionBottom;
-                                
-                                if ([bannerPosition containsString:@"l"]) {
-                                    position = MTBannerPositionBottomLeft;
-                                } else if ([bannerPosition containsString:@"r"]) {
-                                    position = MTBannerPositionBottomRight;
-                                }
-                            }
-                        }
-                        
-                        [installIconView setBannerPosition:position];
+                } else {
+                    sourceImage = [NSImage imageWithFileAtURL:[NSURL fileURLWithPath:argInputFilePath]];
+                }
+                
+                if ([sourceImage isValid]) {
+                    
+                    MTTraceEnd("decode source", decodeBegin);
+                    
+                    // process the file name prefix
+                    NSString *argFileNamePrefix = [appArguments fileNamePrefix];
+                    
+                    if (argFileNamePrefix && [argFileNamePrefix length] == 0) {
+                        argFileNamePrefix = (readFromStandardInput) ? nil : [[argInputFilePath lastPathComponent] stringByDeletingPathExtension];
+                    } else {
+                        argFileNamePrefix = [MTIconSet fileNamePrefixWithString:argFileNamePrefix];
                     }
                     
+                    exitCode = [self createIconsWithImage:sourceImage sourcePath:argInputFilePath fileNamePrefix:argFileNamePrefix arguments:appArguments];
+                    
                 } else {
-                    [self writeConsole:@"Skipping creation of install icon"];
+                    [self writeConsole:@"ERROR! Unable to open source image"];
+                    exitCode = 2;
                 }
                 
-#pragma mark Uninstall icon
+            }
+            
+            // write the icon sets that have not been written yet
+            if (_fileWriter && ![_fileWriter flush] && exitCode == 0) { exitCode = 3; }
+            
+            if ([_fileWriter isKindOfClass:[MTArchiveWriter class]] && ![(MTArchiveWriter*)_fileWriter close]) {
+                
+                [self writeConsole:@"ERROR! Failed to write archive"];
+                if (exitCode == 0) { exitCode = 3; }
+            }
+        }
+    }
+    
+    // keep the banner text metrics for the next run
+    [MTBannerLayout synchronizeTextMetrics];
+    
+    MTTraceEnd("icons_cli", runBegin);
+    
+    if (argTraceFilePath) {
+        
+        NSError *error = nil;
+        
+        if (![MTTrace writeTraceToFile:argTraceFilePath error:&error]) {
+            [self writeConsole:[NSString stringWithFormat:@"ERROR! Failed to write trace file: %@", [error localizedDescription]]];
+        }
+    }
+    
+    if (argShowStatistics) {
+        
+        [self writeConsole:[@"\n" stringByAppendingString:[MTTrace statisticsSummary]]];
+        
+        // the icons are rendered on several threads, each with its own arena
+        MTRenderArenaStatistics arenaStatistics = MTRenderArenaGetTotalStatistics();
+        [self writeConsole:[NSString stringWithFormat:@"Render arenas: %lu chunk allocations, %.1f MB reserved, %.1f MB peak, %lu resets",
+                            (unsigned long)arenaStatistics.chunkAllocations,
+                            arenaStatistics.reservedBytes / 1048576.0,
+                            arenaStatistics.peakBytes / 1048576.0,
+                            (unsigned long)arenaStatistics.resets
+                           ]
+        ];
+    }
+    
+    return exitCode;
+}
+
+- (int)exportPresetsToFolder:(NSString*)folderPath
+{
+    int exitCode = 0;
+    
+    NSUserDefaults *userDefaults = [[NSUserDefaults alloc] initWithSuiteName:@"7R5ZEU67FQ.corp.sap.Icons"];
+    NSArray *presets = [MTRenderPreset presetsWithUserDefaults:userDefaults];
+    
+    if ([presets count] == 0) {
+        
+        [self writeConsole:@"ERROR! No saved banners found"];
+        exitCode = 1;
+        
+    } else if (![[NSFileManager defaultManager] createDirectoryAtPath:folderPath withIntermediateDirectories:YES attributes:nil error:nil]) {
+        
+        [self writeConsole:@"ERROR! Unable to create preset folder"];
+        exitCode = 3;
+        
+    } else {
+        
+        NSMutableSet *fileNames = [NSMutableSet set];
+        
+        for (MTRenderPreset *preset in presets) {
+            
+            // name the file after the banner and make sure
+            // banners with the same name don't overwrite
+            // each other
+            NSString *bannerName = ([[preset bannerName] length] > 0) ? [preset bannerName] : [[preset bannerAttributes] string];
+            bannerName = [[bannerName stringByReplacingOccurrencesOfString:@"/" withString:@"-"] stringByReplacingOccurrencesOfString:@":" withString:@"-"];
+            if ([bannerName length] == 0) { bannerName = @"Banner"; }
+            
+            NSString *fileName = bannerName;
+            
+            for (NSUInteger i = 2; [fileNames containsObject:[fileName lowercaseString]]; i++) {
+                fileName = [NSString stringWithFormat:@"%@ %lu", bannerName, (unsigned long)i];
+            }
+            
+            [fileNames addObject:[fileName lowercaseString]];
+            
+            NSString *presetPath = [folderPath stringByAppendingPathComponent:[fileName stringByAppendingPathExtension:kMTRenderPresetFileExtension]];
+            NSError *error = nil;
+            
+            if ([preset writeToURL:[NSURL fileURLWithPath:presetPath] error:&error]) {
                 
-                MTUninstallIconView *uninstallIconView = nil;
-                CGFloat argAnimationDuration = ([argExcludeFromCreation containsString:@"a"]) ? 0 : [appArguments animationDuration];
+                [self writeConsole:[NSString stringWithFormat:@"Exported %@", presetPath]];
                 
-                if (!([argExcludeFromCreation containsString:@"u"] && [argExcludeFromCreation containsString:@"a"])) {
-                    
-                    uninstallIconView = [[MTUninstallIconView alloc] initWithFrame:NSMakeRect(0, 0, imageSize, imageSize)];
-                    [uninstallIconView setImage:sourceImage];
-                    [uninstallIconView setBadgeSize:kMTBadgeIconSizeDefault];
-                    [uninstallIconView setBadgeMargin:kMTBadgeIconMarginDefault];
-                    
-                    MTDeleteBadgeView *deleteBadge = [[MTDeleteBadgeView alloc] initWithFrame:[uninstallIconView bounds]];
-                    NSString *customDeleteBadgePath = [appArguments deleteBadgeFilePath];
+            } else {
+                
+                [self writeConsole:[NSString stringWithFormat:@"ERROR! Failed to write preset %@: %@", presetPath, [error localizedDescription]]];
+                exitCode = 3;
+            }
+        }
+    }
+    
+    return exitCode;
+}
 
-                    if (customDeleteBadgePath) {
-                        
-                        NSImage *customDeleteBadge = [[NSImage alloc] initByReferencingFile:customDeleteBadgePath];
+- (int)createIconsForAppsInFolders:(NSArray*)folderPaths arguments:(MTProcessInfo*)appArguments
+{
+    int exitCode = 0;
+    
+    NSMutableArray *folderURLs = [NSMutableArray array];
+    for (NSString *folderPath in folderPaths) { [folderURLs addObject:[NSURL fileURLWithPath:folderPath isDirectory:YES]]; }
+    
+    MTAppScanner *appScanner = [[MTAppScanner alloc] initWithFolderURLs:folderURLs maxConcurrentFolders:[appArguments scanJobs]];
+    
+    // the scanner reports the apps in the order of their paths, so the output (including the
+    // numbering of apps with the same name) does not depend on the order in which the folders
+    // have been read. The apps are decoded and rendered while the scan is still running
+    NSCondition *condition = [[NSCondition alloc] init];
+    NSMutableArray *foundApps = [NSMutableArray array];
+    __block BOOL scanFinished = NO;
+    
+    [appScanner scanWithBundleHandler:^(NSURL *bundleURL) {
+        
+        [condition lock];
+        [foundApps addObject:bundleURL];
+        [condition signal];
+        [condition unlock];
+        
+    } completionHandler:^(NSUInteger folderCount, NSUInteger bundleCount) {
+        
+        [self writeConsole:[NSString stringWithFormat:@"Scanned %lu folders and found %lu applications", (unsigned long)folderCount, (unsigned long)bundleCount]];
+        
+        [condition lock];
+        scanFinished = YES;
+        [condition signal];
+        [condition unlock];
+    }];
+    
+    // the icons of the apps are decoded in the background as soon as the apps have been
+    // found, while the main thread renders the apps that have already been decoded. The
+    // number of apps decoded ahead is limited, so the memory usage does not grow with
+    // the number of apps found
+    NSMutableDictionary *decodedApps = [NSMutableDictionary dictionary];
+    dispatch_queue_t decodeQueue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+    NSCountedSet *fileNamePrefixes = [[NSCountedSet alloc] init];
+    NSUInteger decodeIndex = 0;
+    
+    for (NSUInteger renderIndex = 0; ; renderIndex++) {
+        
+        NSNumber *appIndex = [NSNumber numberWithUnsignedInteger:renderIndex];
+        NSURL *bundleURL = nil;
+        id sourceImage = nil;
+        
+        [condition lock];
+        
+        // we are woken up whenever an app has been found or decoded
+        while (!(sourceImage = [decodedApps objectForKey:appIndex]) && !(scanFinished && renderIndex >= [foundApps count])) {
+            
+            for (; decodeIndex < [foundApps count] && decodeIndex < renderIndex + kMTScanDecodeAhead; decodeIndex++) {
+                
+                NSURL *decodeURL = [foundApps objectAtIndex:decodeIndex];
+                NSNumber *decodeKey = [NSNumber numberWithUnsignedInteger:decodeIndex];
+                
+                dispatch_async(decodeQueue, ^{
                     
-                        if ([customDeleteBadge isValid]) {
-                            
-                            [deleteBadge setImage:customDeleteBadge];
-                            [deleteBadge setShowsShadow:NO];
-                            
-                            [uninstallIconView setBadgeSize:[appArguments deleteBadgeSize]];
-                            [uninstallIconView setBadgeMargin:[appArguments deleteBadgeMargin]];
-                            
-                            // badge position
-                            MTBadgePosition position = MTBadgePositionTopLeft;
-                            NSString *badgePosition = [appArguments deleteBadgePosition];
-                                                    
-                            if ([badgePosition length] > 0) {
-                                                        
-                                if ([badgePosition containsString:@"t"]) {
-                                    
-                                    if ([badgePosition containsString:@"l"]) {
-                                        position = MTBadgePositionTopLeft;
-                                    } else if ([badgePosition containsString:@"r"]) {
-                                        position = MTBadgePositionTopRight;
-                                    }
-                                    
-                                } else if ([badgePosition containsString:@"b"]) {
-                                                                                                
-                                    if ([badgePosition containsString:@"l"]) {
-                                        position = MTBadgePositionBottomLeft;
-                                    } else if ([badgePosition containsString:@"r"]) {
-                                        position = MTBadgePositionBottomRight;
-                                    }
-                                }
-                            }
-                                                    
-                            [uninstallIconView setBadgePosition:position];
-                            
-                        } else {
-                            
-                            [self writeConsole:@"ERROR! Ignoring invalid custom delege badge"];
-                        }
-                    }
+                    MTTraceTimestamp decodeBegin = MTTraceBegin();
+                    NSImage *decodedImage = [NSImage imageWithFileAtURL:decodeURL];
+                    MTTraceEnd("decode source", decodeBegin);
                     
-                    if (![[deleteBadge image] isValid]) {
-                        
-                        NSData *svgData = [NSData dataWithBytesNoCopy:DeleteBadge_svg
-                                                               length:DeleteBadge_svg_len
-                                                         freeWhenDone:NO
-                        ];
-                        
-                        if (svgData) {
-                            
-                            [deleteBadge setImage:[[NSImage alloc] initWithData:svgData]];
-                            [deleteBadge setShowsShadow:YES];
-                            [deleteBadge setShadowOffset:kMTBadgeShadowOffsetDefault];
-                            [deleteBadge setShadowAngle:kMTBadgeShadowAngleDefault];
-                            [deleteBadge setShadowColor:nil];
-                            [deleteBadge setShadowRadius:kMTBadgeShadowRadiusDefault];
-                        }
-                    }
+                    [condition lock];
+                    [decodedApps setObject:([decodedImage isValid]) ? decodedImage : [NSNull null] forKey:decodeKey];
+                    [condition signal];
+                    [condition unlock];
+                });
+            }
+            
+            [condition wait];
+        }
+        
+        if (sourceImage) {
+            
+            [decodedApps removeObjectForKey:appIndex];
+            bundleURL = [foundApps objectAtIndex:renderIndex];
+        }
+        
+        [condition unlock];
+        
+        // all apps have been found and processed
+        if (!sourceImage) { break; }
+        
+        @autoreleasepool {
+            
+            [self writeConsole:[NSString stringWithFormat:@"\nProcessing %@", [bundleURL path]]];
+            
+            if ([sourceImage isKindOfClass:[NSImage class]]) {
+                
+                NSString *fileNamePrefix = [self fileNamePrefixWithSourcePath:[bundleURL path] arguments:appArguments];
+                
+                // apps with the same name (e.g. in different folders) are numbered
+                NSUInteger prefixCount = [fileNamePrefixes countForObject:fileNamePrefix];
+                [fileNamePrefixes addObject:fileNamePrefix];
+                if (prefixCount > 0) { fileNamePrefix = [fileNamePrefix stringByAppendingFormat:@"_%lu", (unsigned long)prefixCount + 1]; }
+                
+                int appExitCode = [self createIconsWithImage:sourceImage sourcePath:[bundleURL path] fileNamePrefix:fileNamePrefix arguments:appArguments];
+                if (appExitCode != 0) { exitCode = appExitCode; }
+                
+            } else {
+                
+                [self writeConsole:@"ERROR! Unable to open source image"];
+                exitCode = 2;
+            }
+        }
+    }
+    
+    return exitCode;
+}
+
+- (int)watchFolder:(NSString*)folderPath arguments:(MTProcessInfo*)appArguments
+{
+    int exitCode = 0;
+    
+    // FSEvents reports paths with symbolic links resolved
+    NSString *watchPath = [[folderPath stringByResolvingSymlinksInPath] stringByStandardizingPath];
+    NSString *outputPath = [[[appArguments outputFolderPath] stringByResolvingSymlinksInPath] stringByStandardizingPath];
+    
+    if ([outputPath isEqualToString:watchPath] || [outputPath hasPrefix:[watchPath stringByAppendingString:@"/"]]) {
+        
+        [self writeConsole:@"ERROR! The output folder must not be inside the watched folder"];
+        return 255;
+    }
+    
+    // all icon sets depend on the custom delete badge and the preset (if any),
+    // so we also watch their folders if they are not inside the watched folder
+    NSMutableArray *sharedDependencies = [NSMutableArray array];
+    NSMutableArray *watchedPaths = [NSMutableArray arrayWithObject:watchPath];
+    NSString *badgePath = [appArguments deleteBadgeFilePath];
+    NSString *presetPath = [appArguments presetFilePath];
+    
+    if (badgePath) { [sharedDependencies addObject:[[badgePath stringByResolvingSymlinksInPath] stringByStandardizingPath]]; }
+    
+    if (presetPath) {
+        
+        presetPath = [[presetPath stringByResolvingSymlinksInPath] stringByStandardizingPath];
+        [sharedDependencies addObject:presetPath];
+    }
+    
+    for (NSString *dependencyPath in sharedDependencies) {
+        
+        NSString *dependencyFolderPath = [dependencyPath stringByDeletingLastPathComponent];
+        
+        if (![dependencyFolderPath isEqualToString:watchPath] && ![dependencyFolderPath hasPrefix:[watchPath stringByAppendingString:@"/"]] && ![watchedPaths containsObject:dependencyFolderPath]) {
+            [watchedPaths addObject:dependencyFolderPath];
+        }
+    }
+    
+    MTFolderWatcher *folderWatcher = [[MTFolderWatcher alloc] initWithPaths:watchedPaths debounceInterval:kMTWatchDebounceInterval];
+    
+    if (![folderWatcher start]) {
+        
+        [self writeConsole:@"ERROR! Unable to watch folder"];
+        return 1;
+    }
+    
+    // stop watching on Ctrl-C, so the trace file and statistics are still written
+    signal(SIGINT, SIG_IGN);
+    dispatch_source_t signalSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_SIGNAL, SIGINT, 0, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+    dispatch_source_set_event_handler(signalSource, ^{ [folderWatcher stop]; });
+    dispatch_resume(signalSource);
+    
+    MTDependencyTracker *dependencyTracker = [[MTDependencyTracker alloc] init];
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    
+    // the watcher has been started before, so changes made while
+    // the existing sources are processed are not missed
+    NSMutableSet *dirtySources = [NSMutableSet setWithArray:[self sourcePathsInFolder:watchPath watchedFolder:watchPath]];
+    NSSet *changedPaths = nil;
+    
+    do {
+        
+        if (changedPaths) {
+            
+            // the preset provides the defaults for most of the options,
+            // so it's loaded again before the icon sets are updated
+            if (presetPath && [changedPaths containsObject:presetPath]) {
+                
+                [appArguments reloadRenderPreset];
+                
+                if ([appArguments renderPreset]) {
+                    [self writeConsole:[NSString stringWithFormat:@"\n%@ has been modified", presetPath]];
+                } else {
+                    [self writeConsole:@"\nERROR! Unable to load preset"];
+                }
+            }
+            
+            // sources whose files (or the files they depend on) have been modified
+            [dirtySources unionSet:[dependencyTracker targetsAffectedByPaths:changedPaths]];
+            
+            // new sources
+            for (NSString *changedPath in changedPaths) {
+                
+                NSString *sourcePath = [self sourcePathWithPath:changedPath watchedFolder:watchPath];
+                BOOL isDirectory = NO;
+                
+                if (sourcePath) {
                     
-                    [uninstallIconView setDeleteBadge:deleteBadge];
+                    if (![dependencyTracker containsTarget:sourcePath]) { [dirtySources addObject:sourcePath]; }
                     
-                    if ([argExcludeFromCreation containsString:@"u"]) {
-                        [self writeConsole:@"Skipping creation of uninstall icon"];
-                    }
+                } else if ([fileManager fileExistsAtPath:changedPath isDirectory:&isDirectory] && isDirectory) {
                     
-                    // get the duration
-                    if (argAnimationDuration > 0) {
-                        argAnimationDuration = (argAnimationDuration >= kMTAnimationDurationMin && argAnimationDuration <= kMTAnimationDurationMax) ? argAnimationDuration : kMTAnimationDurationDefault;
-                    } else {
-                        [self writeConsole:@"Skipping creation of animated uninstall icon"];
+                    // a folder has been added or must be rescanned
+                    for (NSString *folderSourcePath in [self sourcePathsInFolder:changedPath watchedFolder:watchPath]) {
+                        if (![dependencyTracker containsTarget:folderSourcePath]) { [dirtySources addObject:folderSourcePath]; }
                     }
-                    
-                } else {
-                    [self writeConsole:@"Skipping creation of uninstall icon and animated uninstall icon"];
                 }
+            }
+        }
+        
+        for (NSString *sourcePath in [[dirtySources allObjects] sortedArrayUsingSelector:@selector(compare:)]) {
+            
+            @autoreleasepool {
                 
-                if (installIconView || uninstallIconView) {
+                if ([fileManager fileExistsAtPath:sourcePath]) {
                     
-                    // calculate output size
-                    NSSize outputSize = NSZeroSize;
-                    NSInteger argOutputSize = [appArguments outputSize];
-
-                    if (argOutputSize == 0 || argOutputSize > kMTOutputSizeMax) {
+                    [self writeConsole:[NSString stringWithFormat:@"\nProcessing %@", sourcePath]];
+                    
+                    // the dependencies are recorded before the source is read, so changes
+                    // made while the icon set is created cause another update
+                    [dependencyTracker setDependencies:[[NSArray arrayWithObject:sourcePath] arrayByAddingObjectsFromArray:sharedDependencies]
+                                             forTarget:sourcePath
+                    ];
+                    
+                    MTTraceTimestamp decodeBegin = MTTraceBegin();
+                    NSImage *sourceImage = [NSImage imageWithFileAtURL:[NSURL fileURLWithPath:sourcePath]];
+                    MTTraceEnd("decode source", decodeBegin);
+                    
+                    if ([sourceImage isValid]) {
                         
-                        // auto size
-                        for (NSNumber *anOutputSize in [kMTOutputSizes reverseObjectEnumerator]) {
-                            NSSize tempOutputSize = NSMakeSize([anOutputSize floatValue], [anOutputSize floatValue]);
-                            BOOL canBeScaled = [sourceImage canBeScaledToSize:tempOutputSize];
-                            
-                            if (canBeScaled) {
-                                outputSize = tempOutputSize;
-                                break;
-                            }
-                        }
+                        NSString *fileNamePrefix = [self fileNamePrefixWithSourcePath:sourcePath arguments:appArguments];
+                        int sourceExitCode = [self createIconsWithImage:sourceImage sourcePath:sourcePath fileNamePrefix:fileNamePrefix arguments:appArguments];
+                        if (sourceExitCode != 0) { exitCode = sourceExitCode; }
                         
                     } else {
-                        outputSize = NSMakeSize(argOutputSize, argOutputSize);
+                        
+                        [self writeConsole:@"ERROR! Unable to open source image"];
+                        exitCode = 2;
                     }
                     
-                    [self writeConsole:[NSString stringWithFormat:@"Output size is %ld x %ld pixels", (long)outputSize.width, (long)outputSize.height]];
+                } else if ([dependencyTracker containsTarget:sourcePath]) {
                     
-                    // calculate inset
-                    CGFloat argImageInset = [appArguments imageInset];
+                    [self writeConsole:[NSString stringWithFormat:@"\n%@ has been removed", sourcePath]];
+                    [dependencyTracker removeTarget:sourcePath];
+                }
+            }
+        }
+        
+        [dirtySources removeAllObjects];
+        if (![_fileWriter flush]) { exitCode = 3; }
+        if (!changedPaths) { [self writeConsole:[NSString stringWithFormat:@"\nWatching %@ for changes. Press Ctrl-C to stop.", watchPath]]; }
+        
+    } while ((changedPaths = [folderWatcher waitForChanges]));
+    
+    dispatch_source_cancel(signalSource);
+    signal(SIGINT, SIG_DFL);
+    
+    return exitCode;
+}
 
-                    if (argImageInset != 0) {
-                        
-                        CGFloat imageInset = argImageInset / 100;
+- (NSString*)sourcePathWithPath:(NSString*)path watchedFolder:(NSString*)folderPath
+{
+    NSString *sourcePath = nil;
+    
+    if ([path hasPrefix:[folderPath stringByAppendingString:@"/"]]) {
+        
+        NSArray *pathComponents = [[path substringFromIndex:[folderPath length] + 1] pathComponents];
+        NSString *currentPath = folderPath;
+        
+        for (NSUInteger i = 0; i < [pathComponents count]; i++) {
+            
+            NSString *pathComponent = [pathComponents objectAtIndex:i];
+            
+            // ignore hidden files (e.g. temporary files of editors)
+            if ([pathComponent hasPrefix:@"."]) { break; }
+            
+            currentPath = [currentPath stringByAppendingPathComponent:pathComponent];
+            NSString *fileExtension = [[pathComponent pathExtension] lowercaseString];
+            
+            // changes inside of app bundles and bundle packages belong to the bundle
+            if ([fileExtension isEqualToString:@"app"] || [MTPackage isPackageAtURL:[NSURL fileURLWithPath:currentPath]]) {
+                
+                sourcePath = currentPath;
+                break;
+                
+            } else if (i == [pathComponents count] - 1) {
+                
+                UTType *fileType = [UTType typeWithFilenameExtension:fileExtension];
+                
+                if ([fileType conformsToType:UTTypeImage] || [fileType conformsToType:UTTypePDF]) {
+                    sourcePath = currentPath;
+                }
+            }
+        }
+    }
+    
+    return sourcePath;
+}
+
+- (NSArray*)sourcePathsInFolder:(NSString*)folderPath watchedFolder:(NSString*)watchedFolderPath
+{
+    NSMutableArray *sourcePaths = [NSMutableArray array];
+    NSDirectoryEnumerator *enumerator = [[NSFileManager defaultManager] enumeratorAtURL:[NSURL fileURLWithPath:folderPath isDirectory:YES]
+                                                             includingPropertiesForKeys:nil
+                                                                                options:NSDirectoryEnumerationSkipsHiddenFiles | NSDirectoryEnumerationSkipsPackageDescendants
+                                                                           errorHandler:nil
+    ];
+    
+    for (NSURL *fileURL in enumerator) {
+        
+        NSString *path = [[fileURL path] stringByStandardizingPath];
+        if ([[self sourcePathWithPath:path watchedFolder:watchedFolderPath] isEqualToString:path]) { [sourcePaths addObject:path]; }
+    }
+    
+    return sourcePaths;
+}
+
+- (id<MTFileGroupWriter>)fileWriterWithArguments:(MTProcessInfo*)appArguments
+{
+    id<MTFileGroupWriter> fileWriter = nil;
+    NSString *argArchiveFilePath = [appArguments archiveFilePath];
+    
+    if (argArchiveFilePath) {
+        
+        // stream all images into a single archive (or a framed stream) instead of writing them to the output folder
+        NSString *argArchiveFormat = [appArguments archiveFormat];
+        MTArchiveFormat archiveFormat = MTArchiveFormatTar;
+        
+        if (!argArchiveFormat) { argArchiveFormat = ([[[argArchiveFilePath pathExtension] lowercaseString] isEqualToString:@"zip"]) ? @"zip" : @"tar"; }
+        
+        if ([argArchiveFormat isEqualToString:@"zip"]) {
+            archiveFormat = MTArchiveFormatZip;
+        } else if ([argArchiveFormat isEqualToString:@"zip-stored"]) {
+            archiveFormat = MTArchiveFormatZipStored;
+        } else if ([argArchiveFormat isEqualToString:@"stream"]) {
+            archiveFormat = MTArchiveFormatStream;
+        }
+        
+        int fileDescriptor = ([argArchiveFilePath isEqualToString:@"-"]) ? dup(STDOUT_FILENO) : open([argArchiveFilePath fileSystemRepresentation], O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fileDescriptor >= 0) { fileWriter = [[MTArchiveWriter alloc] initWithFileDescriptor:fileDescriptor format:archiveFormat]; }
+        
+    } else {
+        
+        // the icon sets of all sources are written by the same batch writer,
+        // so the files of many icon sets are flushed to disk together
+        fileWriter = [[MTBatchWriter alloc] initWithFolderPath:[appArguments outputFolderPath] batchSize:kMTWriteBatchSize];
+    }
+    
+    return fileWriter;
+}
+
+- (NSString*)fileNamePrefixWithSourcePath:(NSString*)sourcePath arguments:(MTProcessInfo*)appArguments
+{
+    // every source gets its own file name prefix, based on the name of the source
+    NSString *fileNamePrefix = [[sourcePath lastPathComponent] stringByDeletingPathExtension];
+    NSString *argFileNamePrefix = [appArguments fileNamePrefix];
+    
+    if ([argFileNamePrefix length] > 0) { fileNamePrefix = [NSString stringWithFormat:@"%@_%@", argFileNamePrefix, fileNamePrefix]; }
+    
+    return [MTIconSet fileNamePrefixWithString:fileNamePrefix];
+}
+
+- (int)createIconsWithImage:(NSImage*)sourceImage sourcePath:(NSString*)sourcePath fileNamePrefix:(NSString*)baseFileNamePrefix arguments:(MTProcessInfo*)appArguments
+{
+    __block int exitCode = 0;
+    
+    // calculate output size
+    MTTraceTimestamp outputSizeBegin = MTTraceBegin();
+    NSSize outputSize = NSZeroSize;
+    NSInteger argOutputSize = [appArguments outputSize];
+    
+    if (argOutputSize == 0 || argOutputSize > kMTOutputSizeMax) {
+        
+        // auto size
+        for (NSNumber *anOutputSize in [kMTOutputSizes reverseObjectEnumerator]) {
+            NSSize tempOutputSize = NSMakeSize([anOutputSize floatValue], [anOutputSize floatValue]);
+            BOOL canBeScaled = [sourceImage canBeScaledToSize:tempOutputSize];
+            
+            if (canBeScaled) {
+                outputSize = tempOutputSize;
+                break;
+            }
+        }
+        
+    } else {
+        outputSize = NSMakeSize(argOutputSize, argOutputSize);
+    }
+    
+    MTTraceEnd("calculate output size", outputSizeBegin);
+    
+    // the views are rendered directly at the output size (or a multiple of
+    // it, if supersampling has been requested)
+    NSUInteger supersamplingFactor = [appArguments supersamplingFactor];
+    NSSize renderSize = NSMakeSize(outputSize.width * supersamplingFactor, outputSize.height * supersamplingFactor);
+    NSRect viewFrame = [MTDropView frameWithContentSize:renderSize];
+    
+    NSString *argExcludeFromCreation = [appArguments excludeFromCreation];
+    
+#pragma mark Install icon
+    
+    MTInstallIconView *installIconView = nil;
+    
+    if (![argExcludeFromCreation containsString:@"i"]) {
+        
+        MTTraceTimestamp setUpBegin = MTTraceBegin();
+        installIconView = [[MTInstallIconView alloc] initWithFrame:viewFrame];
+        
+        // banner (the text, color and position are set per variant)
+        [installIconView setBannerTextMargin:[appArguments textMargin]];
+        [installIconView setBannerAngle:[appArguments bannerAngle]];
+        [installIconView setBannerHeight:[appArguments bannerHeight]];
+        [installIconView setBannerMargin:[appArguments bannerMargin]];
+        
+        MTTraceEnd("set up install view", setUpBegin);
+        
+    } else {
+        [self writeConsole:@"Skipping creation of install icon"];
+    }
+    
+#pragma mark Uninstall icon
+    
+    MTUninstallIconView *uninstallIconView = nil;
+    CGFloat argAnimationDuration = ([argExcludeFromCreation containsString:@"a"]) ? 0 : [appArguments animationDuration];
+    
+    if (!([argExcludeFromCreation containsString:@"u"] && [argExcludeFromCreation containsString:@"a"])) {
+        
+        MTTraceTimestamp setUpBegin = MTTraceBegin();
+        uninstallIconView = [[MTUninstallIconView alloc] initWithFrame:viewFrame];
+        [uninstallIconView setBadgeSize:kMTBadgeIconSizeDefault];
+        [uninstallIconView setBadgeMargin:kMTBadgeIconMarginDefault];
+        
+        MTDeleteBadgeView *deleteBadge = [[MTDeleteBadgeView alloc] initWithFrame:[uninstallIconView bounds]];
+        NSString *customDeleteBadgePath = [appArguments deleteBadgeFilePath];
+        
+        if (customDeleteBadgePath) {
+            
+            NSImage *customDeleteBadge = [[NSImage alloc] initByReferencingFile:customDeleteBadgePath];
+        
+            if ([customDeleteBadge isValid]) {
+                
+                [deleteBadge setImage:customDeleteBadge];
+                [deleteBadge setShowsShadow:NO];
+                
+                [uninstallIconView setBadgeSize:[appArguments deleteBadgeSize]];
+                [uninstallIconView setBadgeMargin:[appArguments deleteBadgeMargin]];
+                
+                // badge position
+                MTBadgePosition position = MTBadgePositionTopLeft;
+                NSString *badgePosition = [appArguments deleteBadgePosition];
+                                        
+                if ([badgePosition length] > 0) {
+                                            
+                    if ([badgePosition containsString:@"t"]) {
                         
-                        if (imageInset > kMTImageInsetMin && imageInset <= kMTImageInsetMax) {
-                            [uninstallIconView setImageInset:imageInset];
-                        } else {
-                            imageInset = [uninstallIconView autoInset];
-                            [uninstallIconView setImageInset:imageInset];
+                        if ([badgePosition containsString:@"l"]) {
+                            position = MTBadgePositionTopLeft;
+                        } else if ([badgePosition containsString:@"r"]) {
+                            position = MTBadgePositionTopRight;
                         }
                         
-                        [self writeConsole:[NSString stringWithFormat:@"Reducing uninstall image size by %.1f percent", imageInset * 100]];
-                    }
-                    
-                    // process the file name prefix
-                    NSString *argFileNamePrefix = [appArguments fileNamePrefix];
-
-                    if (argFileNamePrefix && [argFileNamePrefix length] == 0) {
-                        argFileNamePrefix = [[argInputFilePath lastPathComponent] stringByDeletingPathExtension];
-                    } else {
-                        argFileNamePrefix = [MTIconSet fileNamePrefixWithString:argFileNamePrefix];
+                    } else if ([badgePosition containsString:@"b"]) {
+                                                                                    
+                        if ([badgePosition containsString:@"l"]) {
+                            position = MTBadgePositionBottomLeft;
+                        } else if ([badgePosition containsString:@"r"]) {
+                            position = MTBadgePositionBottomRight;
+                        }
                     }
+                }
+                                        
+                [uninstallIconView setBadgePosition:position];
+                
+            } else {
+                
+                [self writeConsole:@"ERROR! Ignoring invalid custom delege badge"];
+            }
+            
+        } else if ([[appArguments renderPreset] deleteBadgeImage]) {
+            
+            // the custom delete badge of the preset
+            MTRenderPreset *preset = [appArguments renderPreset];
+            
+            [deleteBadge setImage:[preset deleteBadgeImage]];
+            [deleteBadge setShowsShadow:[preset badgeShowsShadow]];
+            [deleteBadge setShadowRadius:[preset badgeShadowRadius]];
+            [deleteBadge setShadowOffset:[preset badgeShadowOffset]];
+            [deleteBadge setShadowAngle:[preset badgeShadowAngle]];
+            [deleteBadge setShadowColor:[preset badgeShadowColor]];
+            
+            [uninstallIconView setBadgeSize:[preset badgeSize]];
+            [uninstallIconView setBadgeMargin:[preset badgeMargin]];
+            [uninstallIconView setBadgePosition:[preset badgePosition]];
+        }
+        
+        if (![[deleteBadge image] isValid]) {
+            
+            NSData *svgData = [NSData dataWithBytesNoCopy:DeleteBadge_svg
+                                                   length:DeleteBadge_svg_len
+                                             freeWhenDone:NO
+            ];
+            
+            if (svgData) {
+                
+                [deleteBadge setImage:[[NSImage alloc] initWithData:svgData]];
+                [deleteBadge setShowsShadow:YES];
+                [deleteBadge setShadowOffset:kMTBadgeShadowOffsetDefault];
+                [deleteBadge setShadowAngle:kMTBadgeShadowAngleDefault];
+                [deleteBadge setShadowColor:nil];
+                [deleteBadge setShadowRadius:kMTBadgeShadowRadiusDefault];
+            }
+        }
+        
+        [uninstallIconView setDeleteBadge:deleteBadge];
+        MTTraceEnd("set up uninstall view", setUpBegin);
+        
+        if ([argExcludeFromCreation containsString:@"u"]) {
+            [self writeConsole:@"Skipping creation of uninstall icon"];
+        }
+        
+        // get the duration
+        if (argAnimationDuration > 0) {
+            argAnimationDuration = (argAnimationDuration >= kMTAnimationDurationMin && argAnimationDuration <= kMTAnimationDurationMax) ? argAnimationDuration : kMTAnimationDurationDefault;
+        } else {
+            [self writeConsole:@"Skipping creation of animated uninstall icon"];
+        }
+        
+    } else {
+        [self writeConsole:@"Skipping creation of uninstall icon and animated uninstall icon"];
+    }
+    
+    if (installIconView || uninstallIconView) {
+        
+        [self writeConsole:[NSString stringWithFormat:@"Output size is %ld x %ld pixels", (long)outputSize.width, (long)outputSize.height]];
+        if (supersamplingFactor > 1) { [self writeConsole:[NSString stringWithFormat:@"Rendering at %ld x %ld pixels", (long)renderSize.width, (long)renderSize.height]]; }
+        
+        // create the icon files
+        if (![sourceImage canBeScaledToSize:outputSize]) { [self writeConsole:@"Source file is too small for the selected output size and has been upscaled"]; }
+        
+        // the icon set with the banner from -b, -c and -p is always created,
+        // the variants are created in addition to it
+        NSMutableDictionary *baseVariant = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+                                            ([appArguments bannerText]) ? [appArguments bannerText] : @"", kMTVariantBannerTextKey,
+                                            [NSNumber numberWithUnsignedInteger:[appArguments bannerColor]], kMTVariantBannerColorKey,
+                                            nil
+        ];
+        
+        if ([appArguments bannerPosition]) { [baseVariant setObject:[appArguments bannerPosition] forKey:kMTVariantBannerPositionKey]; }
+        
+        // without a banner text, the banner of the preset (if any) is used with its fonts and colors
+        NSAttributedString *presetBannerAttributes = [[appArguments renderPreset] bannerAttributes];
+        if (![appArguments bannerText] && [presetBannerAttributes length] > 0) { [baseVariant setObject:presetBannerAttributes forKey:kMTVariantBannerAttributesKey]; }
+        
+        NSArray *variants = [[NSArray arrayWithObject:baseVariant] arrayByAddingObjectsFromArray:[appArguments variants]];
+        
+        // the processing steps are expressed as a render graph, so steps that are needed by
+        // several icons (e.g. the scaled source image) or by several variants (e.g. the
+        // uninstall icon and its animation) are only executed once. Independent steps (e.g.
+        // encoding the uninstall icons while the install icons are rendered) run concurrently.
+        MTRenderGraph *renderGraph = [[MTRenderGraph alloc] init];
+        MTIconSet *iconSet = [[MTIconSet alloc] init];
+        [iconSet setAnimationDuration:argAnimationDuration];
+        BOOL animatedOnly = [argExcludeFromCreation containsString:@"u"];
+        
+        NSString *sourceKey = [renderGraph addNodeWithKey:[MTRenderGraph keyWithOperation:@"decode" parameters:sourcePath dependencies:nil]
+                                             dependencies:nil
+                                                  options:MTRenderGraphNodeOptionsNone
+                                                    block:^id(NSArray *inputs) {
+            return sourceImage;
+        }];
+        
+        // scale the source image down once instead of resampling it
+        // again for every view and every animation frame
+        NSString *scaleKey = [renderGraph addNodeWithKey:[MTRenderGraph keyWithOperation:@"scale" parameters:NSStringFromSize(renderSize) dependencies:[NSArray arrayWithObject:sourceKey]]
+                                            dependencies:[NSArray arrayWithObject:sourceKey]
+                                                 options:MTRenderGraphNodeOptionsNone
+                                                   block:^id(NSArray *inputs) {
+            NSImage *scaledImage = [[inputs firstObject] imageByScalingToFitPixelSize:renderSize];
+            return (scaledImage) ? scaledImage : [inputs firstObject];
+        }];
+        
+#pragma mark Render uninstall icon
+        
+        NSMutableArray *uninstallKeys = [NSMutableArray array];
+        NSString *insetKey = nil;
+        CGFloat imageInset = 0;
+        
+        if (uninstallIconView) {
+            
+            // calculate inset
+            CGFloat argImageInset = [appArguments imageInset];
+            NSMutableArray *renderDependencies = [NSMutableArray arrayWithObject:scaleKey];
+            
+            if (argImageInset != 0) {
+                
+                imageInset = argImageInset / 100;
+                
+                if (imageInset <= kMTImageInsetMin || imageInset > kMTImageInsetMax) {
                     
-                    // create the icon files
-                    if (![sourceImage canBeScaledToSize:outputSize]) { [self writeConsole:@"Source file is too small for the selected output size and has been upscaled"]; }
+                    // the view only gets a downscaled copy of the source
+                    // image, so we calculate the inset from the original
+                    insetKey = [renderGraph addNodeWithKey:[MTRenderGraph keyWithOperation:@"inset" parameters:nil dependencies:[NSArray arrayWithObject:sourceKey]]
+                                              dependencies:[NSArray arrayWithObject:sourceKey]
+                                                   options:MTRenderGraphNodeOptionsRetainOutput
+                                                     block:^id(NSArray *inputs) {
+                        return [NSNumber numberWithDouble:[MTUninstallIconView autoInsetWithImage:[inputs firstObject]]];
+                    }];
                     
-                    MTIconSet *iconSet = [[MTIconSet alloc] init];
-                    [iconSet setInstallIcon:([installIconView icon]) ? [NSImage imageWithView:[installIconView icon] size:outputSize] : nil];
-                    [iconSet setUninstallIcon:([uninstallIconView icon]) ? [NSImage imageWithView:[uninstallIconView icon] size:outputSize] : nil];
-                    [iconSet setAnimationDuration:argAnimationDuration];
-                    [iconSet setFileNamePrefix:argFileNamePrefix];
+                    [renderDependencies addObject:insetKey];
+                }
+            }
+            
+            NSString *renderKey = [renderGraph addNodeWithKey:[MTRenderGraph keyWithOperation:@"render uninstall" parameters:nil dependencies:renderDependencies]
+                                                 dependencies:renderDependencies
+                                                      options:MTRenderGraphNodeOptionsMainThread
+                                                        block:^id(NSArray *inputs) {
+                
+                [uninstallIconView setImage:[inputs firstObject]];
+                
+                if ([inputs count] > 1) {
+                    [uninstallIconView setImageInset:[[inputs lastObject] doubleValue]];
+                } else if (imageInset > 0) {
+                    [uninstallIconView setImageInset:imageInset];
+                }
+                
+                MTTraceTimestamp renderBegin = MTTraceBegin();
+                [iconSet setUninstallIcon:[NSImage imageWithView:[uninstallIconView icon] size:outputSize]];
+                MTTraceEnd("render uninstall icon", renderBegin);
+                
+                return [iconSet uninstallIcon];
+            }];
+            
+            // encode the uninstall icons only once for all variants
+            if (!animatedOnly) {
+                
+                [uninstallKeys addObject:[renderGraph addNodeWithKey:[MTRenderGraph keyWithOperation:@"encode" parameters:@"png" dependencies:[NSArray arrayWithObject:renderKey]]
+                                                        dependencies:[NSArray arrayWithObject:renderKey]
+                                                             options:MTRenderGraphNodeOptionsNone
+                                                               block:^id(NSArray *inputs) {
+                    return [iconSet uninstallIconData];
+                }]];
+            }
+            
+            if (argAnimationDuration > 0) {
+                
+                [uninstallKeys addObject:[renderGraph addNodeWithKey:[MTRenderGraph keyWithOperation:@"encode" parameters:@"apng" dependencies:[NSArray arrayWithObject:renderKey]]
+                                                        dependencies:[NSArray arrayWithObject:renderKey]
+                                                             options:MTRenderGraphNodeOptionsNone
+                                                               block:^id(NSArray *inputs) {
+                    return [iconSet animatedUninstallIconData];
+                }]];
+            }
+            
+            if ([uninstallKeys count] == 0) { [uninstallKeys addObject:renderKey]; }
+        }
+        
+#pragma mark Render install icons and write the variants
+        
+        NSMutableArray *writeKeys = [NSMutableArray array];
+        NSMutableArray *writeNames = [NSMutableArray array];
+        
+        // the variants are handed to the writer as soon as they have been encoded, but in a fixed
+        // order, no matter in which order the encodes finish. A variant that is done before the
+        // previous ones waits for them. The batch writer writes the files in the background, an
+        // archive writer appends them right away
+        NSMutableDictionary *encodedVariants = [NSMutableDictionary dictionary];
+        __block NSUInteger nextWriteIndex = 0;
+        
+        void (^writeEncodedVariants)(void) = ^{
+            
+            NSDictionary *files = nil;
+            
+            while ((files = [encodedVariants objectForKey:[NSNumber numberWithUnsignedInteger:nextWriteIndex]])) {
+                
+                NSString *variantName = [writeNames objectAtIndex:nextWriteIndex];
+                [encodedVariants removeObjectForKey:[NSNumber numberWithUnsignedInteger:nextWriteIndex]];
+                nextWriteIndex++;
+                
+                if ([files isKindOfClass:[NSDictionary class]]) {
                     
-                    [iconSet writeToFolder:argOutputFolderPath
-                              createFolder:NO
-                              animatedOnly:([argExcludeFromCreation containsString:@"u"])
-                         completionHandler:^(BOOL success, NSString *path, NSError *error) {
+                    [self->_fileWriter addFiles:files completionHandler:^(BOOL success, NSError *error) {
                         
                         if (success) {
-                            [self writeConsole:@"Output files have been successfully written"];
+                            
+                            if ([variantName isKindOfClass:[NSString class]]) {
+                                [self writeConsole:[NSString stringWithFormat:@"Output files for variant \"%@\" have been successfully written", variantName]];
+                            } else {
+                                [self writeConsole:@"Output files have been successfully written"];
+                            }
+                            
                         } else {
                             [self writeConsole:@"ERROR! Failed to write output file(s)"];
-                            exitCode = 3;
                         }
                     }];
                     
                 } else {
-                    [self writeConsole:@"All icons have been excluded from creation. Nothing to do"];
+                    
+                    [self writeConsole:@"ERROR! Failed to write output file(s)"];
+                    exitCode = 3;
                 }
+            }
+        };
+        
+        for (NSDictionary *variant in variants) {
+            
+            NSString *variantName = [variant objectForKey:kMTVariantNameKey];
+            NSMutableArray *writeDependencies = [NSMutableArray arrayWithArray:uninstallKeys];
+            
+            if (installIconView) {
                 
-            } else {
-                [self writeConsole:@"ERROR! Unable to open source image"];
-                exitCode = 2;
+                NSAttributedString *presetBannerAttributes = [variant objectForKey:kMTVariantBannerAttributesKey];
+                NSString *bannerText = (presetBannerAttributes) ? [presetBannerAttributes string] : [variant objectForKey:kMTVariantBannerTextKey];
+                NSUInteger bannerColor = [[variant objectForKey:kMTVariantBannerColorKey] unsignedIntegerValue];
+                MTBannerPosition bannerPosition = [self bannerPositionWithString:[variant objectForKey:kMTVariantBannerPositionKey]];
+                
+                // variants with the same banner share the same install icon. A preset
+                // banner is styled, so it is identified by its RTF data and never by its
+                // text only, which a plain banner might have as well
+                NSString *bannerParameters = nil;
+                
+                if (presetBannerAttributes) {
+                    bannerParameters = [NSString stringWithFormat:@"rtf|%@|%ld", [self digestWithAttributedString:presetBannerAttributes], (long)bannerPosition];
+                } else if ([bannerText length] > 0) {
+                    bannerParameters = [NSString stringWithFormat:@"text|%06lx|%ld|%@", (unsigned long)bannerColor, (long)bannerPosition, bannerText];
+                }
+                
+                NSString *renderKey = [renderGraph addNodeWithKey:[MTRenderGraph keyWithOperation:@"render install" parameters:bannerParameters dependencies:[NSArray arrayWithObject:scaleKey]]
+                                                     dependencies:[NSArray arrayWithObject:scaleKey]
+                                                          options:MTRenderGraphNodeOptionsMainThread
+                                                            block:^id(NSArray *inputs) {
+                    
+                    [installIconView setImage:[inputs firstObject]];
+                    
+                    // stamp the banner of this variant
+                    NSAttributedString *bannerAttributes = presetBannerAttributes;
+                    
+                    if (!bannerAttributes && [bannerText length] > 0) {
+                        
+                        bannerAttributes = [[NSAttributedString alloc] initWithString:bannerText
+                                                                                 font:[NSFont systemFontOfSize:0.0]
+                                                                      foregroundColor:[NSColor colorFromInteger:[appArguments textColor]]
+                                                                      backgroundColor:[NSColor colorFromInteger:bannerColor]];
+                    }
+                    
+                    [installIconView setBannerAttributes:bannerAttributes];
+                    [installIconView setBannerPosition:bannerPosition];
+                    
+                    MTTraceTimestamp renderBegin = MTTraceBegin();
+                    NSImage *installIcon = [NSImage imageWithView:[installIconView icon] size:outputSize];
+                    MTTraceEnd("render install icon", renderBegin);
+                    
+                    return installIcon;
+                }];
+                
+                [writeDependencies insertObject:renderKey atIndex:0];
+            }
+            
+            // every variant gets its own file name prefix
+            NSString *fileNamePrefix = baseFileNamePrefix;
+            
+            if (variantName) {
+                
+                fileNamePrefix = (fileNamePrefix) ? [fileNamePrefix stringByAppendingFormat:@"_%@", variantName] : variantName;
+                fileNamePrefix = [MTIconSet fileNamePrefixWithString:fileNamePrefix];
+            }
+            
+            // the variant names have been checked to be unique, so
+            // every variant gets its own encode node and index
+            NSNumber *writeIndex = [NSNumber numberWithUnsignedInteger:[writeKeys count]];
+            
+            NSString *writeKey = [renderGraph addNodeWithKey:[MTRenderGraph keyWithOperation:@"encode" parameters:(fileNamePrefix) ? fileNamePrefix : @"" dependencies:writeDependencies]
+                                                dependencies:writeDependencies
+                                                     options:MTRenderGraphNodeOptionsNone
+                                                       block:^id(NSArray *inputs) {
+                
+                // the copy shares the encoded uninstall icons
+                MTIconSet *variantIconSet = [iconSet copy];
+                if (installIconView) { [variantIconSet setInstallIcon:[inputs firstObject]]; }
+                [variantIconSet setFileNamePrefix:fileNamePrefix];
+                
+                NSDictionary *files = [variantIconSet filesWithAnimatedOnly:animatedOnly];
+                
+                // the images have been encoded, so the scratch
+                // memory of the render arena can be reused
+                MTRenderArenaReset(MTRenderArenaGetCurrent());
+                
+                @synchronized (encodedVariants) {
+                    
+                    [encodedVariants setObject:(files) ? files : [NSNull null] forKey:writeIndex];
+                    writeEncodedVariants();
+                }
+                
+                return [NSNull null];
+            }];
+            
+            if (writeKey) {
+                
+                [writeKeys addObject:writeKey];
+                [writeNames addObject:(variantName) ? variantName : [NSNull null]];
+            }
+        }
+        
+        [renderGraph run];
+        
+        if (insetKey) { imageInset = [[renderGraph outputForKey:insetKey] doubleValue]; }
+        if (imageInset > 0) { [self writeConsole:[NSString stringWithFormat:@"Reducing uninstall image size by %.1f percent", imageInset * 100]]; }
+        
+        // the encode of a variant is not executed if a node it depends on failed (e.g. because
+        // the install icon could not be rendered), so it did not hand anything to the writer.
+        // The variants after it are still waiting and are written now
+        @synchronized (encodedVariants) {
+            
+            for (NSUInteger i = nextWriteIndex; i < [writeKeys count]; i++) {
+                
+                if ([renderGraph nodeFailedForKey:[writeKeys objectAtIndex:i]]) {
+                    [encodedVariants setObject:[NSNull null] forKey:[NSNumber numberWithUnsignedInteger:i]];
+                }
             }
             
+            writeEncodedVariants();
         }
+        
+    } else {
+        [self writeConsole:@"All icons have been excluded from creation. Nothing to do"];
     }
     
     return exitCode;
 }
 
+- (BOOL)variantNamesAreUniqueWithArguments:(MTProcessInfo*)appArguments
+{
+    BOOL success = YES;
+    NSMutableSet *fileNamePrefixes = [[NSMutableSet alloc] init];
+    
+    // the names become part of the file names, so they are compared the way
+    // they are written and without case for case-insensitive file systems
+    for (NSDictionary *variant in [appArguments variants]) {
+        
+        NSString *fileNamePrefix = [[MTIconSet fileNamePrefixWithString:[variant objectForKey:kMTVariantNameKey]] lowercaseString];
+        
+        if ([fileNamePrefixes containsObject:fileNamePrefix]) {
+            success = NO;
+            break;
+        }
+        
+        [fileNamePrefixes addObject:fileNamePrefix];
+    }
+    
+    return success;
+}
+
+- (NSString*)digestWithAttributedString:(NSAttributedString*)attributedString
+{
+    NSData *rtfData = [attributedString RTFFromRange:NSMakeRange(0, [attributedString length])
+                                  documentAttributes:[NSDictionary dictionary]];
+    
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256([rtfData bytes], (CC_LONG)[rtfData length], digest);
+    
+    NSMutableString *digestString = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (NSUInteger i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) { [digestString appendFormat:@"%02x", digest[i]]; }
+    
+    return digestString;
+}
+
+- (MTBannerPosition)bannerPositionWithString:(NSString*)bannerPosition
+{
+    MTBannerPosition position = MTBannerPositionTopLeft;
+    
+    if ([bannerPosition length] > 0) {
+        
+        if ([bannerPosition containsString:@"t"]) {
+            
+            position = MTBannerPositionTop;
+            
+            if ([bannerPosition containsString:@"l"]) {
+                position = MTBannerPositionTopLeft;
+            } else if ([bannerPosition containsString:@"r"]) {
+                position = MTBannerPositionTopRight;
+            }
+            
+        } else if ([bannerPosition containsString:@"b"]) {
+            
+            position = MTBannerPositionBottom;
+            
+            if ([bannerPosition containsString:@"l"]) {
+                position = MTBannerPositionBottomLeft;
+            } else if ([bannerPosition containsString:@"r"]) {
+                position = MTBannerPositionBottomRight;
+            }
+        }
+    }
+    
+    return position;
+}
+
 - (void)writeConsole:(NSString*)consoleMessage
 {
     fprintf(stderr, "%s\n", [consoleMessage UTF8String]);
@@ -329,7 +1166,14 @@
 
 - (void)printUsage
 {
-    fprintf(stderr, "\nUsage: icons_cli [options] -i <path> -o <path>\n\n");
+    fprintf(stderr, "\nUsage: icons_cli [options] -i <path> (-o <path> | --archive <path>)\n\n");
+    fprintf(stderr, "  --preset <path>                      Path to a render preset file. The settings of the preset are\n");
+    fprintf(stderr, "                                       used for all options that are not specified on the command\n");
+    fprintf(stderr, "                                       line. If no banner text is specified, the banner of the\n");
+    fprintf(stderr, "                                       preset is used.\n\n");
+    fprintf(stderr, "  --export-presets <path>              Exports the saved banners of the app as render presets\n");
+    fprintf(stderr, "                                       into the folder at the given path (one preset per banner)\n");
+    fprintf(stderr, "                                       and exits. The presets contain the app's current settings.\n\n");
     fprintf(stderr, "  -d, --duration <number>              The duration of the animation in seconds (defaults to\n");
     fprintf(stderr, "                                       %.1f, maximum is %.1f). Setting the duration to 0 disables\n", kMTAnimationDurationDefault, kMTAnimationDurationMax);
     fprintf(stderr, "                                       the creation of an animated icon.\n\n");
@@ -337,6 +1181,9 @@
     fprintf(stderr, "                                       If not provided or if the provided size is invalid, the\n");
     fprintf(stderr, "                                       app calculates the best possible output size based on \n");
     fprintf(stderr, "                                       the size of the source image.\n\n");
+    fprintf(stderr, "  --supersample <number>               Render the icons at the given multiple of the output size\n");
+    fprintf(stderr, "                                       and downsample them afterwards (defaults to %d, maximum\n", kMTSupersamplingDefault);
+    fprintf(stderr, "                                       is %d).\n\n", kMTSupersamplingMax);
     fprintf(stderr, "  -r, --reduce <number>                Reduce the size of the input image by the given percentage\n");
     fprintf(stderr, "                                       to avoid cropping during animation. If not provided, this\n");
     fprintf(stderr, "                                       value is calculated automatically (maximum is %.0f).\n\n", kMTImageInsetMax * 100);
@@ -351,6 +1198,13 @@
     fprintf(stderr, "                                       left side (\"l\") or on the right side (\"r\") of the image.\n");
     fprintf(stderr, "                                       If not specified or if the specified arguments are invalid,\n");
     fprintf(stderr, "                                       it defaults to \"tl\".\n\n");
+    fprintf(stderr, "  --variant <name[:text[:color[:pos]]]>\n");
+    fprintf(stderr, "                                       Create an additional icon set with the given banner, using\n");
+    fprintf(stderr, "                                       the variant name as file name prefix. The icon set with\n");
+    fprintf(stderr, "                                       the banner specified by -b is still created. May be specified\n");
+    fprintf(stderr, "                                       multiple times. Omit the text to create a variant without\n");
+    fprintf(stderr, "                                       banner. Color and position default to -c and -p. The\n");
+    fprintf(stderr, "                                       uninstall icons are only rendered once for all variants.\n\n");
     fprintf(stderr, "  -a, --bannerangle <number>           Specifies the angle of the banner in degrees. Defaults to %.0lf\n", kMTBannerAngleDefault);
     fprintf(stderr, "                                       if not specified (maximum is %.0f).\n\n", kMTBannerAngleMax);
     fprintf(stderr, "  -h, --bannerheight <number>          Specifies the height of the banner as a percentage. Defaults\n");
@@ -379,8 +1233,44 @@
     fprintf(stderr, "  -x, --exclude <(i|u|a)>              The icons to exclude from icon creation. Valid arguments\n");
     fprintf(stderr, "                                       are \"i\" (install), \"u\" (uninstall) and \"a\" (animated)\n");
     fprintf(stderr, "                                       or any combination of these three arguments (like \"ua\").\n\n");
-    fprintf(stderr, "  -i, --input <path>                   Path to the source image file or application bundle.\n\n");
-    fprintf(stderr, "  -o, --output <path>                  Path to a folder to write the generated images to.\n\n");
+    fprintf(stderr, "  -i, --input <path>                   Path to the source image file or application bundle. If an\n");
+    fprintf(stderr, "                                       installer package (.pkg) or a disk image (.dmg) is\n");
+    fprintf(stderr, "                                       specified, the icon of the contained app is used. Specify\n");
+    fprintf(stderr, "                                       \"-\" to read the source from standard input. Its format is\n");
+    fprintf(stderr, "                                       then determined by its contents (images, .icns files and\n");
+    fprintf(stderr, "                                       installer packages are supported).\n\n");
+    fprintf(stderr, "  -o, --output <path>                  Path to a folder to write the generated images to. Specify\n");
+    fprintf(stderr, "                                       \"-\" to write the images to standard output as a framed\n");
+    fprintf(stderr, "                                       stream: for every image, the length of its name (32 bit),\n");
+    fprintf(stderr, "                                       its name, the length of its data (64 bit) and its data.\n");
+    fprintf(stderr, "                                       Lengths are big-endian, a name length of 0 ends the stream.\n\n");
+    fprintf(stderr, "  --archive <path>                     Write the generated images into a single tar or zip archive\n");
+    fprintf(stderr, "                                       at the given path instead of an output folder. Specify \"-\"\n");
+    fprintf(stderr, "                                       to write the archive to standard output. The images are\n");
+    fprintf(stderr, "                                       added as soon as they have been encoded. The entries are\n");
+    fprintf(stderr, "                                       written in a fixed order and with a fixed timestamp (taken\n");
+    fprintf(stderr, "                                       from SOURCE_DATE_EPOCH, if set). Can not be combined with\n");
+    fprintf(stderr, "                                       --watch.\n\n");
+    fprintf(stderr, "  --archive-format <tar|zip|zip-stored|stream>\n");
+    fprintf(stderr, "                                       The format of the archive. \"zip\" compresses the images,\n");
+    fprintf(stderr, "                                       \"zip-stored\" does not, \"stream\" writes the framed stream\n");
+    fprintf(stderr, "                                       described for -o. Defaults to \"zip\" if the archive's\n");
+    fprintf(stderr, "                                       path ends with .zip and to \"tar\" otherwise.\n\n");
+    fprintf(stderr, "  --scan <path>                        Create icons for every application found in the given folder\n");
+    fprintf(stderr, "                                       and its subfolders instead of a single input file. May be\n");
+    fprintf(stderr, "                                       specified multiple times. The file names are prefixed with\n");
+    fprintf(stderr, "                                       the name of the application.\n\n");
+    fprintf(stderr, "  --watch <path>                       Create icons for every image, application, package or disk\n");
+    fprintf(stderr, "                                       image in the given folder and its subfolders and keep\n");
+    fprintf(stderr, "                                       watching the folder. The icons of a source are created\n");
+    fprintf(stderr, "                                       again as soon as the source, the custom delete badge or\n");
+    fprintf(stderr, "                                       the preset changes. The output folder must not be inside\n");
+    fprintf(stderr, "                                       the watched folder. Press Ctrl-C to stop watching.\n\n");
+    fprintf(stderr, "  --jobs <number>                      The number of folders that are read at the same time when\n");
+    fprintf(stderr, "                                       scanning (defaults to %d, maximum is %d).\n\n", kMTScanJobsDefault, kMTScanJobsMax);
+    fprintf(stderr, "  --trace <path>                       Write timing information about every processing stage to\n");
+    fprintf(stderr, "                                       the given file, using the Chrome trace event format.\n\n");
+    fprintf(stderr, "  --stats                              Print a per-stage timing summary after processing.\n\n");
     fprintf(stderr, "  -v, --version                        Displays version information.\n\n");
 }
 